@@ -174,8 +174,23 @@ int main(int argc, char* argv[])
 
     /////////////////
     // Loading scene:   
+    // Use the cooked cache when up to date, otherwise load the OVO file and rebuild the cache:
+    // Textures start with their mip tail and are streamed on use, or share texture arrays when run with "-atlas":
+    const bool atlas = argc > 1 && std::string(argv[1]) == "-atlas";
+    Eng::TextureAtlas::getInstance().setEnabled(atlas);
+    Eng::TextureStreamer::getInstance().setEnabled(!atlas);
+    // Roughness and metalness share one texture:
+    Eng::Container::getInstance().setTexturePacking(true);
+
     Eng::Ovo ovo;
-    std::reference_wrapper<Eng::Node> root = ovo.load(scenes[SCENE] + ".ovo");
+    Eng::Cooked cooked;
+    const std::string source = scenes[SCENE] + ".ovo";
+    std::reference_wrapper<Eng::Node> root = cooked.load(source + ".cooked", source);
+    if (root.get() == Eng::Node::empty)
+    {
+       root = ovo.loadParallel(source);
+       cooked.cook(source, source + ".cooked");
+    }
     std::cout << "Scene graph:\n" << root.get().getTreeAsString() << std::endl;
 
     // Get light ref:
@@ -193,7 +208,9 @@ int main(int argc, char* argv[])
    // Get torus knot ref:
    std::reference_wrapper<Eng::Mesh> tknot = dynamic_cast<Eng::Mesh &>(Eng::Container::getInstance().find("Torus Knot001"));   
 
-   // Rendering elements:
+   // Rendering elements (world matrices are updated on the flattened hierarchy):
+   Eng::TransformTable transforms;
+   transforms.build(root);
    Eng::List list;
    Eng::Camera camera;
    camera.setProjMatrix(glm::perspective(glm::radians(45.0f), eng.getWindowSize().x / (float) eng.getWindowSize().y, 1.0f, 1000.0f));
@@ -203,6 +220,10 @@ int main(int argc, char* argv[])
    std::cout << "Entering main loop..." << std::endl;      
    while (eng.processEvents())
    {      
+      // Upload loaded resources to the GPU (max 4 ms per frame):
+      Eng::UploadQueue::getInstance().process(4.0);
+      Eng::TextureStreamer::getInstance().update(2.0);
+
       // Update viewpoint:
       glm::mat4 tmp = glm::rotate(glm::rotate(glm::mat4(1.0f), glm::radians(-rotY), { 0.0f, 1.0f, 0.0f }), glm::radians(-rotX), { 1.0f, 0.0f, 0.0f });
       tmp = tmp * glm::mat4(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, transZ)));
@@ -212,8 +233,9 @@ int main(int argc, char* argv[])
       tknot.get().setMatrix(glm::rotate(tknot.get().getMatrix(), glm::radians(0.5f), glm::vec3(0.0f, 1.0f, 0.0f)));
 
       // Update list:
+      transforms.update();
       list.reset();
-      list.process(root);
+      list.process(transforms);
       
       // Clear last frame:
       eng.clear();
@@ -225,6 +247,9 @@ int main(int argc, char* argv[])
       camera.render();
       glm::mat4 viewMatrix = glm::inverse(camera.getWorldMatrix());
 
+      // The G-buffer and ray-tracing passes report the mip levels they need:
+      Eng::TextureStreamer::getInstance().beginFeedback();
+
       uint64_t start = Eng::Timer::getInstance().getCounter();
       geometryPipe.render(viewMatrix, list, roughnessThreshold);
       uint64_t end = Eng::Timer::getInstance().getCounter();
@@ -247,6 +272,7 @@ int main(int argc, char* argv[])
       
       start = Eng::Timer::getInstance().getCounter();
       raytracingPipe.render(camera, list, geometryPipe, nrOfBounces);
+      Eng::TextureStreamer::getInstance().endFeedback();
       end = Eng::Timer::getInstance().getCounter();
       time = Eng::Timer::getInstance().getCounterDiff(start, end);
       totalTime += time;
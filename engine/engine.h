@@ -14,9 +14,15 @@
    
    // C/C++:      
    #include <string>
+   #include <string_view>
+   #include <cstring>
+   #include <type_traits>
    #include <vector>
    #include <list>   
    #include <memory> 
+   #include <functional>
+   #include <future>
+   #include <typeinfo>
 
    // GLM:
 #ifndef _DEBUG
@@ -72,8 +78,15 @@ namespace Eng {
    // Architecture:
    #include "engine_object.h"
    #include "engine_managed.h"
+   #include "engine_pool.h"
+   #include "engine_slab_allocator.h"
+   #include "engine_thread_pool.h"
+   #include "engine_upload_queue.h"
+   #include "engine_async_io.h"
 
    // File formats:
+   #include "engine_mapped_file.h"
+   #include "engine_archive.h"
    #include "engine_serializer.h"
    #include "engine_bitmap.h"
    #include "engine_ovo.h"
@@ -82,16 +95,23 @@ namespace Eng {
    #include "engine_vao.h"
    #include "engine_vbo.h"
    #include "engine_ebo.h"
+   #include "engine_mesh_codec.h"
+   #include "engine_simplifier.h"
+   #include "engine_mesh_optimizer.h"
    #include "engine_shader.h"
    #include "engine_program.h"
    #include "engine_texture.h"
+   #include "engine_texture_streamer.h"
+   #include "engine_texture_atlas.h"
    #include "engine_material.h"
    #include "engine_fbo.h"
    #include "engine_ssbo.h"
+   #include "engine_pbo.h"
    #include "engine_atomic_counter.h"
 
    // Scene-graph elems:
    #include "engine_node.h"
+   #include "engine_transform_table.h"
    #include "engine_mesh.h"
    #include "engine_light.h"
    #include "engine_camera.h"
@@ -99,6 +119,7 @@ namespace Eng {
 
    // Storage:
    #include "engine_container.h"
+   #include "engine_cooked.h"
 
    // Pipelines:
    #include "engine_pipeline.h"
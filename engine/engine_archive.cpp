@@ -0,0 +1,424 @@
+/**
+ * @file		engine_archive.cpp
+ * @brief	Packed asset archive
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <mutex>
+   #include <unordered_map>
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Mounted archives (most recent last):
+   static std::list<Eng::Archive> mounted;
+   static std::mutex mountedMutex;
+
+
+/**
+ * Hashes a name (FNV-1a).
+ * @param name name to hash
+ * @return hash value
+ */
+static uint64_t hashName(const std::string &name)
+{
+   uint64_t hash = 0xcbf29ce484222325ull;
+   for (char c : name)
+      hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+   return hash;
+}
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief Archive reserved structure.
+ */
+struct Eng::Archive::Reserved
+{
+   std::shared_ptr<Eng::MappedFile> file;          ///< Mapping of the whole archive
+   const Eng::Archive::Header *header;             ///< Header, within the mapping
+   const Eng::Archive::Entry *toc;                 ///< TOC, within the mapping
+   const char *strings;                            ///< Entry names, within the mapping
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : header{ nullptr }, toc{ nullptr }, strings{ nullptr }
+   {}
+};
+
+
+
+///////////////////////////
+// BODY OF CLASS Archive //
+///////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::Archive::Archive() : reserved(std::make_unique<Eng::Archive::Reserved>())
+{
+   ENG_LOG_DETAIL("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Move constructor.
+ */
+ENG_API Eng::Archive::Archive(Archive &&other) : reserved(std::move(other.reserved))
+{
+   ENG_LOG_DETAIL("[M]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::Archive::~Archive()
+{
+   ENG_LOG_DETAIL("[-]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the name of the archive file.
+ * @return filename
+ */
+const std::string ENG_API &Eng::Archive::getFilename() const
+{
+   static const std::string none;
+   if (reserved->file == nullptr)
+      return none;
+   return reserved->file->getFilename();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the number of entries in the archive.
+ * @return number of entries
+ */
+uint32_t ENG_API Eng::Archive::getNrOfEntries() const
+{
+   if (reserved->header == nullptr)
+      return 0;
+   return reserved->header->nrOfEntries;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Normalizes an entry name: forward slashes, lowercase, no leading "./".
+ * @param name file name
+ * @return normalized name
+ */
+std::string ENG_API Eng::Archive::normalize(const std::string &name)
+{
+   std::string out = name;
+   for (char &c : out)
+      if (c == '\\')
+         c = '/';
+      else
+         c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+   while (out.compare(0, 2, "./") == 0)
+      out.erase(0, 2);
+
+   // Done:
+   return out;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Maps an archive and validates its header and TOC.
+ * @param filename archive file
+ * @return TF
+ */
+bool ENG_API Eng::Archive::open(const std::string &filename)
+{
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   std::shared_ptr<Eng::MappedFile> file = std::make_shared<Eng::MappedFile>();
+   if (file->open(filename) == false)
+      return false;
+
+   const uint8_t *base = file->getData();
+   const Eng::Archive::Header *header = reinterpret_cast<const Eng::Archive::Header *>(base);
+   if (file->getNrOfBytes() < sizeof(Eng::Archive::Header) || header->magic != Eng::Archive::magic || header->version != Eng::Archive::version)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
+      return false;
+   }
+   if (header->tocOffset + header->nrOfEntries * sizeof(Eng::Archive::Entry) > file->getNrOfBytes() ||
+       header->stringsOffset + header->stringsSize > file->getNrOfBytes())
+   {
+      ENG_LOG_ERROR("File '%s' is truncated", filename.c_str());
+      return false;
+   }
+
+   // Done:
+   reserved->file = file;
+   reserved->header = header;
+   reserved->toc = reinterpret_cast<const Eng::Archive::Entry *>(base + header->tocOffset);
+   reserved->strings = reinterpret_cast<const char *>(base + header->stringsOffset);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Looks for an entry and, if found, opens it as a view on the archive mapping.
+ * @param name entry name (normalized internally)
+ * @param file mapped file opened on the entry content
+ * @return true if found
+ */
+bool ENG_API Eng::Archive::find(const std::string &name, Eng::MappedFile &file) const
+{
+   if (reserved->header == nullptr)
+      return false;
+
+   const std::string key = normalize(name);
+   const uint64_t hash = hashName(key);
+   const Eng::Archive::Entry *first = reserved->toc;
+   const Eng::Archive::Entry *last = reserved->toc + reserved->header->nrOfEntries;
+   const Eng::Archive::Entry *it = std::lower_bound(first, last, hash, [](const Eng::Archive::Entry &e, uint64_t h) { return e.hash < h; });
+   for (; it != last && it->hash == hash; it++)
+   {
+      if (it->name >= reserved->header->stringsSize || key != reserved->strings + it->name)
+         continue;
+      if (it->offset + it->size > reserved->file->getNrOfBytes())
+      {
+         ENG_LOG_ERROR("Entry '%s' is out of bounds", key.c_str());
+         return false;
+      }
+      return file.open(reserved->file, it->offset, it->size, name);
+   }
+
+   // Not found:
+   return false;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Packs the given files into an archive. Files with identical content are stored once.
+ * @param files list of files to pack (stored under their normalized name)
+ * @param filename archive file to create
+ * @return TF
+ */
+bool ENG_API Eng::Archive::pack(const std::vector<std::string> &files, const std::string &filename)
+{
+   // Safety net:
+   if (files.empty() || filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Map inputs:
+   std::vector<std::string> names;
+   std::vector<Eng::MappedFile> content;
+   for (auto &f : files)
+   {
+      const std::string name = normalize(f);
+      if (std::find(names.begin(), names.end(), name) != names.end())
+         continue;
+
+      Eng::MappedFile m;
+      if (m.open(f) == false)
+      {
+         ENG_LOG_ERROR("Unable to open file '%s'", f.c_str());
+         return false;
+      }
+      names.push_back(name);
+      content.push_back(std::move(m));
+   }
+
+   FILE *dat = fopen(filename.c_str(), "wb");
+   if (dat == nullptr)
+   {
+      ENG_LOG_ERROR("Unable to create file '%s'", filename.c_str());
+      return false;
+   }
+
+   uint64_t position = 0;
+   bool error = false;
+   auto write = [&](const void *data, uint64_t nrOfBytes)
+   {
+      if (nrOfBytes && fwrite(data, sizeof(uint8_t), nrOfBytes, dat) != nrOfBytes)
+         error = true;
+      position += nrOfBytes;
+   };
+   auto align = [&]()
+   {
+      static const uint8_t zero[Eng::Archive::alignment] = { 0 };
+      write(zero, (Eng::Archive::alignment - position % Eng::Archive::alignment) % Eng::Archive::alignment);
+   };
+
+   Eng::Archive::Header header;
+   memset(&header, 0, sizeof(Eng::Archive::Header));
+   header.magic = Eng::Archive::magic;
+   header.version = Eng::Archive::version;
+   header.nrOfEntries = static_cast<uint32_t>(names.size());
+   write(&header, sizeof(Eng::Archive::Header)); // Placeholder
+
+   // Contents (deduplicated by content hash, confirmed byte by byte):
+   std::vector<Eng::Archive::Entry> toc(names.size());
+   std::vector<char> strings;
+   std::unordered_multimap<uint64_t, uint32_t> stored;
+   uint32_t nrOfDuplicates = 0;
+   for (uint32_t c = 0; c < names.size(); c++)
+   {
+      Eng::Archive::Entry &e = toc[c];
+      e.hash = hashName(names[c]);
+      e.size = content[c].getNrOfBytes();
+      e.name = strings.size();
+      strings.insert(strings.end(), names[c].c_str(), names[c].c_str() + names[c].size() + 1);
+
+      const uint64_t contentHash = Eng::Cooked::computeHash(content[c].getData(), e.size);
+      bool duplicate = false;
+      auto range = stored.equal_range(contentHash);
+      for (auto it = range.first; it != range.second && !duplicate; it++)
+         if (toc[it->second].size == e.size && memcmp(content[it->second].getData(), content[c].getData(), e.size) == 0)
+         {
+            e.offset = toc[it->second].offset;
+            duplicate = true;
+         }
+      if (duplicate)
+      {
+         nrOfDuplicates++;
+         continue;
+      }
+
+      align();
+      e.offset = position;
+      write(content[c].getData(), e.size);
+      stored.emplace(contentHash, c);
+   }
+
+   // TOC, sorted by name hash:
+   std::sort(toc.begin(), toc.end(), [](const Eng::Archive::Entry &a, const Eng::Archive::Entry &b) { return a.hash < b.hash; });
+   align();
+   header.tocOffset = position;
+   write(toc.data(), toc.size() * sizeof(Eng::Archive::Entry));
+   header.stringsOffset = position;
+   header.stringsSize = strings.size();
+   write(strings.data(), strings.size());
+
+   // Final header:
+   fseek(dat, 0, SEEK_SET);
+   if (fwrite(&header, sizeof(Eng::Archive::Header), 1, dat) != 1)
+      error = true;
+   fclose(dat);
+   if (error)
+   {
+      ENG_LOG_ERROR("Unable to write file '%s'", filename.c_str());
+      remove(filename.c_str());
+      return false;
+   }
+
+   // Done:
+   ENG_LOG_PLAIN("Archive '%s': %zu entries (%u duplicates), %llu bytes", filename.c_str(), names.size(), nrOfDuplicates, (unsigned long long) position);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Mounts an archive: from now on, MappedFile::open() looks for files in it first.
+ * Archives mounted later take precedence. Thread-safe.
+ * @param filename archive file
+ * @return TF
+ */
+bool ENG_API Eng::Archive::mount(const std::string &filename)
+{
+   Eng::Archive archive;
+   if (archive.open(filename) == false)
+   {
+      ENG_LOG_ERROR("Unable to mount archive '%s'", filename.c_str());
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock(mountedMutex);
+   for (auto &a : mounted)
+      if (a.getFilename() == filename)
+      {
+         ENG_LOG_WARN("Archive '%s' already mounted", filename.c_str());
+         return true;
+      }
+   mounted.push_back(std::move(archive));
+
+   // Done:
+   ENG_LOG_DEBUG("Archive '%s' mounted (%u entries)", filename.c_str(), mounted.back().getNrOfEntries());
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Unmounts an archive. Files already opened from it stay valid. Thread-safe.
+ * @param filename archive file
+ * @return TF
+ */
+bool ENG_API Eng::Archive::unmount(const std::string &filename)
+{
+   std::lock_guard<std::mutex> lock(mountedMutex);
+   for (auto it = mounted.begin(); it != mounted.end(); it++)
+      if (it->getFilename() == filename)
+      {
+         mounted.erase(it);
+         return true;
+      }
+
+   // Not found:
+   ENG_LOG_ERROR("Archive '%s' not mounted", filename.c_str());
+   return false;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Looks for a file in the mounted archives, most recently mounted first. Thread-safe.
+ * @param name file name
+ * @param file mapped file opened on the entry content
+ * @return true if found
+ */
+bool ENG_API Eng::Archive::findMounted(const std::string &name, Eng::MappedFile &file)
+{
+   std::lock_guard<std::mutex> lock(mountedMutex);
+   for (auto it = mounted.rbegin(); it != mounted.rend(); it++)
+      if (it->find(name, file))
+         return true;
+
+   // Not found:
+   return false;
+}
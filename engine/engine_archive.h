@@ -0,0 +1,86 @@
+/**
+ * @file		engine_archive.h
+ * @brief	Packed asset archive
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Class for packing many asset files (OVO, DDS, etc.) into a single file with a hashed table of contents.
+ *        Entries are 4K-aligned and identical contents are stored once. Mounted archives are mapped once and
+ *        transparently used by MappedFile::open() (and, through it, by Serializer, Ovo and Bitmap).
+ */
+class ENG_API Archive
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief File header.
+    */
+   struct Header
+   {
+      uint32_t magic;                           ///< Magic number
+      uint32_t version;                         ///< Format revision
+      uint32_t nrOfEntries;                     ///< Number of entries in the TOC
+      uint32_t _pad;                            ///< Padding
+      uint64_t tocOffset;                       ///< Offset of the TOC (entries sorted by hash)
+      uint64_t stringsOffset;                   ///< Offset of the zero-terminated entry names
+      uint64_t stringsSize;                     ///< Size of the names
+   };
+
+
+   /**
+    * @brief TOC entry.
+    */
+   struct Entry
+   {
+      uint64_t hash;                            ///< Hash of the normalized name
+      uint64_t offset;                          ///< Offset of the content (4K-aligned)
+      uint64_t size;                            ///< Size of the content
+      uint64_t name;                            ///< Offset of the normalized name in the names
+   };
+
+
+   // Consts:
+   static constexpr uint32_t magic = 0x4B415045;   ///< 'EPAK'
+   static constexpr uint32_t version = 1;          ///< Format revision
+   static constexpr uint32_t alignment = 4096;     ///< Entry alignment
+
+   // Const/dest:
+   Archive();
+   Archive(Archive &&other);
+   Archive(Archive const &) = delete;
+   virtual ~Archive();
+
+   // Operators:
+   void operator=(Archive const &) = delete;
+
+   // Get/set:
+   const std::string &getFilename() const;
+   uint32_t getNrOfEntries() const;
+
+   // Archive:
+   bool open(const std::string &filename);
+   bool find(const std::string &name, Eng::MappedFile &file) const;
+   static bool pack(const std::vector<std::string> &files, const std::string &filename);
+   static std::string normalize(const std::string &name);
+
+   // Mounting:
+   static bool mount(const std::string &filename);
+   static bool unmount(const std::string &filename);
+   static bool findMounted(const std::string &name, Eng::MappedFile &file);
+
+
+/////////////
+protected: //
+/////////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+};
@@ -0,0 +1,473 @@
+/**
+ * @file		engine_async_io.cpp
+ * @brief	Asynchronous file reads
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <condition_variable>
+   #include <filesystem>
+   #include <mutex>
+   #include <thread>
+
+   // io_uring:
+#ifdef ENG_IO_URING
+   #include <fcntl.h>
+   #include <unistd.h>
+   #include <liburing.h>
+#endif
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief Read in progress.
+ */
+struct AsyncRead
+{
+   Eng::AsyncIo::Request request;            ///< Original request
+   std::vector<uint8_t> buffer;              ///< Staging memory
+   uint64_t nrOfDone;                        ///< Bytes read so far
+   int fd;                                   ///< File descriptor (io_uring only)
+
+
+   /**
+    * Constructor.
+    */
+   AsyncRead(const Eng::AsyncIo::Request &request) : request{ request }, nrOfDone{ 0 }, fd{ -1 }
+   {}
+};
+
+
+/**
+ * @brief AsyncIo reserved structure.
+ */
+struct Eng::AsyncIo::Reserved
+{
+   uint64_t budget;                          ///< Staging memory budget
+   uint64_t nrOfStagedBytes;                 ///< Staging memory in use
+   uint32_t nrOfPending;                     ///< Requests not completed yet
+   uint32_t nrOfInFlight;                    ///< Reads submitted to the kernel
+   mutable std::mutex mutex;                 ///< Protects the counters
+   std::condition_variable changed;          ///< Signaled when a counter decreases
+
+#ifdef ENG_IO_URING
+   struct io_uring ring;                     ///< Submission/completion queues
+   std::mutex ringMutex;                     ///< Protects the submission queue
+   std::thread completer;                    ///< Completion thread
+#endif
+   bool native;                              ///< io_uring available
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : budget{ Eng::AsyncIo::dfltBudget }, nrOfStagedBytes{ 0 }, nrOfPending{ 0 }, nrOfInFlight{ 0 }, native{ false }
+   {}
+
+   /**
+    * Reserves staging memory, blocking while the budget is exceeded. A single request larger than the whole budget
+    * is accepted when no other memory is staged.
+    * @param nrOfBytes bytes to reserve
+    * @param flush called before blocking, to start the reads that will release memory
+    */
+   void acquire(uint64_t nrOfBytes, const std::function<void(void)> &flush)
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      auto available = [&]() { return nrOfStagedBytes == 0 || nrOfStagedBytes + nrOfBytes <= budget; };
+      if (!available())
+      {
+         lock.unlock();
+         flush();
+         lock.lock();
+         changed.wait(lock, available);
+      }
+      nrOfStagedBytes += nrOfBytes;
+   }
+
+   /**
+    * Runs the callback of a read on the ThreadPool, then releases its staging memory.
+    * @param read read to complete (deleted here)
+    * @param success read status
+    */
+   void complete(AsyncRead *read, bool success)
+   {
+      Eng::ThreadPool::getInstance().submit([this, read, success]()
+         {
+            if (!success)
+               ENG_LOG_ERROR("Unable to read file '%s'", read->request.filename.c_str());
+            read->request.callback(success, read->buffer.data(), read->buffer.size());
+
+            const uint64_t nrOfBytes = read->buffer.size();
+            delete read;
+            {
+               std::lock_guard<std::mutex> lock(mutex);
+               nrOfStagedBytes -= nrOfBytes;
+               nrOfPending--;
+            }
+            changed.notify_all();
+         });
+   }
+
+#ifdef ENG_IO_URING
+   /**
+    * Queues the next part of a read (reads are split into parts of max 1 GB). Requires ringMutex.
+    * @param read read in progress
+    * @return TF
+    */
+   bool prepare(AsyncRead *read)
+   {
+      struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+      if (sqe == nullptr)
+      {
+         io_uring_submit(&ring);
+         sqe = io_uring_get_sqe(&ring);
+         if (sqe == nullptr)
+            return false;
+      }
+
+      const uint64_t nrOfBytes = std::min<uint64_t>(read->buffer.size() - read->nrOfDone, 1 << 30);
+      io_uring_prep_read(sqe, read->fd, read->buffer.data() + read->nrOfDone, static_cast<unsigned>(nrOfBytes), read->request.offset + read->nrOfDone);
+      io_uring_sqe_set_data(sqe, read);
+      return true;
+   }
+#endif
+};
+
+
+
+///////////////////////////
+// BODY OF CLASS AsyncIo //
+///////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::AsyncIo::AsyncIo() : reserved(std::make_unique<Eng::AsyncIo::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+
+   // Callbacks run on the pool, which must outlive this singleton:
+   Eng::ThreadPool::getInstance();
+
+#ifdef ENG_IO_URING
+   if (io_uring_queue_init(Eng::AsyncIo::queueDepth, &reserved->ring, 0) < 0)
+   {
+      ENG_LOG_WARN("io_uring not available, using the thread pool");
+      return;
+   }
+   reserved->native = true;
+
+   reserved->completer = std::thread([this]()
+      {
+         while (true)
+         {
+            struct io_uring_cqe *cqe;
+            if (io_uring_wait_cqe(&reserved->ring, &cqe) < 0)
+               continue;
+            AsyncRead *read = static_cast<AsyncRead *>(io_uring_cqe_get_data(cqe));
+            const int32_t result = cqe->res;
+            io_uring_cqe_seen(&reserved->ring, cqe);
+
+            // Quit:
+            if (read == nullptr)
+               return;
+
+            // Partial read?
+            if (result > 0)
+            {
+               read->nrOfDone += result;
+               if (read->nrOfDone < read->buffer.size())
+               {
+                  std::lock_guard<std::mutex> lock(reserved->ringMutex);
+                  if (reserved->prepare(read))
+                  {
+                     io_uring_submit(&reserved->ring);
+                     continue;
+                  }
+               }
+            }
+
+            close(read->fd);
+            {
+               std::lock_guard<std::mutex> lock(reserved->mutex);
+               reserved->nrOfInFlight--;
+            }
+            reserved->changed.notify_all();
+            reserved->complete(read, result >= 0 && read->nrOfDone == read->buffer.size());
+         }
+      });
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::AsyncIo::~AsyncIo()
+{
+   ENG_LOG_DEBUG("[-]");
+   wait();
+
+#ifdef ENG_IO_URING
+   if (reserved->native)
+   {
+      {
+         std::lock_guard<std::mutex> lock(reserved->ringMutex);
+         struct io_uring_sqe *sqe = io_uring_get_sqe(&reserved->ring);
+         io_uring_prep_nop(sqe);
+         io_uring_sqe_set_data(sqe, nullptr);
+         io_uring_submit(&reserved->ring);
+      }
+      reserved->completer.join();
+      io_uring_queue_exit(&reserved->ring);
+   }
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::AsyncIo ENG_API &Eng::AsyncIo::getInstance()
+{
+   static AsyncIo instance;
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the max amount of staging memory used by reads in progress.
+ * @param nrOfBytes budget in bytes
+ */
+void ENG_API Eng::AsyncIo::setBudget(uint64_t nrOfBytes)
+{
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      reserved->budget = nrOfBytes;
+   }
+   reserved->changed.notify_all();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the max amount of staging memory used by reads in progress.
+ * @return budget in bytes
+ */
+uint64_t ENG_API Eng::AsyncIo::getBudget() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return reserved->budget;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the amount of staging memory currently used.
+ * @return staging memory in bytes
+ */
+uint64_t ENG_API Eng::AsyncIo::getNrOfStagedBytes() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return reserved->nrOfStagedBytes;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the number of requests not completed yet.
+ * @return number of pending requests
+ */
+uint32_t ENG_API Eng::AsyncIo::getNrOfPending() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return reserved->nrOfPending;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns true when the io_uring backend is in use.
+ * @return TF
+ */
+bool ENG_API Eng::AsyncIo::isNative() const
+{
+   return reserved->native;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Submits a batch of reads. The call blocks only while the staging budget is exhausted. Every request gets its callback
+ * called, also on failure. Don't call from a ThreadPool job.
+ * @param batch read requests
+ * @return TF
+ */
+bool ENG_API Eng::AsyncIo::submit(const std::vector<Request> &batch)
+{
+   Eng::ThreadPool &pool = Eng::ThreadPool::getInstance();
+   bool done = true;
+#ifdef ENG_IO_URING
+   uint32_t nrOfQueued = 0; // Prepared but not yet submitted reads
+#endif
+
+   // Starts the reads queued so far:
+   auto flush = [&]()
+   {
+#ifdef ENG_IO_URING
+      if (nrOfQueued)
+      {
+         std::lock_guard<std::mutex> lock(reserved->ringMutex);
+         io_uring_submit(&reserved->ring);
+         nrOfQueued = 0;
+      }
+#endif
+   };
+
+   for (auto &request : batch)
+   {
+      // Safety net:
+      if (request.filename.empty() || !request.callback)
+      {
+         ENG_LOG_ERROR("Invalid params");
+         done = false;
+         continue;
+      }
+
+      {
+         std::lock_guard<std::mutex> lock(reserved->mutex);
+         reserved->nrOfPending++;
+      }
+
+      // Mounted archive (already in memory, no staging needed):
+      std::shared_ptr<Eng::MappedFile> view = std::make_shared<Eng::MappedFile>();
+      if (Eng::Archive::findMounted(request.filename, *view))
+      {
+         pool.submit([this, view, request]()
+            {
+               const uint64_t nrOfBytes = request.nrOfBytes ? request.nrOfBytes : view->getNrOfBytes() - std::min(request.offset, view->getNrOfBytes());
+               const bool success = request.offset + nrOfBytes <= view->getNrOfBytes();
+               request.callback(success, success ? view->getData() + request.offset : nullptr, success ? nrOfBytes : 0);
+               {
+                  std::lock_guard<std::mutex> lock(reserved->mutex);
+                  reserved->nrOfPending--;
+               }
+               reserved->changed.notify_all();
+            });
+         continue;
+      }
+
+      // Size:
+      AsyncRead *read = new AsyncRead(request);
+      std::error_code error;
+      const uint64_t fileSize = std::filesystem::file_size(request.filename, error);
+      uint64_t nrOfBytes = request.nrOfBytes;
+      if (nrOfBytes == 0 && !error && request.offset < fileSize)
+         nrOfBytes = fileSize - request.offset;
+      if (error || nrOfBytes == 0 || request.offset + nrOfBytes > fileSize)
+      {
+         reserved->complete(read, false);
+         done = false;
+         continue;
+      }
+
+      // Staging memory:
+      reserved->acquire(nrOfBytes, flush);
+      read->buffer.resize(nrOfBytes);
+
+#ifdef ENG_IO_URING
+      if (reserved->native)
+      {
+         read->fd = open(request.filename.c_str(), O_RDONLY);
+         if (read->fd < 0)
+         {
+            reserved->complete(read, false);
+            done = false;
+            continue;
+         }
+
+         // Keep the queues within their capacity:
+         {
+            std::unique_lock<std::mutex> lock(reserved->mutex);
+            if (reserved->nrOfInFlight >= Eng::AsyncIo::queueDepth)
+            {
+               lock.unlock();
+               flush();
+               lock.lock();
+               reserved->changed.wait(lock, [this]() { return reserved->nrOfInFlight < Eng::AsyncIo::queueDepth; });
+            }
+            reserved->nrOfInFlight++;
+         }
+
+         std::lock_guard<std::mutex> lock(reserved->ringMutex);
+         if (reserved->prepare(read) == false)
+         {
+            close(read->fd);
+            {
+               std::lock_guard<std::mutex> lock(reserved->mutex);
+               reserved->nrOfInFlight--;
+            }
+            reserved->complete(read, false);
+            done = false;
+            continue;
+         }
+         nrOfQueued++;
+         continue;
+      }
+#endif
+
+      // Fallback, blocking read on a worker:
+      pool.submit([this, read]()
+         {
+            bool success = false;
+            FILE *dat = fopen(read->request.filename.c_str(), "rb");
+            if (dat)
+            {
+#ifdef _WINDOWS
+               success = _fseeki64(dat, read->request.offset, SEEK_SET) == 0;
+#else
+               success = fseeko(dat, read->request.offset, SEEK_SET) == 0;
+#endif
+               success = success && fread(read->buffer.data(), sizeof(uint8_t), read->buffer.size(), dat) == read->buffer.size();
+               read->nrOfDone = read->buffer.size();
+               fclose(dat);
+            }
+            reserved->complete(read, success);
+         });
+   }
+
+   flush();
+
+   // Done:
+   return done;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Blocks until all the submitted requests have been completed (callbacks included).
+ */
+void ENG_API Eng::AsyncIo::wait()
+{
+   std::unique_lock<std::mutex> lock(reserved->mutex);
+   reserved->changed.wait(lock, [this]() { return reserved->nrOfPending == 0; });
+}
@@ -0,0 +1,85 @@
+/**
+ * @file		engine_async_io.h
+ * @brief	Asynchronous file reads
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Asynchronous file reading service. Requests are submitted in batches and completed through callbacks,
+ *        executed on the ThreadPool. Uses io_uring when built with ENG_IO_URING (Linux, liburing), reads on the
+ *        ThreadPool otherwise. Files found in a mounted Archive are served straight from its mapping.
+ *        This class is a singleton.
+ */
+class ENG_API AsyncIo
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief Completion callback: success flag, data and its size. Data is only valid during the call.
+    */
+   typedef std::function<void(bool, const uint8_t *, uint64_t)> Callback;
+
+
+   /**
+    * @brief Read request.
+    */
+   struct Request
+   {
+      std::string filename;                     ///< File to read
+      uint64_t offset;                          ///< Offset of the first byte to read
+      uint64_t nrOfBytes;                       ///< Number of bytes to read (0 = up to the end of the file)
+      Callback callback;                        ///< Completion callback
+
+
+      /**
+       * Constructor.
+       */
+      Request(const std::string &filename = "", const Callback &callback = nullptr, uint64_t offset = 0, uint64_t nrOfBytes = 0) :
+         filename{ filename }, offset{ offset }, nrOfBytes{ nrOfBytes }, callback{ callback }
+      {}
+   };
+
+
+   // Consts:
+   static constexpr uint64_t dfltBudget = 256 * 1024 * 1024;   ///< Default staging memory budget (bytes)
+   static constexpr uint32_t queueDepth = 256;                 ///< Max number of reads in flight (io_uring)
+
+   // Const/dest:
+   AsyncIo(AsyncIo const &) = delete;
+   ~AsyncIo();
+
+   // Operators:
+   void operator=(AsyncIo const &) = delete;
+
+   // Singleton:
+   static AsyncIo &getInstance();
+
+   // Get/set:
+   void setBudget(uint64_t nrOfBytes);
+   uint64_t getBudget() const;
+   uint64_t getNrOfStagedBytes() const;
+   uint32_t getNrOfPending() const;
+   bool isNative() const;
+
+   // Reads:
+   bool submit(const std::vector<Request> &batch);
+   void wait();
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   AsyncIo();
+};
@@ -19,6 +19,15 @@
 
    // C/C++:
    #include <algorithm>
+   #include <cfloat>
+   #include <cmath>
+   #include <limits>
+
+   // SIMD (SSE2 is part of the x64 baseline):
+   #if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+      #include <emmintrin.h>
+      #define ENG_BITMAP_SSE
+   #endif
 
    
 
@@ -30,6 +39,809 @@
    Eng::Bitmap Eng::Bitmap::empty("[empty]");   
 
 
+/**
+ * @brief 4x4 block of pixels being block-compressed, stored per channel (values in the 0-255 range).
+ */
+struct BcBlock
+{
+   alignas(16) float ch[4][16];     ///< Pixel values per channel (r, g, b, a)
+};
+
+
+/**
+ * Fills a block from an RGBA8 image, replicating the border pixels for partial blocks.
+ * @param rgba image data (4 bytes per pixel)
+ * @param sizeX image width
+ * @param sizeY image height
+ * @param bx block column
+ * @param by block row
+ * @param block destination block
+ */
+static void loadBlock(const uint8_t *rgba, uint32_t sizeX, uint32_t sizeY, uint32_t bx, uint32_t by, BcBlock &block)
+{
+   for (uint32_t y = 0; y < 4; y++)
+      for (uint32_t x = 0; x < 4; x++)
+      {
+         const uint32_t px = std::min(bx * 4 + x, sizeX - 1);
+         const uint32_t py = std::min(by * 4 + y, sizeY - 1);
+         const uint8_t *src = rgba + (static_cast<uint64_t>(py) * sizeX + px) * 4;
+         for (uint32_t c = 0; c < 4; c++)
+            block.ch[c][y * 4 + x] = static_cast<float>(src[c]);
+      }
+}
+
+
+/**
+ * Assigns to each pixel the closest palette entry (squared euclidean distance) and returns the total error.
+ * @param channel pointers to the (16-byte aligned) 16 values of each channel to consider
+ * @param nrOfChannels number of channels to consider
+ * @param palette palette entries, with the same channel order
+ * @param nrOfEntries number of palette entries
+ * @param index output index per pixel
+ * @return sum of the squared errors
+ */
+static float fitIndices(const float *const *channel, uint32_t nrOfChannels, const float (*palette)[4], uint32_t nrOfEntries, uint8_t *index)
+{
+   float total = 0.0f;
+
+#ifdef ENG_BITMAP_SSE
+   // Four pixels at once:
+   for (uint32_t p = 0; p < 16; p += 4)
+   {
+      __m128 best = _mm_set1_ps(FLT_MAX);
+      __m128i bestIndex = _mm_setzero_si128();
+      for (uint32_t e = 0; e < nrOfEntries; e++)
+      {
+         __m128 error = _mm_setzero_ps();
+         for (uint32_t c = 0; c < nrOfChannels; c++)
+         {
+            const __m128 d = _mm_sub_ps(_mm_load_ps(channel[c] + p), _mm_set1_ps(palette[e][c]));
+            error = _mm_add_ps(error, _mm_mul_ps(d, d));
+         }
+         const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, best));
+         bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(e))), _mm_andnot_si128(closer, bestIndex));
+         best = _mm_min_ps(error, best);
+      }
+
+      alignas(16) float bestError[4];
+      alignas(16) int32_t bestEntry[4];
+      _mm_store_ps(bestError, best);
+      _mm_store_si128(reinterpret_cast<__m128i *>(bestEntry), bestIndex);
+      for (uint32_t c = 0; c < 4; c++)
+      {
+         index[p + c] = static_cast<uint8_t>(bestEntry[c]);
+         total += bestError[c];
+      }
+   }
+#else
+   for (uint32_t p = 0; p < 16; p++)
+   {
+      float best = FLT_MAX;
+      for (uint32_t e = 0; e < nrOfEntries; e++)
+      {
+         float error = 0.0f;
+         for (uint32_t c = 0; c < nrOfChannels; c++)
+         {
+            const float d = channel[c][p] - palette[e][c];
+            error += d * d;
+         }
+         if (error < best)
+         {
+            best = error;
+            index[p] = static_cast<uint8_t>(e);
+         }
+      }
+      total += best;
+   }
+#endif
+
+   // Done:
+   return total;
+}
+
+
+/**
+ * Packs an RGB color into the 5:6:5 format.
+ * @param color RGB values in the 0-255 range
+ * @return packed color
+ */
+static uint16_t packRgb565(const float *color)
+{
+   const uint32_t r = static_cast<uint32_t>(glm::clamp(color[0] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+   const uint32_t g = static_cast<uint32_t>(glm::clamp(color[1] * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f));
+   const uint32_t b = static_cast<uint32_t>(glm::clamp(color[2] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+   return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+
+/**
+ * Expands a 5:6:5 color to 8 bits per channel.
+ * @param packed packed color
+ * @param color RGB values in the 0-255 range
+ */
+static void unpackRgb565(uint16_t packed, uint8_t *color)
+{
+   const uint32_t r = (packed >> 11) & 31;
+   const uint32_t g = (packed >> 5) & 63;
+   const uint32_t b = packed & 31;
+   color[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+   color[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+   color[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+}
+
+
+/**
+ * Builds the BC1 palette of two packed endpoints, as decoded by the GPU.
+ * @param c0 first endpoint
+ * @param c1 second endpoint
+ * @param palette output RGBA palette
+ */
+static void buildBc1Palette(uint16_t c0, uint16_t c1, uint8_t (*palette)[4])
+{
+   unpackRgb565(c0, palette[0]);
+   unpackRgb565(c1, palette[1]);
+   for (uint32_t c = 0; c < 3; c++)
+      if (c0 > c1)
+      {
+         palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+         palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+      }
+      else
+      {
+         palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+         palette[3][c] = 0;
+      }
+   for (uint32_t c = 0; c < 4; c++)
+      palette[c][3] = 255;
+}
+
+
+/**
+ * Encodes the color part of a block with the given (unquantized) endpoints, in four-color mode.
+ * @param block source pixels
+ * @param e0 first endpoint (RGB)
+ * @param e1 second endpoint (RGB)
+ * @param out 8 bytes of output
+ * @param index output index per pixel
+ * @return sum of the squared errors
+ */
+static float encodeBc1Endpoints(const BcBlock &block, const float *e0, const float *e1, uint8_t *out, uint8_t *index)
+{
+   uint16_t c0 = packRgb565(e0);
+   uint16_t c1 = packRgb565(e1);
+   if (c0 < c1)
+      std::swap(c0, c1);
+
+   uint8_t palette8[4][4];
+   buildBc1Palette(c0, c1, palette8);
+   float palette[4][4];
+   for (uint32_t e = 0; e < 4; e++)
+      for (uint32_t c = 0; c < 4; c++)
+         palette[e][c] = static_cast<float>(palette8[e][c]);
+
+   const float *channel[3] = { block.ch[0], block.ch[1], block.ch[2] };
+   const float error = fitIndices(channel, 3, palette, c0 == c1 ? 1 : 4, index);
+
+   uint32_t bits = 0;
+   for (uint32_t p = 0; p < 16; p++)
+      bits |= static_cast<uint32_t>(index[p]) << (p * 2);
+   memcpy(out, &c0, sizeof(uint16_t));
+   memcpy(out + 2, &c1, sizeof(uint16_t));
+   memcpy(out + 4, &bits, sizeof(uint32_t));
+
+   // Done:
+   return error;
+}
+
+
+/**
+ * Encodes the color part of a block in the BC1 format.
+ * @param block source pixels
+ * @param quality when true, also tries principal-axis endpoints refined by least squares, bounding-box endpoints only otherwise
+ * @param out 8 bytes of output
+ */
+static void encodeBc1(const BcBlock &block, bool quality, uint8_t *out)
+{
+   glm::vec3 mean(0.0f), minColor(255.0f), maxColor(0.0f);
+   for (uint32_t p = 0; p < 16; p++)
+   {
+      const glm::vec3 color(block.ch[0][p], block.ch[1][p], block.ch[2][p]);
+      mean += color;
+      minColor = glm::min(minColor, color);
+      maxColor = glm::max(maxColor, color);
+   }
+   mean /= 16.0f;
+
+   // Bounding box, with the diagonal oriented along the correlation of the channels:
+   glm::vec3 e0, e1;
+   glm::vec3 greenCov(0.0f);
+   for (uint32_t p = 0; p < 16; p++)
+   {
+      const glm::vec3 d = glm::vec3(block.ch[0][p], block.ch[1][p], block.ch[2][p]) - mean;
+      greenCov += d * d.g;
+   }
+   const glm::vec3 inset = (maxColor - minColor) / 16.0f;
+   e0 = maxColor - inset;
+   e1 = minColor + inset;
+   if (greenCov.r < 0.0f)
+      std::swap(e0.r, e1.r);
+   if (greenCov.b < 0.0f)
+      std::swap(e0.b, e1.b);
+   uint8_t index[16];
+   const float boxError = encodeBc1Endpoints(block, glm::value_ptr(e0), glm::value_ptr(e1), out, index);
+   if (!quality)
+      return;
+
+   // Principal axis (power iteration on the covariance matrix):
+   glm::mat3 cov(0.0f);
+   for (uint32_t p = 0; p < 16; p++)
+   {
+      const glm::vec3 d = glm::vec3(block.ch[0][p], block.ch[1][p], block.ch[2][p]) - mean;
+      cov += glm::outerProduct(d, d);
+   }
+   glm::vec3 axis = maxColor - minColor;
+   for (uint32_t c = 0; c < 8; c++)
+   {
+      axis = cov * axis;
+      const float length = glm::length(axis);
+      if (length < 1e-6f)
+         break;
+      axis /= length;
+   }
+   if (glm::length(axis) < 1e-6f)
+      axis = glm::vec3(1.0f, 0.0f, 0.0f);
+   float tMin = FLT_MAX, tMax = -FLT_MAX;
+   for (uint32_t p = 0; p < 16; p++)
+   {
+      const float t = glm::dot(glm::vec3(block.ch[0][p], block.ch[1][p], block.ch[2][p]) - mean, axis);
+      tMin = std::min(tMin, t);
+      tMax = std::max(tMax, t);
+   }
+   e0 = glm::clamp(mean + axis * tMax, 0.0f, 255.0f);
+   e1 = glm::clamp(mean + axis * tMin, 0.0f, 255.0f);
+
+   uint8_t boxBlock[8];
+   memcpy(boxBlock, out, sizeof(boxBlock));
+   float bestError = encodeBc1Endpoints(block, glm::value_ptr(e0), glm::value_ptr(e1), out, index);
+
+   // Least-squares refinement of the endpoints for the chosen indices:
+   static const float weight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+   for (uint32_t iteration = 0; iteration < 2; iteration++)
+   {
+      uint16_t c0, c1;
+      memcpy(&c0, out, sizeof(uint16_t));
+      memcpy(&c1, out + 2, sizeof(uint16_t));
+      if (c0 == c1)
+         break;
+
+      float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+      glm::vec3 ax(0.0f), bx(0.0f);
+      for (uint32_t p = 0; p < 16; p++)
+      {
+         const float a = weight[index[p]];
+         const float b = 1.0f - a;
+         const glm::vec3 color(block.ch[0][p], block.ch[1][p], block.ch[2][p]);
+         aa += a * a;
+         bb += b * b;
+         ab += a * b;
+         ax += a * color;
+         bx += b * color;
+      }
+      const float det = aa * bb - ab * ab;
+      if (std::abs(det) < 1e-6f)
+         break;
+      e0 = glm::clamp((ax * bb - bx * ab) / det, 0.0f, 255.0f);
+      e1 = glm::clamp((bx * aa - ax * ab) / det, 0.0f, 255.0f);
+
+      uint8_t candidate[8], candidateIndex[16];
+      const float error = encodeBc1Endpoints(block, glm::value_ptr(e0), glm::value_ptr(e1), candidate, candidateIndex);
+      if (error >= bestError)
+         break;
+      bestError = error;
+      memcpy(out, candidate, sizeof(candidate));
+      memcpy(index, candidateIndex, sizeof(candidateIndex));
+   }
+
+   // Keep the bounding box if better:
+   if (boxError < bestError)
+      memcpy(out, boxBlock, sizeof(boxBlock));
+}
+
+
+/**
+ * Builds the BC4 palette of two endpoints, as decoded by the GPU.
+ * @param a0 first endpoint
+ * @param a1 second endpoint
+ * @param palette output palette
+ */
+static void buildBc4Palette(uint8_t a0, uint8_t a1, uint8_t *palette)
+{
+   palette[0] = a0;
+   palette[1] = a1;
+   if (a0 > a1)
+      for (uint32_t c = 1; c < 7; c++)
+         palette[c + 1] = static_cast<uint8_t>(((7 - c) * a0 + c * a1) / 7);
+   else
+   {
+      for (uint32_t c = 1; c < 5; c++)
+         palette[c + 1] = static_cast<uint8_t>(((5 - c) * a0 + c * a1) / 5);
+      palette[6] = 0;
+      palette[7] = 255;
+   }
+}
+
+
+/**
+ * Encodes a single channel with the given endpoints in the BC4 format.
+ * @param values the 16 (16-byte aligned) channel values
+ * @param a0 first endpoint
+ * @param a1 second endpoint
+ * @param out 8 bytes of output
+ * @return sum of the squared errors
+ */
+static float encodeBc4Endpoints(const float *values, uint8_t a0, uint8_t a1, uint8_t *out)
+{
+   uint8_t palette8[8];
+   buildBc4Palette(a0, a1, palette8);
+   float palette[8][4];
+   for (uint32_t e = 0; e < 8; e++)
+      palette[e][0] = static_cast<float>(palette8[e]);
+
+   uint8_t index[16];
+   const float error = fitIndices(&values, 1, palette, 8, index);
+
+   uint64_t bits = 0;
+   for (uint32_t p = 0; p < 16; p++)
+      bits |= static_cast<uint64_t>(index[p]) << (p * 3);
+   out[0] = a0;
+   out[1] = a1;
+   for (uint32_t c = 0; c < 6; c++)
+      out[c + 2] = static_cast<uint8_t>(bits >> (c * 8));
+
+   // Done:
+   return error;
+}
+
+
+/**
+ * Encodes a single channel in the BC4 format.
+ * @param values the 16 (16-byte aligned) channel values
+ * @param quality when true, searches the endpoints around the value range and also tries the six-value mode
+ * @param out 8 bytes of output
+ */
+static void encodeBc4(const float *values, bool quality, uint8_t *out)
+{
+   float minValue = 255.0f, maxValue = 0.0f;
+   float minInner = 255.0f, maxInner = 0.0f;
+   for (uint32_t p = 0; p < 16; p++)
+   {
+      minValue = std::min(minValue, values[p]);
+      maxValue = std::max(maxValue, values[p]);
+      if (values[p] > 0.0f && values[p] < 255.0f)
+      {
+         minInner = std::min(minInner, values[p]);
+         maxInner = std::max(maxInner, values[p]);
+      }
+   }
+   const int32_t lo = static_cast<int32_t>(minValue + 0.5f);
+   const int32_t hi = static_cast<int32_t>(maxValue + 0.5f);
+
+   // Eight-value mode needs a0 > a1:
+   if (!quality || hi == lo)
+   {
+      encodeBc4Endpoints(values, static_cast<uint8_t>(hi), static_cast<uint8_t>(lo), out);
+      return;
+   }
+
+   float bestError = FLT_MAX;
+   uint8_t candidate[8];
+   for (int32_t d0 = -2; d0 <= 0; d0++)
+      for (int32_t d1 = 0; d1 <= 2; d1++)
+      {
+         const int32_t a0 = hi + d0;
+         const int32_t a1 = lo + d1;
+         if (a0 <= a1)
+            continue;
+         const float error = encodeBc4Endpoints(values, static_cast<uint8_t>(a0), static_cast<uint8_t>(a1), candidate);
+         if (error < bestError)
+         {
+            bestError = error;
+            memcpy(out, candidate, sizeof(candidate));
+         }
+      }
+
+   // Six-value mode, with exact 0 and 255:
+   if (minInner <= maxInner)
+   {
+      const float error = encodeBc4Endpoints(values, static_cast<uint8_t>(minInner + 0.5f), static_cast<uint8_t>(maxInner + 0.5f), candidate);
+      if (error < bestError)
+         memcpy(out, candidate, sizeof(candidate));
+   }
+}
+
+
+/**
+ * Decodes a BC1 color block.
+ * @param in 8 bytes of input
+ * @param pixel output RGBA pixels
+ */
+static void decodeBc1(const uint8_t *in, uint8_t (*pixel)[4])
+{
+   uint16_t c0, c1;
+   uint32_t bits;
+   memcpy(&c0, in, sizeof(uint16_t));
+   memcpy(&c1, in + 2, sizeof(uint16_t));
+   memcpy(&bits, in + 4, sizeof(uint32_t));
+
+   uint8_t palette[4][4];
+   buildBc1Palette(c0, c1, palette);
+   for (uint32_t p = 0; p < 16; p++)
+      memcpy(pixel[p], palette[(bits >> (p * 2)) & 3], 3);
+}
+
+
+/**
+ * Decodes a BC4 block into a channel.
+ * @param in 8 bytes of input
+ * @param pixel output RGBA pixels
+ * @param channel channel to write
+ */
+static void decodeBc4(const uint8_t *in, uint8_t (*pixel)[4], uint32_t channel)
+{
+   uint8_t palette[8];
+   buildBc4Palette(in[0], in[1], palette);
+   uint64_t bits = 0;
+   for (uint32_t c = 0; c < 6; c++)
+      bits |= static_cast<uint64_t>(in[c + 2]) << (c * 8);
+   for (uint32_t p = 0; p < 16; p++)
+      pixel[p][channel] = palette[(bits >> (p * 3)) & 7];
+}
+
+
+/**
+ * Returns the size of a block of the given compressed format.
+ * @param format compressed format
+ * @return size in bytes, or 0 for uncompressed formats
+ */
+static uint32_t getBlockSize(Eng::Bitmap::Format format)
+{
+   switch (format)
+   {
+      case Eng::Bitmap::Format::r8_compressed:         return 8;
+      case Eng::Bitmap::Format::r8g8b8_compressed:     return 8;
+      case Eng::Bitmap::Format::r8g8_compressed:       return 16;
+      case Eng::Bitmap::Format::r8g8b8a8_compressed:   return 16;
+      default:                                         return 0;
+   }
+}
+
+
+/**
+ * Expands a level of a bitmap to RGBA8, decoding compressed formats. Channels missing in the format are set to 0
+ * (alpha to 255), as when sampled by the GPU.
+ * @param bitmap source bitmap
+ * @param level level to expand
+ * @param rgba destination image
+ * @return TF (false for unsupported formats)
+ */
+static bool expandLevel(const Eng::Bitmap &bitmap, uint32_t level, std::vector<uint8_t> &rgba)
+{
+   const uint32_t sizeX = bitmap.getSizeX(level);
+   const uint32_t sizeY = bitmap.getSizeY(level);
+   const uint8_t *src = bitmap.getData(level);
+   rgba.resize(static_cast<uint64_t>(sizeX) * sizeY * 4);
+
+   // Uncompressed:
+   const Eng::Bitmap::Format format = bitmap.getFormat();
+   if (format == Eng::Bitmap::Format::r8g8b8 || format == Eng::Bitmap::Format::r8g8b8a8)
+   {
+      const uint32_t colorDepth = bitmap.getColorDepth();
+      for (uint64_t p = 0; p < static_cast<uint64_t>(sizeX) * sizeY; p++)
+      {
+         memcpy(&rgba[p * 4], src + p * colorDepth, colorDepth);
+         if (colorDepth == 3)
+            rgba[p * 4 + 3] = 255;
+      }
+      return true;
+   }
+
+   // Compressed:
+   const uint32_t blockSize = getBlockSize(format);
+   if (blockSize == 0)
+      return false;
+   for (uint32_t by = 0; by < (sizeY + 3) / 4; by++)
+      for (uint32_t bx = 0; bx < (sizeX + 3) / 4; bx++, src += blockSize)
+      {
+         uint8_t pixel[16][4];
+         for (uint32_t p = 0; p < 16; p++)
+         {
+            pixel[p][0] = pixel[p][1] = pixel[p][2] = 0;
+            pixel[p][3] = 255;
+         }
+         switch (format)
+         {
+            case Eng::Bitmap::Format::r8g8b8_compressed:   decodeBc1(src, pixel); break;
+            case Eng::Bitmap::Format::r8g8b8a8_compressed: decodeBc4(src, pixel, 3); decodeBc1(src + 8, pixel); break;
+            case Eng::Bitmap::Format::r8g8_compressed:     decodeBc4(src, pixel, 0); decodeBc4(src + 8, pixel, 1); break;
+            default:                                       decodeBc4(src, pixel, 0);
+         }
+         for (uint32_t y = 0; y < 4 && by * 4 + y < sizeY; y++)
+            for (uint32_t x = 0; x < 4 && bx * 4 + x < sizeX; x++)
+               memcpy(&rgba[(static_cast<uint64_t>(by * 4 + y) * sizeX + bx * 4 + x) * 4], pixel[y * 4 + x], 4);
+      }
+
+   // Done:
+   return true;
+}
+
+
+/**
+ * Block-compresses RGBA8 levels, encoding the rows of blocks on the ThreadPool.
+ * @param format target compressed format
+ * @param quality quality preset flag
+ * @param rgba source levels
+ * @param size size of each level
+ * @param first first level to encode
+ * @param out compressed levels (same indexing as the source ones)
+ */
+static void encodeLevels(Eng::Bitmap::Format format, bool quality, const std::vector<std::vector<uint8_t>> &rgba,
+                         const std::vector<glm::u32vec2> &size, uint32_t first, std::vector<std::vector<uint8_t>> &out)
+{
+   const uint32_t blockSize = getBlockSize(format);
+   std::vector<glm::u32vec2> rows;
+   out.resize(rgba.size());
+   for (uint32_t l = first; l < rgba.size(); l++)
+   {
+      const uint32_t nrOfBlocksY = (size[l].y + 3) / 4;
+      out[l].resize(static_cast<uint64_t>((size[l].x + 3) / 4) * nrOfBlocksY * blockSize);
+      for (uint32_t by = 0; by < nrOfBlocksY; by++)
+         rows.push_back(glm::u32vec2(l, by));
+   }
+
+   Eng::ThreadPool::getInstance().parallelFor(static_cast<uint32_t>(rows.size()), [&](uint32_t c)
+   {
+      const uint32_t l = rows[c].x;
+      const uint32_t nrOfBlocksX = (size[l].x + 3) / 4;
+      uint8_t *dst = out[l].data() + static_cast<uint64_t>(rows[c].y) * nrOfBlocksX * blockSize;
+      BcBlock block;
+      for (uint32_t bx = 0; bx < nrOfBlocksX; bx++, dst += blockSize)
+      {
+         loadBlock(rgba[l].data(), size[l].x, size[l].y, bx, rows[c].y, block);
+         switch (format)
+         {
+            case Eng::Bitmap::Format::r8g8b8_compressed:
+               encodeBc1(block, quality, dst);
+               break;
+
+            case Eng::Bitmap::Format::r8g8b8a8_compressed:
+               encodeBc4(block.ch[3], quality, dst);
+               encodeBc1(block, quality, dst + 8);
+               break;
+
+            case Eng::Bitmap::Format::r8g8_compressed:
+               encodeBc4(block.ch[0], quality, dst);
+               encodeBc4(block.ch[1], quality, dst + 8);
+               break;
+
+            default:
+               encodeBc4(block.ch[0], quality, dst);
+         }
+      }
+   });
+}
+
+
+/**
+ * @brief Tap of a mip filter: source pixel 2 * x + offset contributes to destination pixel x.
+ */
+struct MipTap
+{
+   int32_t offset;                  ///< Offset from the first source pixel of the destination one
+   float weight;                    ///< Normalized weight
+};
+
+
+/**
+ * @brief Conversion tables between 8-bit values and linear intensities.
+ */
+struct MipTables
+{
+   float linear[256];               ///< 8-bit to [0, 1]
+   float srgbToLinear[256];         ///< 8-bit sRGB to linear [0, 1]
+   uint8_t linearToSrgb[4096];      ///< Linear [0, 1] (12 bits) to 8-bit sRGB
+
+
+   /**
+    * Constructor.
+    */
+   MipTables()
+   {
+      for (uint32_t c = 0; c < 256; c++)
+      {
+         const float v = c / 255.0f;
+         linear[c] = v;
+         srgbToLinear[c] = v <= 0.04045f ? v / 12.92f : powf((v + 0.055f) / 1.055f, 2.4f);
+      }
+      for (uint32_t c = 0; c < 4096; c++)
+      {
+         const float v = c / 4095.0f;
+         const float s = v <= 0.0031308f ? v * 12.92f : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f;
+         linearToSrgb[c] = static_cast<uint8_t>(s * 255.0f + 0.5f);
+      }
+   }
+};
+
+
+/**
+ * Returns the conversion tables (built on first use).
+ * @return tables
+ */
+static const MipTables &getMipTables()
+{
+   static const MipTables tables;
+   return tables;
+}
+
+
+/**
+ * Zeroth-order modified Bessel function of the first kind (series expansion).
+ * @param x argument
+ * @return I0(x)
+ */
+static float bessel0(float x)
+{
+   float sum = 1.0f, term = 1.0f;
+   for (uint32_t k = 1; k < 32 && term > sum * 1e-7f; k++)
+   {
+      const float f = x / (2.0f * k);
+      term *= f * f;
+      sum += term;
+   }
+   return sum;
+}
+
+
+/**
+ * Builds the taps of a filter halving an image along one axis.
+ * @param filter filter kind
+ * @return normalized taps
+ */
+static std::vector<MipTap> buildMipKernel(Eng::Bitmap::Filter filter)
+{
+   std::vector<MipTap> kernel;
+   if (filter == Eng::Bitmap::Filter::box)
+   {
+      kernel.push_back({ 0, 0.5f });
+      kernel.push_back({ 1, 0.5f });
+      return kernel;
+   }
+
+   // Kaiser-windowed sinc, radius of 3 destination pixels:
+   const float radius = 3.0f;
+   const float alpha = 4.0f;
+   const float pi = glm::pi<float>();
+   float sum = 0.0f;
+   for (int32_t k = -5; k <= 6; k++)
+   {
+      const float d = (k - 0.5f) / 2.0f; // Distance between the pixel centers, in destination pixels
+      const float t = d / radius;
+      const float sinc = sinf(pi * d) / (pi * d);
+      const float weight = sinc * bessel0(alpha * sqrtf(1.0f - t * t)) / bessel0(alpha);
+      kernel.push_back({ k, weight });
+      sum += weight;
+   }
+   for (MipTap &tap : kernel)
+      tap.weight /= sum;
+
+   // Done:
+   return kernel;
+}
+
+
+/**
+ * Adds a weighted RGBA value to an accumulator.
+ * @param acc accumulator
+ * @param value value to add
+ * @param weight weight
+ */
+static inline void accumulate(float *acc, const float *value, float weight)
+{
+#ifdef ENG_BITMAP_SSE
+   _mm_storeu_ps(acc, _mm_add_ps(_mm_loadu_ps(acc), _mm_mul_ps(_mm_loadu_ps(value), _mm_set1_ps(weight))));
+#else
+   for (uint32_t c = 0; c < 4; c++)
+      acc[c] += value[c] * weight;
+#endif
+}
+
+
+/**
+ * Halves an RGBA8 image with a separable filter, in linear space. Borders are clamped. Bands of destination rows are
+ * filtered on the ThreadPool.
+ * @param src source image
+ * @param sizeX source width
+ * @param sizeY source height
+ * @param dst destination image
+ * @param kernel filter taps
+ * @param srgb when true, RGB values are sRGB-encoded (alpha is always linear)
+ */
+static void downsampleRgba(const std::vector<uint8_t> &src, uint32_t sizeX, uint32_t sizeY, std::vector<uint8_t> &dst,
+                           const std::vector<MipTap> &kernel, bool srgb)
+{
+   const uint32_t dstX = std::max(sizeX / 2, 1u);
+   const uint32_t dstY = std::max(sizeY / 2, 1u);
+   dst.resize(static_cast<uint64_t>(dstX) * dstY * 4);
+
+   const MipTables &tables = getMipTables();
+   const float *decode = srgb ? tables.srgbToLinear : tables.linear;
+   const uint32_t bandSize = 16;
+   Eng::ThreadPool::getInstance().parallelFor((dstY + bandSize - 1) / bandSize, [&](uint32_t band)
+   {
+      const uint32_t y0 = band * bandSize;
+      const uint32_t y1 = std::min(dstY, y0 + bandSize);
+      const int32_t rowMin = std::max(0, static_cast<int32_t>(y0 * 2) + kernel.front().offset);
+      const int32_t rowMax = std::min(static_cast<int32_t>(sizeY) - 1, static_cast<int32_t>((y1 - 1) * 2) + kernel.back().offset);
+
+      // Horizontal pass, over the source rows used by the band:
+      std::vector<float> rows(static_cast<uint64_t>(rowMax - rowMin + 1) * dstX * 4);
+      for (int32_t sy = rowMin; sy <= rowMax; sy++)
+      {
+         const uint8_t *line = &src[static_cast<uint64_t>(sy) * sizeX * 4];
+         float *out = &rows[static_cast<uint64_t>(sy - rowMin) * dstX * 4];
+         for (uint32_t x = 0; x < dstX; x++, out += 4)
+         {
+            alignas(16) float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (const MipTap &tap : kernel)
+            {
+               const int32_t sx = glm::clamp(static_cast<int32_t>(x * 2) + tap.offset, 0, static_cast<int32_t>(sizeX) - 1);
+               const uint8_t *pixel = line + sx * 4;
+               const float value[4] = { decode[pixel[0]], decode[pixel[1]], decode[pixel[2]], tables.linear[pixel[3]] };
+               accumulate(acc, value, tap.weight);
+            }
+            memcpy(out, acc, sizeof(acc));
+         }
+      }
+
+      // Vertical pass:
+      for (uint32_t y = y0; y < y1; y++)
+         for (uint32_t x = 0; x < dstX; x++)
+         {
+            alignas(16) float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (const MipTap &tap : kernel)
+            {
+               const int32_t sy = glm::clamp(static_cast<int32_t>(y * 2) + tap.offset, rowMin, rowMax);
+               accumulate(acc, &rows[(static_cast<uint64_t>(sy - rowMin) * dstX + x) * 4], tap.weight);
+            }
+
+            uint8_t *pixel = &dst[(static_cast<uint64_t>(y) * dstX + x) * 4];
+            for (uint32_t c = 0; c < 4; c++)
+            {
+               const float v = glm::clamp(acc[c], 0.0f, 1.0f);
+               pixel[c] = (srgb && c < 3) ? tables.linearToSrgb[static_cast<uint32_t>(v * 4095.0f + 0.5f)] : static_cast<uint8_t>(v * 255.0f + 0.5f);
+            }
+         }
+   });
+}
+
+
+/**
+ * Computes the fraction of pixels passing an alpha test.
+ * @param rgba RGBA8 image
+ * @param reference alpha test reference value [0, 1]
+ * @param scale scale applied to the alpha values
+ * @return coverage [0, 1]
+ */
+static float getAlphaCoverage(const std::vector<uint8_t> &rgba, float reference, float scale)
+{
+   const uint64_t nrOfPixels = rgba.size() / 4;
+   uint64_t covered = 0;
+   for (uint64_t p = 0; p < nrOfPixels; p++)
+      if (std::min(rgba[p * 4 + 3] * scale, 255.0f) > reference * 255.0f)
+         covered++;
+   return nrOfPixels ? static_cast<float>(covered) / nrOfPixels : 0.0f;
+}
+
+
 
 /////////////////////////
 // RESERVED STRUCTURES //
@@ -38,7 +850,7 @@
 /**
  * @brief Bitmap reserved structure.
  */
-struct Eng::Bitmap::Reserved
+struct Eng::Bitmap::Reserved : public Eng::Pooled<Eng::Bitmap::Reserved>
 { 
    /**
     * @brief Bitmap layer.
@@ -46,13 +858,15 @@ struct Eng::Bitmap::Reserved
    struct Layer
    {      
       std::vector<uint8_t> data;       ///< Image raw data
+      const uint8_t *view;             ///< Image data inside the mapped file (when not copied)
+      uint32_t nrOfBytes;              ///< Size of the image data
       glm::u32vec2 size;               ///< Layer size
 
 
       /**
        * Constructor.
        */
-      Layer() : size{ 0, 0 }
+      Layer() : view{ nullptr }, nrOfBytes{ 0 }, size{ 0, 0 }
       {}
    };
 
@@ -61,6 +875,7 @@ struct Eng::Bitmap::Reserved
    uint32_t nrOfLevels;             ///< Number of levels (mipmaps)
    uint32_t nrOfSides;              ///< Number of sides (faces)
    float compressionFactor;         ///< Compression factor
+   std::shared_ptr<const Eng::MappedFile> file;   ///< Mapped DDS file referenced by the layers (zero-copy)
 
 
    /**
@@ -260,7 +1075,10 @@ uint8_t ENG_API *Eng::Bitmap::getData(uint32_t level, uint32_t side) const
       return nullptr;
    }
 
-   return reserved->layer[side * reserved->nrOfLevels + level].data.data();
+   Reserved::Layer &l = reserved->layer[side * reserved->nrOfLevels + level];
+   if (l.view) // Read-only
+      return const_cast<uint8_t *>(l.view);
+   return l.data.data();
 }
 
 
@@ -280,7 +1098,19 @@ uint32_t ENG_API Eng::Bitmap::getNrOfBytes(uint32_t level, uint32_t side) const
       return 0;
    }
 
-   return static_cast<uint32_t>(reserved->layer[side * reserved->nrOfLevels + level].data.size());
+   return reserved->layer[side * reserved->nrOfLevels + level].nrOfBytes;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether the image data points into a mapped file instead of being copied (see load()). Mapped data is
+ * read-only.
+ * @return TF
+ */
+bool ENG_API Eng::Bitmap::isMapped() const
+{
+   return reserved->file != nullptr;
 }
 
 
@@ -316,6 +1146,7 @@ bool ENG_API Eng::Bitmap::load(Format format, uint32_t sizeX, uint32_t sizeY, ui
 
    // Free previous image?
    reserved->layer.clear();  
+   reserved->file.reset();
    
    // Force single image:
    reserved->format = format;
@@ -328,6 +1159,7 @@ bool ENG_API Eng::Bitmap::load(Format format, uint32_t sizeX, uint32_t sizeY, ui
    l.size.y = sizeY;
    l.data.resize(size);         
    memcpy(l.data.data(), data, size); 
+   l.nrOfBytes = static_cast<uint32_t>(size);
    
    // Store layer:
    reserved->layer.push_back(l);   
@@ -353,43 +1185,106 @@ bool ENG_API Eng::Bitmap::load(const std::string &filename)
       return false;
    }
   
-   // Free previous image?
-   reserved->layer.clear();  
-
-   // Get file size:
-   FILE *dat = fopen(filename.c_str(), "rb");
-   if (dat == nullptr)
+   // Map file (or archive entry):
+   std::shared_ptr<Eng::MappedFile> file = std::make_shared<Eng::MappedFile>();
+   if (file->open(filename) == false)
    {
       ENG_LOG_ERROR("File '%s' not found", filename.c_str());
       return false;
    }
-   fseek(dat, 0, SEEK_END);
-   uint64_t filesize = ftell(dat);
-   fseek(dat, 0, SEEK_SET);
 
-   // Copy file to memory:
-   std::vector<uint8_t> data(filesize);
-   uint8_t *position = data.data();
-   if (fread(position, sizeof(uint8_t), filesize, dat) != filesize)
+   // Done:
+   return load(file);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Load image from a mapped .dds file without copying it: the levels point into the mapping, which is kept open
+ * until the bitmap is released or reloaded.
+ * @param file mapped DDS file (or a view of it)
+ * @return TF
+ */
+bool ENG_API Eng::Bitmap::load(const std::shared_ptr<const Eng::MappedFile> &file)
+{
+   // Safety net:
+   if (file == nullptr || !file->isOpen())
    {
-      ENG_LOG_ERROR("File '%s' damaged", filename.c_str());
-      fclose(dat);
+      ENG_LOG_ERROR("Invalid params");
       return false;
    }
-   fclose(dat);
+
+   reserved->file = file;
+   if (parse(file->getData(), file->getNrOfBytes(), file->getFilename(), false) == false)
+   {
+      reserved->file.reset();
+      return false;
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Load image from a .dds file already in memory. The data is copied.
+ * @param dds pointer to the DDS file content
+ * @param nrOfBytes size of the DDS file content
+ * @param name name given to the bitmap (usually the file name)
+ * @return TF
+ */
+bool ENG_API Eng::Bitmap::load(const void *dds, uint64_t nrOfBytes, const std::string &name)
+{
+   const bool done = parse(dds, nrOfBytes, name, true);
+   reserved->file.reset();
+
+   // Done:
+   return done;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Parses the content of a .dds file.
+ * @param dds pointer to the DDS file content
+ * @param nrOfBytes size of the DDS file content
+ * @param name name given to the bitmap (usually the file name)
+ * @param copy when false, the levels point into the given memory, which must outlive the bitmap
+ * @return TF
+ */
+bool ENG_API Eng::Bitmap::parse(const void *dds, uint64_t nrOfBytes, const std::string &name, bool copy)
+{
+   // Safety net:
+   if (dds == nullptr || nrOfBytes < sizeof(uint32_t) + sizeof(DDS_HEADER))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Free previous image?
+   reserved->layer.clear();  
+
+   const uint8_t *position = static_cast<const uint8_t *>(dds);
+   const uint8_t *end = position + nrOfBytes;
 
    // Check header:   
    uint32_t magicNumber;
    memcpy(&magicNumber, position, sizeof(uint32_t)); position += sizeof(uint32_t);
    if (magicNumber != DDS_MAGICNUMBER)
    {
-      ENG_LOG_ERROR("File '%s' is not a valid DDS", filename.c_str());      
+      ENG_LOG_ERROR("File '%s' is not a valid DDS", name.c_str());      
       return false;
    }
 
    // Get header:
-   DDS_HEADER *header = reinterpret_cast<DDS_HEADER *> (position); position += sizeof(DDS_HEADER);
-   reserved->nrOfLevels = header->dwMipMapCount;
+   const DDS_HEADER *header = reinterpret_cast<const DDS_HEADER *> (position); position += sizeof(DDS_HEADER);
+   if (header->dwSize != sizeof(DDS_HEADER) || header->dwWidth == 0 || header->dwHeight == 0 || header->dwMipMapCount > 32)
+   {
+      ENG_LOG_ERROR("File '%s' has an invalid DDS header", name.c_str());
+      return false;
+   }
+   reserved->nrOfLevels = std::max(header->dwMipMapCount, 1u);
 
    // Cubemap (old format)?
    reserved->nrOfSides = 1;
@@ -407,7 +1302,7 @@ bool ENG_API Eng::Bitmap::load(const std::string &filename)
       if (!(header->dwCaps2 & DDSCAPS2_CUBEMAP_NEGATIVEZ)) complete = false;
       if (!complete)
       {
-         ENG_LOG_ERROR("File '%s' is an incomplete cubemap", filename.c_str());         
+         ENG_LOG_ERROR("File '%s' is an incomplete cubemap", name.c_str());         
          return false;
       }
       reserved->nrOfSides = 6;
@@ -434,7 +1329,12 @@ bool ENG_API Eng::Bitmap::load(const std::string &filename)
                if (strcmp(fourCC, "DX10") == 0)
                {
                   // Get header10:
-                  DDS_HEADER10 *header10 = reinterpret_cast<DDS_HEADER10 *> (position); position += sizeof(DDS_HEADER10);
+                  if (position + sizeof(DDS_HEADER10) > end)
+                  {
+                     ENG_LOG_ERROR("File '%s' is truncated", name.c_str());
+                     return false;
+                  }
+                  const DDS_HEADER10 *header10 = reinterpret_cast<const DDS_HEADER10 *> (position); position += sizeof(DDS_HEADER10);
 
                   // Cube map (new format)?
                   ENG_LOG_DEBUG("Array: %u", header10->arraySize);
@@ -456,13 +1356,13 @@ bool ENG_API Eng::Bitmap::load(const std::string &filename)
                         break;
 
                      default:
-                        ENG_LOG_ERROR("File '%s' uses an unsupported DX10 compression format", filename.c_str());                                                
+                        ENG_LOG_ERROR("File '%s' uses an unsupported DX10 compression format", name.c_str());                                                
                         return false;
                   }
                }
                else
                {
-                  ENG_LOG_ERROR("File '%s' uses an unsupported compression format", filename.c_str());                  
+                  ENG_LOG_ERROR("File '%s' uses an unsupported compression format", name.c_str());                  
                   return false;
                }   
    
@@ -495,8 +1395,21 @@ bool ENG_API Eng::Bitmap::load(const std::string &filename)
             levelSize = 8;
          if (reserved->compressionFactor == 1.0f && levelSize < 16)
             levelSize = 16;
-         curLayer.data.resize(levelSize);         
-         memcpy(curLayer.data.data(), position, levelSize); position += levelSize;
+         if (position + levelSize > end)
+         {
+            ENG_LOG_ERROR("File '%s' is truncated", name.c_str());
+            reserved->layer.clear();
+            return false;
+         }
+         if (copy)
+         {
+            curLayer.data.resize(levelSize);         
+            memcpy(curLayer.data.data(), position, levelSize); 
+         }
+         else
+            curLayer.view = position;
+         curLayer.nrOfBytes = levelSize;
+         position += levelSize;
 
          ENG_LOG_DEBUG("Mipmap: %u, %ux%u, %u bytes", c, sizeX, sizeY, levelSize);
 
@@ -509,6 +1422,342 @@ bool ENG_API Eng::Bitmap::load(const std::string &filename)
    }   
    
    // Done:
-   this->setName(filename);
+   this->setName(name);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Block-compresses an uncompressed (r8g8b8 or r8g8b8a8) bitmap into one of the compressed formats: BC1
+ * (r8g8b8_compressed), BC3 (r8g8b8a8_compressed), BC5 (r8g8_compressed, red and green) or BC4 (r8_compressed, red).
+ * Blocks are encoded on the ThreadPool.
+ * @param format target compressed format
+ * @param preset speed/quality trade-off
+ * @param mipmaps when true and the bitmap has a single level, the full mip chain is generated first (with the
+ *        default generateMipmaps() settings; call it beforehand for other ones)
+ * @return TF
+ */
+bool ENG_API Eng::Bitmap::compress(Format format, Preset preset, bool mipmaps)
+{
+   // Safety net:
+   const uint32_t blockSize = getBlockSize(format);
+   if (blockSize == 0 || (reserved->format != Format::r8g8b8 && reserved->format != Format::r8g8b8a8) || reserved->nrOfSides != 1)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   Eng::Timer &timer = Eng::Timer::getInstance();
+   const uint64_t start = timer.getCounter();
+
+   // Mip chain:
+   if (mipmaps && reserved->nrOfLevels == 1 && generateMipmaps() == false)
+      return false;
+
+   // Expand the levels to RGBA8:
+   std::vector<std::vector<uint8_t>> rgba(reserved->nrOfLevels);
+   std::vector<glm::u32vec2> size(reserved->nrOfLevels);
+   uint64_t nrOfPixels = 0;
+   for (uint32_t l = 0; l < reserved->nrOfLevels; l++)
+   {
+      size[l] = reserved->layer[l].size;
+      expandLevel(*this, l, rgba[l]);
+      nrOfPixels += static_cast<uint64_t>(size[l].x) * size[l].y;
+   }
+
+   // Encode:
+   const uint32_t nrOfLevels = reserved->nrOfLevels;
+   std::vector<std::vector<uint8_t>> data;
+   encodeLevels(format, preset == Preset::quality, rgba, size, 0, data);
+   std::vector<Reserved::Layer> layer(nrOfLevels);
+   for (uint32_t l = 0; l < nrOfLevels; l++)
+   {
+      layer[l].size = size[l];
+      layer[l].nrOfBytes = static_cast<uint32_t>(data[l].size());
+      layer[l].data = std::move(data[l]);
+   }
+
+   // Replace the content:
+   reserved->layer = std::move(layer);
+   reserved->file.reset();
+   reserved->format = format;
+   reserved->nrOfLevels = nrOfLevels;
+   reserved->compressionFactor = blockSize / 16.0f;
+
+   // Done:
+   const double elapsed = timer.getCounterDiff(start, timer.getCounter());
+   ENG_LOG_DEBUG("Bitmap '%s' compressed (%u levels) in %.1f ms, %.1f MPixels/s", getName().c_str(), nrOfLevels, elapsed, elapsed > 0.0 ? nrOfPixels / (elapsed * 1000.0) : 0.0);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Replaces the levels after the first one with a full mip chain computed from it, in linear space. Works on
+ * uncompressed (r8g8b8, r8g8b8a8) and compressed bitmaps: compressed levels are decoded, filtered and encoded again
+ * (fast preset), while the first level is kept as is. Rows are filtered on the ThreadPool.
+ * @param filter downsampling filter
+ * @param srgb when true, RGB values are treated as sRGB-encoded (alpha is always linear)
+ * @param alphaReference when in [0, 1], the alpha of each level is scaled to keep the fraction of pixels passing an
+ *        alpha test against this value equal to the one of the first level (ignored without alpha)
+ * @return TF
+ */
+bool ENG_API Eng::Bitmap::generateMipmaps(Filter filter, bool srgb, float alphaReference)
+{
+   // Safety net:
+   const bool compressed = getBlockSize(reserved->format) != 0;
+   if (reserved->nrOfSides != 1 || reserved->layer.empty() ||
+       (!compressed && reserved->format != Format::r8g8b8 && reserved->format != Format::r8g8b8a8))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   Eng::Timer &timer = Eng::Timer::getInstance();
+   const uint64_t start = timer.getCounter();
+
+   // Filter the chain:
+   std::vector<std::vector<uint8_t>> rgba(1);
+   std::vector<glm::u32vec2> size(1, reserved->layer[0].size);
+   expandLevel(*this, 0, rgba[0]);
+   const std::vector<MipTap> kernel = buildMipKernel(filter);
+   uint64_t nrOfPixels = 0;
+   while (size.back().x > 1 || size.back().y > 1)
+   {
+      rgba.emplace_back();
+      downsampleRgba(rgba[rgba.size() - 2], size.back().x, size.back().y, rgba.back(), kernel, srgb);
+      size.push_back(glm::u32vec2(std::max(size.back().x / 2, 1u), std::max(size.back().y / 2, 1u)));
+      nrOfPixels += static_cast<uint64_t>(size.back().x) * size.back().y;
+   }
+   const uint32_t nrOfLevels = static_cast<uint32_t>(rgba.size());
+
+   // Preserve the alpha-test coverage:
+   const bool hasAlpha = reserved->format == Format::r8g8b8a8 || reserved->format == Format::r8g8b8a8_compressed;
+   if (hasAlpha && alphaReference >= 0.0f && alphaReference <= 1.0f)
+   {
+      const float coverage = getAlphaCoverage(rgba[0], alphaReference, 1.0f);
+      for (uint32_t l = 1; l < nrOfLevels; l++)
+      {
+         float low = 0.0f, high = 4.0f;
+         for (uint32_t c = 0; c < 12; c++)
+         {
+            const float scale = (low + high) * 0.5f;
+            if (getAlphaCoverage(rgba[l], alphaReference, scale) < coverage)
+               low = scale;
+            else
+               high = scale;
+         }
+         for (uint64_t p = 0; p < rgba[l].size() / 4; p++)
+            rgba[l][p * 4 + 3] = static_cast<uint8_t>(std::min(rgba[l][p * 4 + 3] * high + 0.5f, 255.0f));
+      }
+   }
+
+   // Store the new levels in the bitmap format:
+   std::vector<std::vector<uint8_t>> data(nrOfLevels);
+   if (compressed)
+      encodeLevels(reserved->format, false, rgba, size, 1, data);
+   else
+   {
+      const uint32_t colorDepth = getColorDepth();
+      for (uint32_t l = 1; l < nrOfLevels; l++)
+      {
+         const uint64_t nrOfLevelPixels = static_cast<uint64_t>(size[l].x) * size[l].y;
+         data[l].resize(nrOfLevelPixels * colorDepth);
+         for (uint64_t p = 0; p < nrOfLevelPixels; p++)
+            memcpy(&data[l][p * colorDepth], &rgba[l][p * 4], colorDepth);
+      }
+   }
+   reserved->layer.resize(1);
+   for (uint32_t l = 1; l < nrOfLevels; l++)
+   {
+      Reserved::Layer layer;
+      layer.size = size[l];
+      layer.nrOfBytes = static_cast<uint32_t>(data[l].size());
+      layer.data = std::move(data[l]);
+      reserved->layer.push_back(std::move(layer));
+   }
+   reserved->nrOfLevels = nrOfLevels;
+
+   // Done:
+   const double elapsed = timer.getCounterDiff(start, timer.getCounter());
+   ENG_LOG_DEBUG("Bitmap '%s': %u levels generated in %.1f ms, %.1f MPixels/s", getName().c_str(), nrOfLevels, elapsed, elapsed > 0.0 ? nrOfPixels / (elapsed * 1000.0) : 0.0);
    return true;
 }
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Packs the first channel of two or three single-channel bitmaps (e.g., roughness, metalness and ambient occlusion)
+ * into one block-compressed bitmap with a full mip chain: BC5 (r8g8_compressed) for two channels, BC1
+ * (r8g8b8_compressed) for three. Sources can be compressed and must have the same size.
+ * @param red source of the red channel
+ * @param green source of the green channel
+ * @param blue optional source of the blue channel
+ * @param preset speed/quality trade-off
+ * @return TF
+ */
+bool ENG_API Eng::Bitmap::pack(const Eng::Bitmap &red, const Eng::Bitmap &green, const Eng::Bitmap &blue, Preset preset)
+{
+   // Safety net:
+   const bool hasBlue = blue != Eng::Bitmap::empty;
+   if (red == Eng::Bitmap::empty || green == Eng::Bitmap::empty ||
+       red.getSizeX() != green.getSizeX() || red.getSizeY() != green.getSizeY() ||
+       (hasBlue && (red.getSizeX() != blue.getSizeX() || red.getSizeY() != blue.getSizeY())))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   std::vector<uint8_t> source[3];
+   if (!expandLevel(red, 0, source[0]) || !expandLevel(green, 0, source[1]) || (hasBlue && !expandLevel(blue, 0, source[2])))
+   {
+      ENG_LOG_ERROR("Unsupported format");
+      return false;
+   }
+
+   // Merge the channels:
+   const uint32_t sizeX = red.getSizeX();
+   const uint32_t sizeY = red.getSizeY();
+   const std::string name = red.getName() + "|" + green.getName() + (hasBlue ? "|" + blue.getName() : "");
+   std::vector<uint8_t> packed(static_cast<uint64_t>(sizeX) * sizeY * 3, 0);
+   for (uint64_t p = 0; p < static_cast<uint64_t>(sizeX) * sizeY; p++)
+   {
+      packed[p * 3 + 0] = source[0][p * 4];
+      packed[p * 3 + 1] = source[1][p * 4];
+      if (hasBlue)
+         packed[p * 3 + 2] = source[2][p * 4];
+   }
+   if (this->load(Format::r8g8b8, sizeX, sizeY, packed.data()) == false)
+      return false;
+   this->setName(name);
+
+   // Done:
+   return compress(hasBlue ? Format::r8g8b8_compressed : Format::r8g8_compressed, preset, true);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Computes the peak signal-to-noise ratio of a compressed level against its uncompressed reference, over the channels
+ * stored by the compressed format.
+ * @param reference uncompressed bitmap (r8g8b8 or r8g8b8a8)
+ * @param compressed compressed bitmap with the same size
+ * @param level level to compare
+ * @return PSNR in dB (infinity for identical images), or 0 on error
+ */
+double ENG_API Eng::Bitmap::computePsnr(const Eng::Bitmap &reference, const Eng::Bitmap &compressed, uint32_t level)
+{
+   // Safety net:
+   const uint32_t blockSize = getBlockSize(compressed.getFormat());
+   if (blockSize == 0 || (reference.getFormat() != Format::r8g8b8 && reference.getFormat() != Format::r8g8b8a8) ||
+       level >= reference.getNrOfLevels() || level >= compressed.getNrOfLevels() ||
+       reference.getSizeX(level) != compressed.getSizeX(level) || reference.getSizeY(level) != compressed.getSizeY(level))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return 0.0;
+   }
+
+   const uint32_t sizeX = reference.getSizeX(level);
+   const uint32_t sizeY = reference.getSizeY(level);
+   const uint32_t colorDepth = reference.getColorDepth();
+   const uint32_t nrOfChannels = compressed.getColorDepth();
+   const uint8_t *src = reference.getData(level);
+   const uint8_t *block = compressed.getData(level);
+   double error = 0.0;
+   for (uint32_t by = 0; by < (sizeY + 3) / 4; by++)
+      for (uint32_t bx = 0; bx < (sizeX + 3) / 4; bx++, block += blockSize)
+      {
+         uint8_t pixel[16][4] = {};
+         switch (compressed.getFormat())
+         {
+            case Format::r8g8b8_compressed:   decodeBc1(block, pixel); break;
+            case Format::r8g8b8a8_compressed: decodeBc4(block, pixel, 3); decodeBc1(block + 8, pixel); break;
+            case Format::r8g8_compressed:     decodeBc4(block, pixel, 0); decodeBc4(block + 8, pixel, 1); break;
+            default:                          decodeBc4(block, pixel, 0);
+         }
+         for (uint32_t y = 0; y < 4 && by * 4 + y < sizeY; y++)
+            for (uint32_t x = 0; x < 4 && bx * 4 + x < sizeX; x++)
+            {
+               const uint8_t *ref = src + (static_cast<uint64_t>(by * 4 + y) * sizeX + bx * 4 + x) * colorDepth;
+               for (uint32_t c = 0; c < nrOfChannels; c++)
+               {
+                  const double d = static_cast<double>(c < colorDepth ? ref[c] : 255) - pixel[y * 4 + x][c];
+                  error += d * d;
+               }
+            }
+      }
+
+   // Done:
+   const double mse = error / (static_cast<double>(sizeX) * sizeY * nrOfChannels);
+   if (mse == 0.0)
+      return std::numeric_limits<double>::infinity();
+   return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Compresses a procedural test image into each compressed format with each preset, and logs the throughput
+ * (MPixels/s) and the PSNR of the first level.
+ * @param size test image width and height
+ * @return TF (false when a PSNR is below the expected minimum for its format)
+ */
+bool ENG_API Eng::Bitmap::benchmark(uint32_t size)
+{
+   // Safety net:
+   if (size < 4)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Smooth gradients with some high-frequency detail:
+   std::vector<uint8_t> image(static_cast<uint64_t>(size) * size * 4);
+   for (uint32_t y = 0; y < size; y++)
+      for (uint32_t x = 0; x < size; x++)
+      {
+         uint8_t *pixel = &image[(static_cast<uint64_t>(y) * size + x) * 4];
+         const float u = static_cast<float>(x) / size;
+         const float v = static_cast<float>(y) / size;
+         const float detail = 0.5f + 0.5f * sinf(x * 0.7f) * cosf(y * 0.3f);
+         pixel[0] = static_cast<uint8_t>(255.0f * u);
+         pixel[1] = static_cast<uint8_t>(255.0f * (0.8f * v + 0.2f * detail));
+         pixel[2] = static_cast<uint8_t>(255.0f * (1.0f - u) * v);
+         pixel[3] = static_cast<uint8_t>(255.0f * detail);
+      }
+   Eng::Bitmap reference(Format::r8g8b8a8, size, size, image.data());
+
+   struct Test
+   {
+      Format format;
+      const char *name;
+      double minPsnr;
+   };
+   const Test tests[] = { { Format::r8g8b8_compressed,   "BC1", 30.0 },
+                          { Format::r8g8b8a8_compressed, "BC3", 30.0 },
+                          { Format::r8g8_compressed,     "BC5", 38.0 },
+                          { Format::r8_compressed,       "BC4", 38.0 } };
+   const Preset presets[] = { Preset::fast, Preset::quality };
+
+   Eng::Timer &timer = Eng::Timer::getInstance();
+   bool passed = true;
+   for (const Test &test : tests)
+      for (Preset preset : presets)
+      {
+         Eng::Bitmap bitmap(Format::r8g8b8a8, size, size, image.data());
+         const uint64_t start = timer.getCounter();
+         bitmap.compress(test.format, preset, false);
+         const double elapsed = timer.getCounterDiff(start, timer.getCounter());
+
+         const double psnr = computePsnr(reference, bitmap);
+         const double speed = elapsed > 0.0 ? (static_cast<double>(size) * size) / (elapsed * 1000.0) : 0.0;
+         ENG_LOG_PLAIN("%s (%s): %.1f MPixels/s, PSNR %.2f dB", test.name, preset == Preset::fast ? "fast" : "quality", speed, psnr);
+         if (psnr < test.minPsnr)
+         {
+            ENG_LOG_ERROR("%s PSNR below %.1f dB", test.name, test.minPsnr);
+            passed = false;
+         }
+      }
+
+   // Done:
+   return passed;
+}
@@ -45,6 +45,26 @@ public: //
    };
 
 
+   /**
+    * @brief Mipmap filters. 
+    */
+   enum class Filter : uint32_t
+   {
+      box,                       ///< 2x2 average
+      kaiser,                    ///< Kaiser-windowed sinc (sharper, less aliasing)
+   };
+
+
+   /**
+    * @brief Block-compression presets. 
+    */
+   enum class Preset : uint32_t
+   {
+      fast,                      ///< Bounding-box endpoints
+      quality,                   ///< Principal-axis endpoints refined by least squares, endpoint search for single channels
+   };
+
+
    // Const/dest:
 	Bitmap();      
 	Bitmap(Bitmap &&other);
@@ -62,11 +82,23 @@ public: //
    uint32_t getNrOfBytes(uint32_t level = 0, uint32_t side = 0) const;
    uint8_t *getData(uint32_t level = 0, uint32_t side = 0) const;   
    float getCompressionFactor() const;
+   bool isMapped() const;
 
    // Loaders:
    bool load(const std::string &filename);
+   bool load(const std::shared_ptr<const Eng::MappedFile> &file);
+   bool load(const void *dds, uint64_t nrOfBytes, const std::string &name);
    bool load(Format format, uint32_t sizeX, uint32_t sizeY, uint8_t *data);
 
+   // Mipmaps:
+   bool generateMipmaps(Filter filter = Filter::box, bool srgb = false, float alphaReference = -1.0f);
+
+   // Block compression:
+   bool compress(Format format, Preset preset = Preset::fast, bool mipmaps = true);
+   bool pack(const Eng::Bitmap &red, const Eng::Bitmap &green, const Eng::Bitmap &blue = Eng::Bitmap::empty, Preset preset = Preset::fast);
+   static double computePsnr(const Eng::Bitmap &reference, const Eng::Bitmap &compressed, uint32_t level = 0);
+   static bool benchmark(uint32_t size = 1024);
+
 
 /////////////
 protected: //
@@ -78,4 +110,7 @@ protected: //
 
    // Const/dest:
    Bitmap(const std::string &name);
+
+   // DDS parser:
+   bool parse(const void *dds, uint64_t nrOfBytes, const std::string &name, bool copy);
 };
@@ -42,7 +42,7 @@
 /**
  * @brief Camera class reserved structure.
  */
-struct Eng::Camera::Reserved
+struct Eng::Camera::Reserved : public Eng::Pooled<Eng::Camera::Reserved>
 {  
    glm::mat4 projMatrix;                         ///< Projection matrix
 
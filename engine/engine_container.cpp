@@ -16,6 +16,9 @@
 
    // C/C++:
    #include <algorithm>
+   #include <future>
+   #include <mutex>
+   #include <unordered_map>
    #include <variant>
 
 
@@ -38,18 +41,90 @@
  */
 struct Eng::Container::Reserved
 {
-   std::list<Eng::Node> allNodes;
-   std::list<Eng::Mesh> allMeshes;
-   std::list<Eng::Light> allLights;
-   std::list<Eng::Material> allMaterials;
-   std::list<Eng::Texture> allTextures;
+   /**
+    * @brief Texture cache entry.
+    */
+   struct CachedTexture
+   {
+      uint32_t nrOfRefs;                        ///< Number of users
+      uint64_t hash;                            ///< Content hash (0 if unknown)
+      std::vector<std::string> paths;           ///< Files resolved to this texture
+   };
+
+   Eng::Pool<Eng::Node> allNodes;
+   Eng::Pool<Eng::Mesh> allMeshes;
+   Eng::Pool<Eng::Light> allLights;
+   Eng::Pool<Eng::Material> allMaterials;
+   Eng::Pool<Eng::Texture> allTextures;
+
+   // Indices (first object added with a given name):
+   std::unordered_map<std::string, Eng::Node *> nodesByName;
+   std::unordered_map<std::string, Eng::Mesh *> meshesByName;
+   std::unordered_map<std::string, Eng::Light *> lightsByName;
+   std::unordered_map<std::string, Eng::Material *> materialsByName;
+   std::unordered_map<std::string, Eng::Texture *> texturesByName;
+   std::unordered_map<uint32_t, Eng::Object *> objectsById;
+
+   // Texture cache:
+   std::unordered_map<std::string, Eng::Texture *> texturesByPath;
+   std::unordered_map<uint64_t, Eng::Texture *> texturesByHash;
+   std::unordered_map<const Eng::Texture *, CachedTexture> cachedTextures;
+   bool textureHashing;
+   bool texturePacking;
+   std::unordered_map<std::string, std::shared_future<std::shared_ptr<const Eng::Bitmap>>> decodedBitmaps;   ///< Images being decoded or waiting for upload
+   mutable std::mutex textureMutex;
    
 
    /**
     * Constructor.
     */
-   Reserved()
+   Reserved() : textureHashing{ true }, texturePacking{ false }
    {}
+
+
+   /**
+    * Moves an object into its pool and indexes it.
+    * @param pool pool of the object type
+    * @param byName name index of the object type
+    * @param obj object to move
+    * @return stored object
+    */
+   template <typename T> T &store(Eng::Pool<T> &pool, std::unordered_map<std::string, T *> &byName, T &obj)
+   {
+      T &stored = pool.add(std::move(obj));
+      byName.emplace(stored.getName(), &stored);
+      objectsById.emplace(stored.getId(), &stored);
+      return stored;
+   }
+
+
+   /**
+    * Removes an object from the indices.
+    * @param byName name index of the object type
+    * @param obj indexed object
+    */
+   template <typename T> void unindex(std::unordered_map<std::string, T *> &byName, const T &obj)
+   {
+      auto name = byName.find(obj.getName());
+      if (name != byName.end() && name->second == &obj)
+         byName.erase(name);
+      auto id = objectsById.find(obj.getId());
+      if (id != objectsById.end() && id->second == &obj)
+         objectsById.erase(id);
+   }
+
+
+   /**
+    * Looks up an object by name.
+    * @param byName name index of the object type
+    * @param name object name
+    * @return object or nullptr
+    */
+   template <typename T> static T *lookup(const std::unordered_map<std::string, T *> &byName, const std::string &name)
+   {
+      auto it = byName.find(name);
+      return (it == byName.end()) ? nullptr : it->second;
+   }
 };
 
 
@@ -95,6 +170,10 @@ ENG_API Eng::Container::Container(Container &&other) : Eng::Object(std::move(oth
  */
 ENG_API Eng::Container::~Container()
 {
+   // Materials release their cached textures, so they must go first:
+   if (reserved)
+      reserved->allMaterials.clear();
+
    ENG_LOG_DETAIL("[-]");
 }
 
@@ -117,10 +196,8 @@ Eng::Container ENG_API &Eng::Container::getInstance()
  */
 Eng::Node ENG_API &Eng::Container::getLastNode() const
 {
-   // Safety net:
-   if (reserved->allNodes.empty())
-      return Eng::Node::empty;
-   return reserved->allNodes.back();
+   Eng::Node *last = reserved->allNodes.getLast();
+   return last ? *last : Eng::Node::empty;
 }
 
 
@@ -131,10 +208,8 @@ Eng::Node ENG_API &Eng::Container::getLastNode() const
  */
 Eng::Mesh ENG_API &Eng::Container::getLastMesh() const
 {
-   // Safety net:
-   if (reserved->allMeshes.empty())
-      return Eng::Mesh::empty;
-   return reserved->allMeshes.back();
+   Eng::Mesh *last = reserved->allMeshes.getLast();
+   return last ? *last : Eng::Mesh::empty;
 }
 
 
@@ -145,10 +220,8 @@ Eng::Mesh ENG_API &Eng::Container::getLastMesh() const
  */
 Eng::Light ENG_API &Eng::Container::getLastLight() const
 {
-   // Safety net:
-   if (reserved->allLights.empty())
-      return Eng::Light::empty;
-   return reserved->allLights.back();
+   Eng::Light *last = reserved->allLights.getLast();
+   return last ? *last : Eng::Light::empty;
 }
 
 
@@ -159,10 +232,8 @@ Eng::Light ENG_API &Eng::Container::getLastLight() const
  */
 Eng::Material ENG_API &Eng::Container::getLastMaterial() const
 {
-   // Safety net:
-   if (reserved->allMaterials.empty())
-      return Eng::Material::empty;
-   return reserved->allMaterials.back();
+   Eng::Material *last = reserved->allMaterials.getLast();
+   return last ? *last : Eng::Material::empty;
 }
 
 
@@ -173,19 +244,17 @@ Eng::Material ENG_API &Eng::Container::getLastMaterial() const
  */
 Eng::Texture ENG_API &Eng::Container::getLastTexture() const
 {
-   // Safety net:
-   if (reserved->allTextures.empty())
-      return Eng::Texture::empty;
-   return reserved->allTextures.back();
+   Eng::Texture *last = reserved->allTextures.getLast();
+   return last ? *last : Eng::Texture::empty;
 }
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Gets direct access to the list of nodes.
- * @return list of nodes
+ * Gets direct access to the pool of nodes (iterable).
+ * @return pool of nodes
  */
-std::list<Eng::Node> ENG_API &Eng::Container::getNodeList()
+Eng::Pool<Eng::Node> ENG_API &Eng::Container::getNodePool()
 {  
    return reserved->allNodes;
 }
@@ -193,10 +262,10 @@ std::list<Eng::Node> ENG_API &Eng::Container::getNodeList()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Gets direct access to the list of meshes.
- * @return list of meshes
+ * Gets direct access to the pool of meshes (iterable).
+ * @return pool of meshes
  */
-std::list<Eng::Mesh> ENG_API &Eng::Container::getMeshList()
+Eng::Pool<Eng::Mesh> ENG_API &Eng::Container::getMeshPool()
 {
    return reserved->allMeshes;
 }
@@ -204,10 +273,10 @@ std::list<Eng::Mesh> ENG_API &Eng::Container::getMeshList()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Gets direct access to the list of lights.
- * @return list of lights
+ * Gets direct access to the pool of lights (iterable).
+ * @return pool of lights
  */
-std::list<Eng::Light> ENG_API &Eng::Container::getLightList()
+Eng::Pool<Eng::Light> ENG_API &Eng::Container::getLightPool()
 {
    return reserved->allLights;
 }
@@ -215,10 +284,10 @@ std::list<Eng::Light> ENG_API &Eng::Container::getLightList()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Gets direct access to the list of materials.
- * @return list of materials
+ * Gets direct access to the pool of materials (iterable).
+ * @return pool of materials
  */
-std::list<Eng::Material> ENG_API &Eng::Container::getMaterialList()
+Eng::Pool<Eng::Material> ENG_API &Eng::Container::getMaterialPool()
 {
    return reserved->allMaterials;
 }
@@ -226,10 +295,10 @@ std::list<Eng::Material> ENG_API &Eng::Container::getMaterialList()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Gets direct access to the list of textures.
- * @return list of textures
+ * Gets direct access to the pool of textures (iterable).
+ * @return pool of textures
  */
-std::list<Eng::Texture> ENG_API &Eng::Container::getTextureList()
+Eng::Pool<Eng::Texture> ENG_API &Eng::Container::getTexturePool()
 {
    return reserved->allTextures;
 }
@@ -237,7 +306,8 @@ std::list<Eng::Texture> ENG_API &Eng::Container::getTextureList()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Returns, if existing, the first object with the given name among its various lists. 
+ * Returns, if existing, the first object with the given name, looking in materials, textures, meshes, lights and
+ * nodes (in this order). Prefer the typed finders when the type is known.
  * @param name object name
  * @return found object or empty
  */
@@ -250,31 +320,17 @@ Eng::Object ENG_API &Eng::Container::find(const std::string &name) const
       return Eng::Object::empty;
    }
 
-   // Seach in materials:
-   for (auto &c : reserved->allMaterials)
-      if (c.getName() == name)
-         return c;
+   if (Eng::Object *obj = Reserved::lookup(reserved->materialsByName, name))
+      return *obj;
+   if (Eng::Object *obj = Reserved::lookup(reserved->texturesByName, name))
+      return *obj;
+   if (Eng::Object *obj = Reserved::lookup(reserved->meshesByName, name))
+      return *obj;
+   if (Eng::Object *obj = Reserved::lookup(reserved->lightsByName, name))
+      return *obj;
+   if (Eng::Object *obj = Reserved::lookup(reserved->nodesByName, name))
+      return *obj;
 
-   // Seach in textures:
-   for (auto &c : reserved->allTextures)
-      if (c.getName() == name)
-         return c;
-   
-   // Seach in geometries:
-   for (auto &c : reserved->allMeshes)
-      if (c.getName() == name)
-         return c;
-
-   // Seach in lights:
-   for (auto &c : reserved->allLights)
-      if (c.getName() == name)
-         return c;
-
-   // Seach in nodes:
-   for (auto &c : reserved->allNodes)
-      if (c.getName() == name)
-         return c;
-   
    // Not found:
    return Eng::Object::empty;
 }
@@ -282,43 +338,181 @@ Eng::Object ENG_API &Eng::Container::find(const std::string &name) const
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Returns, if existing, the first object with the given ID among its various lists.
+ * Returns, if existing, the object with the given ID.
  * @param id object id
  * @return found object or empty
  */
 Eng::Object ENG_API &Eng::Container::find(const uint32_t id) const
 {
-   // Fast lane:
-   if (id == 0)         
-      return Eng::Object::empty;   
-   
-   // Seach in materials:
-   for (auto &c : reserved->allMaterials)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in textures:
-   for (auto &c : reserved->allTextures)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in geometries:
-   for (auto &c : reserved->allMeshes)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in lights:
-   for (auto &c : reserved->allLights)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in nodes:
-   for (auto &c : reserved->allNodes)
-      if (c.getId() == id)
-         return c;
+   auto it = reserved->objectsById.find(id);
+   if (it == reserved->objectsById.end())
+      return Eng::Object::empty;
+   return *it->second;
+}
 
-   // Not found:
-   return Eng::Object::empty;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first node with the given name.
+ * @param name node name
+ * @return found node or empty
+ */
+Eng::Node ENG_API &Eng::Container::findNode(const std::string &name) const
+{
+   Eng::Node *found = Reserved::lookup(reserved->nodesByName, name);
+   return found ? *found : Eng::Node::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first mesh with the given name.
+ * @param name mesh name
+ * @return found mesh or empty
+ */
+Eng::Mesh ENG_API &Eng::Container::findMesh(const std::string &name) const
+{
+   Eng::Mesh *found = Reserved::lookup(reserved->meshesByName, name);
+   return found ? *found : Eng::Mesh::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first light with the given name.
+ * @param name light name
+ * @return found light or empty
+ */
+Eng::Light ENG_API &Eng::Container::findLight(const std::string &name) const
+{
+   Eng::Light *found = Reserved::lookup(reserved->lightsByName, name);
+   return found ? *found : Eng::Light::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first material with the given name.
+ * @param name material name
+ * @return found material or empty
+ */
+Eng::Material ENG_API &Eng::Container::findMaterial(const std::string &name) const
+{
+   Eng::Material *found = Reserved::lookup(reserved->materialsByName, name);
+   return found ? *found : Eng::Material::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first texture with the given name.
+ * @param name texture name
+ * @return found texture or empty
+ */
+Eng::Texture ENG_API &Eng::Container::findTexture(const std::string &name) const
+{
+   Eng::Texture *found = Reserved::lookup(reserved->texturesByName, name);
+   return found ? *found : Eng::Texture::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the handle of a mesh stored in this container.
+ * @param mesh mesh
+ * @return handle, null when the mesh is not stored in this container
+ */
+Eng::Handle<Eng::Mesh> ENG_API Eng::Container::getHandle(const Eng::Mesh &mesh) const
+{
+   return reserved->allMeshes.getHandle(mesh);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the handle of a light stored in this container.
+ * @param light light
+ * @return handle, null when the light is not stored in this container
+ */
+Eng::Handle<Eng::Light> ENG_API Eng::Container::getHandle(const Eng::Light &light) const
+{
+   return reserved->allLights.getHandle(light);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the handle of a material stored in this container.
+ * @param material material
+ * @return handle, null when the material is not stored in this container
+ */
+Eng::Handle<Eng::Material> ENG_API Eng::Container::getHandle(const Eng::Material &material) const
+{
+   return reserved->allMaterials.getHandle(material);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the handle of a texture stored in this container.
+ * @param texture texture
+ * @return handle, null when the texture is not stored in this container
+ */
+Eng::Handle<Eng::Texture> ENG_API Eng::Container::getHandle(const Eng::Texture &texture) const
+{
+   return reserved->allTextures.getHandle(texture);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Resolves a mesh handle.
+ * @param handle mesh handle
+ * @return mesh, or empty when the handle is null or the mesh has been removed
+ */
+Eng::Mesh ENG_API &Eng::Container::resolve(Eng::Handle<Eng::Mesh> handle) const
+{
+   Eng::Mesh *found = reserved->allMeshes.get(handle);
+   return found ? *found : Eng::Mesh::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Resolves a light handle.
+ * @param handle light handle
+ * @return light, or empty when the handle is null or the light has been removed
+ */
+Eng::Light ENG_API &Eng::Container::resolve(Eng::Handle<Eng::Light> handle) const
+{
+   Eng::Light *found = reserved->allLights.get(handle);
+   return found ? *found : Eng::Light::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Resolves a material handle.
+ * @param handle material handle
+ * @return material, or empty when the handle is null or the material has been removed
+ */
+Eng::Material ENG_API &Eng::Container::resolve(Eng::Handle<Eng::Material> handle) const
+{
+   Eng::Material *found = reserved->allMaterials.get(handle);
+   return found ? *found : Eng::Material::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Resolves a texture handle.
+ * @param handle texture handle
+ * @return texture, or empty when the handle is null or the texture has been removed
+ */
+Eng::Texture ENG_API &Eng::Container::resolve(Eng::Handle<Eng::Texture> handle) const
+{
+   Eng::Texture *found = reserved->allTextures.get(handle);
+   return found ? *found : Eng::Texture::empty;
 }
 
 
@@ -333,7 +527,24 @@ bool ENG_API Eng::Container::reset()
    reserved->allMeshes.clear();   
    reserved->allLights.clear();   
    reserved->allMaterials.clear();   
+   Eng::TextureStreamer::getInstance().reset();
+   Eng::TextureAtlas::getInstance().reset();
    reserved->allTextures.clear();   
+
+   // Indices:
+   reserved->nodesByName.clear();
+   reserved->meshesByName.clear();
+   reserved->lightsByName.clear();
+   reserved->materialsByName.clear();
+   reserved->texturesByName.clear();
+   reserved->objectsById.clear();
+
+   // Texture cache:
+   std::lock_guard<std::mutex> lock(reserved->textureMutex);
+   reserved->texturesByPath.clear();
+   reserved->texturesByHash.clear();
+   reserved->cachedTextures.clear();
+   reserved->decodedBitmaps.clear();
    
    // Done:
    setDirty(true);
@@ -343,7 +554,8 @@ bool ENG_API Eng::Container::reset()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Adds the given object to the proper container.
+ * Adds the given object to the proper pool and indexes it by name and ID. Names changed afterwards are not seen
+ * by the finders.
  * @return TF
  */
 bool ENG_API Eng::Container::add(Eng::Object &obj)
@@ -358,35 +570,257 @@ bool ENG_API Eng::Container::add(Eng::Object &obj)
    // Sort by type:
    if (dynamic_cast<Eng::Mesh *>(&obj))
    {
-      reserved->allMeshes.push_back(std::move(dynamic_cast<Eng::Mesh &>(obj)));      
+      reserved->store(reserved->allMeshes, reserved->meshesByName, dynamic_cast<Eng::Mesh &>(obj));      
       return true;
    }
    else      
       if (dynamic_cast<Eng::Light *>(&obj))
       {
-         reserved->allLights.push_back(std::move(dynamic_cast<Eng::Light &>(obj)));      
+         reserved->store(reserved->allLights, reserved->lightsByName, dynamic_cast<Eng::Light &>(obj));      
          return true;
       }
       else      
          if (dynamic_cast<Eng::Node *>(&obj))
          {
-            reserved->allNodes.push_back(std::move(dynamic_cast<Eng::Node &>(obj)));         
+            reserved->store(reserved->allNodes, reserved->nodesByName, dynamic_cast<Eng::Node &>(obj));         
             return true;
          }      
          else
             if (dynamic_cast<Eng::Material *>(&obj))
             {
-               reserved->allMaterials.push_back(std::move(dynamic_cast<Eng::Material &>(obj)));         
+               reserved->store(reserved->allMaterials, reserved->materialsByName, dynamic_cast<Eng::Material &>(obj));         
                return true;
             }      
             else
                if (dynamic_cast<Eng::Texture *>(&obj))
                {
-                  reserved->allTextures.push_back(std::move(dynamic_cast<Eng::Texture &>(obj)));         
+                  reserved->store(reserved->allTextures, reserved->texturesByName, dynamic_cast<Eng::Texture &>(obj));         
                   return true;
                }      
    
    // Done:
    ENG_LOG_ERROR("Unsupported type");   
    return false;
-}
\ No newline at end of file
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Looks for an already loaded texture, first by file path, then by content hash. When found, its reference count
+ * is increased: call releaseTexture() once done with it. Thread-safe.
+ * @param path source file of the texture
+ * @param hash content hash, or 0 to look up by path only
+ * @return cached texture or Texture::empty if not found
+ */
+Eng::Texture ENG_API &Eng::Container::acquireTexture(const std::string &path, uint64_t hash)
+{
+   std::lock_guard<std::mutex> lock(reserved->textureMutex);
+
+   Eng::Texture *tex = nullptr;
+   auto byPath = reserved->texturesByPath.find(path);
+   if (byPath != reserved->texturesByPath.end())
+      tex = byPath->second;
+   else
+      if (hash)
+      {
+         auto byHash = reserved->texturesByHash.find(hash);
+         if (byHash == reserved->texturesByHash.end())
+            return Eng::Texture::empty;
+
+         // Same content under a different name, remember it:
+         tex = byHash->second;
+         if (!path.empty())
+         {
+            reserved->texturesByPath[path] = tex;
+            reserved->cachedTextures[tex].paths.push_back(path);
+         }
+      }
+
+   // Not found:
+   if (tex == nullptr)
+      return Eng::Texture::empty;
+
+   // Done:
+   reserved->cachedTextures[tex].nrOfRefs++;
+   return *tex;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Adds a texture to the container and registers it in the texture cache with one reference. Thread-safe.
+ * @param tex texture (moved into the container)
+ * @param path source file of the texture (can be empty)
+ * @param hash content hash, or 0 if unknown
+ * @return added texture or Texture::empty on error
+ */
+Eng::Texture ENG_API &Eng::Container::addTexture(Eng::Texture &tex, const std::string &path, uint64_t hash)
+{
+   // Safety net:
+   if (tex == Eng::Texture::empty)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return Eng::Texture::empty;
+   }
+
+   std::lock_guard<std::mutex> lock(reserved->textureMutex);
+   Eng::Texture *added = &reserved->store(reserved->allTextures, reserved->texturesByName, tex);
+
+   Reserved::CachedTexture &entry = reserved->cachedTextures[added];
+   entry.nrOfRefs = 1;
+   entry.hash = hash;
+   if (!path.empty())
+   {
+      entry.paths.push_back(path);
+      reserved->texturesByPath[path] = added;
+   }
+   if (hash)
+      reserved->texturesByHash.emplace(hash, added);
+
+   // Done:
+   return *added;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases a reference to a cached texture. The texture is removed from the container when no longer used.
+ * Thread-safe.
+ * @param tex texture returned by acquireTexture() or addTexture()
+ * @return TF (false when the texture is not in the cache)
+ */
+bool ENG_API Eng::Container::releaseTexture(const Eng::Texture &tex)
+{
+   std::lock_guard<std::mutex> lock(reserved->textureMutex);
+   auto it = reserved->cachedTextures.find(&tex);
+   if (it == reserved->cachedTextures.end())
+      return false;
+
+   if (--it->second.nrOfRefs)
+      return true;
+
+   // Last user, unregister and free:
+   for (auto &path : it->second.paths)
+      reserved->texturesByPath.erase(path);
+   if (it->second.hash)
+   {
+      auto byHash = reserved->texturesByHash.find(it->second.hash);
+      if (byHash != reserved->texturesByHash.end() && byHash->second == &tex)
+         reserved->texturesByHash.erase(byHash);
+   }
+   reserved->cachedTextures.erase(it);
+   Eng::TextureStreamer::getInstance().remove(tex);
+   reserved->unindex(reserved->texturesByName, tex);
+   reserved->allTextures.remove(tex);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of references to a cached texture.
+ * @param tex texture
+ * @return number of references (0 when not in the cache)
+ */
+uint32_t ENG_API Eng::Container::getNrOfTextureRefs(const Eng::Texture &tex) const
+{
+   std::lock_guard<std::mutex> lock(reserved->textureMutex);
+   auto it = reserved->cachedTextures.find(&tex);
+   if (it == reserved->cachedTextures.end())
+      return 0;
+   return it->second.nrOfRefs;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Enables/disables the content hashing of new textures, used to share textures stored in different files.
+ * @param enabled hashing flag
+ */
+void ENG_API Eng::Container::setTextureHashing(bool enabled)
+{
+   reserved->textureHashing = enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the status of the content hashing of new textures.
+ * @return hashing flag
+ */
+bool ENG_API Eng::Container::getTextureHashing() const
+{
+   return reserved->textureHashing;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Enables/disables the packing of the roughness and metalness images of new materials into a single texture
+ * (see Material::isOrmPacked()).
+ * @param enabled packing flag
+ */
+void ENG_API Eng::Container::setTexturePacking(bool enabled)
+{
+   reserved->texturePacking = enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the status of the packing of the roughness and metalness images of new materials.
+ * @return packing flag
+ */
+bool ENG_API Eng::Container::getTexturePacking() const
+{
+   return reserved->texturePacking;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Decodes an image file once, however many threads ask for it: the first caller runs the decoder and gets the image
+ * right away, the others get the pending result of that call, without waiting (e.g., to resolve it once a parallel
+ * load is done, as nested jobs of the decoder may be queued behind them). The image is kept until releaseBitmap()
+ * (i.e., once its texture is in the cache) or reset(), a failed decode is forgotten right away. Thread-safe.
+ * @param path source file of the image
+ * @param decoder function decoding the image, returning nullptr on error
+ * @return decoded image (nullptr on error), possibly still pending
+ */
+std::shared_future<std::shared_ptr<const Eng::Bitmap>> ENG_API Eng::Container::decodeBitmap(const std::string &path, const std::function<std::shared_ptr<const Eng::Bitmap>()> &decoder)
+{
+   // Claim the file, or share the result of the thread that did:
+   std::promise<std::shared_ptr<const Eng::Bitmap>> promise;
+   std::shared_future<std::shared_ptr<const Eng::Bitmap>> result;
+   {
+      std::lock_guard<std::mutex> lock(reserved->textureMutex);
+      auto it = reserved->decodedBitmaps.find(path);
+      if (it != reserved->decodedBitmaps.end())
+         return it->second;
+      result = promise.get_future().share();
+      reserved->decodedBitmaps.emplace(path, result);
+   }
+
+   // Decode:
+   std::shared_ptr<const Eng::Bitmap> bitmap = decoder();
+   promise.set_value(bitmap);
+   if (bitmap == nullptr)
+      releaseBitmap(path);
+
+   // Done:
+   return result;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Forgets an image decoded by decodeBitmap(). Callers still holding it are not affected. Thread-safe.
+ * @param path source file of the image
+ */
+void ENG_API Eng::Container::releaseBitmap(const std::string &path)
+{
+   std::lock_guard<std::mutex> lock(reserved->textureMutex);
+   reserved->decodedBitmaps.erase(path);
+}
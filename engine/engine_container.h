@@ -9,7 +9,9 @@
 
 
 /**
- * @brief Class for storing data used during the life-cycle of the engine. 
+ * @brief Class for storing data used during the life-cycle of the engine. Objects are kept in one Pool per type
+ *        (stable addresses) and indexed by name and ID when added. Objects can be referenced through generational
+ *        handles, which resolve to the empty object once the referenced one is gone.
  */
 class ENG_API Container final : public Eng::Object
 {
@@ -38,15 +40,42 @@ public: //
    Eng::Light &getLastLight() const;   
    Eng::Material &getLastMaterial() const;   
    Eng::Texture &getLastTexture() const;   
-   std::list<Eng::Node> &getNodeList();
-   std::list<Eng::Mesh> &getMeshList();
-   std::list<Eng::Light> &getLightList();
-   std::list<Eng::Material> &getMaterialList();
-   std::list<Eng::Texture> &getTextureList();
+   Eng::Pool<Eng::Node> &getNodePool();
+   Eng::Pool<Eng::Mesh> &getMeshPool();
+   Eng::Pool<Eng::Light> &getLightPool();
+   Eng::Pool<Eng::Material> &getMaterialPool();
+   Eng::Pool<Eng::Texture> &getTexturePool();
    
    // Finders:
    Eng::Object &find(const std::string &name) const;   ///< By name
    Eng::Object &find(uint32_t id) const;               ///< By ID
+   Eng::Node &findNode(const std::string &name) const;
+   Eng::Mesh &findMesh(const std::string &name) const;
+   Eng::Light &findLight(const std::string &name) const;
+   Eng::Material &findMaterial(const std::string &name) const;
+   Eng::Texture &findTexture(const std::string &name) const;
+
+   // Handles:
+   Eng::Handle<Eng::Mesh> getHandle(const Eng::Mesh &mesh) const;
+   Eng::Handle<Eng::Light> getHandle(const Eng::Light &light) const;
+   Eng::Handle<Eng::Material> getHandle(const Eng::Material &material) const;
+   Eng::Handle<Eng::Texture> getHandle(const Eng::Texture &texture) const;
+   Eng::Mesh &resolve(Eng::Handle<Eng::Mesh> handle) const;
+   Eng::Light &resolve(Eng::Handle<Eng::Light> handle) const;
+   Eng::Material &resolve(Eng::Handle<Eng::Material> handle) const;
+   Eng::Texture &resolve(Eng::Handle<Eng::Texture> handle) const;
+
+   // Texture cache:
+   Eng::Texture &acquireTexture(const std::string &path, uint64_t hash = 0);
+   Eng::Texture &addTexture(Eng::Texture &tex, const std::string &path, uint64_t hash = 0);
+   bool releaseTexture(const Eng::Texture &tex);
+   uint32_t getNrOfTextureRefs(const Eng::Texture &tex) const;
+   void setTextureHashing(bool enabled);
+   bool getTextureHashing() const;
+   void setTexturePacking(bool enabled);
+   bool getTexturePacking() const;
+   std::shared_future<std::shared_ptr<const Eng::Bitmap>> decodeBitmap(const std::string &path, const std::function<std::shared_ptr<const Eng::Bitmap>()> &decoder);
+   void releaseBitmap(const std::string &path);
 
 
 ///////////
@@ -0,0 +1,727 @@
+/**
+ * @file		engine_cooked.cpp
+ * @brief	Cooked (preprocessed, GPU-ready) scene cache
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <atomic>
+   #include <filesystem>
+   #include <limits>
+   #include <unordered_map>
+
+
+
+////////////
+// STATIC //
+////////////
+
+/**
+ * Hashes a block of memory (FNV-1a, processed in 64-bit words).
+ * @param data pointer to the data
+ * @param nrOfBytes size of the data
+ * @return hash value
+ */
+static uint64_t hashBlock(const uint8_t *data, uint64_t nrOfBytes)
+{
+   constexpr uint64_t prime = 0x100000001b3ull;
+   uint64_t hash = 0xcbf29ce484222325ull;
+
+   uint64_t c = 0;
+   for (; c + sizeof(uint64_t) <= nrOfBytes; c += sizeof(uint64_t))
+   {
+      uint64_t word;
+      memcpy(&word, data + c, sizeof(uint64_t));
+      hash = (hash ^ word) * prime;
+   }
+   for (; c < nrOfBytes; c++)
+      hash = (hash ^ data[c]) * prime;
+
+   // Done:
+   return hash;
+}
+
+
+
+//////////////////////////
+// BODY OF CLASS Cooked //
+//////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Computes the content hash used to bind a cache to its source. Blocks are hashed in parallel.
+ * @param data pointer to the data
+ * @param nrOfBytes size of the data
+ * @return hash value
+ */
+uint64_t ENG_API Eng::Cooked::computeHash(const void *data, uint64_t nrOfBytes)
+{
+   constexpr uint64_t blockSize = 1024 * 1024;
+   const uint8_t *ptr = static_cast<const uint8_t *>(data);
+   const uint32_t nrOfBlocks = static_cast<uint32_t>((nrOfBytes + blockSize - 1) / blockSize);
+
+   std::vector<uint64_t> block(nrOfBlocks);
+   Eng::ThreadPool::getInstance().parallelFor(nrOfBlocks, [&](uint32_t c)
+      {
+         const uint64_t start = c * blockSize;
+         block[c] = hashBlock(ptr + start, std::min(blockSize, nrOfBytes - start));
+      });
+
+   // Done:
+   return hashBlock(reinterpret_cast<const uint8_t *>(block.data()), block.size() * sizeof(uint64_t)) ^ nrOfBytes;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the modification time of a file, used as a cheap key before hashing its content.
+ * @param filename file name
+ * @return modification time in file clock ticks, or 0 if not available
+ */
+uint64_t ENG_API Eng::Cooked::getModificationTime(const std::string &filename)
+{
+   std::error_code error;
+   const std::filesystem::file_time_type time = std::filesystem::last_write_time(filename, error);
+   if (error)
+      return 0;
+   return static_cast<uint64_t>(time.time_since_epoch().count());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the hash of the settings applied to the meshes when loaded (LOD generation and optimization), which the
+ * cooked geometry depends on.
+ * @return hash value
+ */
+uint64_t ENG_API Eng::Cooked::getSettingsHash()
+{
+   const Eng::Simplifier &simplifier = Eng::Simplifier::getInstance();
+   const Eng::MeshOptimizer &optimizer = Eng::MeshOptimizer::getInstance();
+   const uint32_t nrOfLods = simplifier.getNrOfLods();
+   const bool optimized = optimizer.isEnabled();
+   const float settings[] = { static_cast<float>(nrOfLods),
+                              nrOfLods ? simplifier.getRatio() : 0.0f,
+                              nrOfLods ? simplifier.getMaxError() : 0.0f,
+                              nrOfLods ? simplifier.getAttributeWeight() : 0.0f,
+                              optimized ? static_cast<float>(optimizer.getCacheSize()) : 0.0f,
+                              optimized ? optimizer.getOverdrawThreshold() : 0.0f };
+
+   // Done:
+   return hashBlock(reinterpret_cast<const uint8_t *>(settings), sizeof(settings));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Converts an OVO file into a cooked cache. Geometry is moved into vertex/index arenas, with the LODs generated by
+ * the Simplifier as when loading the OVO file and reordered by the MeshOptimizer as by Ovo::save(), bounds are
+ * precomputed, textures are embedded, and the remaining chunks are stored along with a flattened node table.
+ * @param source OVO file
+ * @param filename cooked file to create
+ * @return TF
+ */
+bool ENG_API Eng::Cooked::cook(const std::string &source, const std::string &filename)
+{
+   // Safety net:
+   if (source.empty() || filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 1: map source and build chunk table
+   Eng::Serializer serial;
+   if (serial.map(source) == false)
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", source.c_str());
+      return false;
+   }
+
+   Eng::Ovo ovo;
+   if (ovo.loadChunk(serial) == 0)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", source.c_str());
+      return false;
+   }
+
+   std::vector<Eng::Ovo::ChunkInfo> table;
+   if (Eng::Ovo::buildChunkTable(serial, table) == false)
+   {
+      ENG_LOG_ERROR("Unable to scan file '%s'", source.c_str());
+      return false;
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 2: split chunks from geometry
+   const uint8_t *base = static_cast<const uint8_t *>(serial.getData());
+   std::vector<Eng::Cooked::NodeRecord> nodes(table.size());
+   std::vector<Eng::Cooked::MeshRecord> meshes;
+   std::vector<std::vector<Eng::Simplifier::Lod>> geometry;   ///< LODs of each mesh (compressed ones decoded)
+   std::vector<uint8_t> chunks;
+   std::vector<std::string> images;
+
+   for (uint32_t c = 0; c < table.size(); c++)
+   {
+      const Eng::Ovo::ChunkInfo &info = table[c];
+      Eng::Cooked::NodeRecord &rec = nodes[c];
+      rec.id = info.id;
+      rec.parent = info.parent;
+      rec.mesh = noMesh;
+      rec.chunkSize = 0;
+      rec.chunkOffset = chunks.size();
+
+      const uint8_t *chunk = base + info.position;
+      const uint32_t chunkSize = 2 * sizeof(uint32_t) + info.size;
+
+      Eng::Serializer reader(serial); // Shares the mapping
+      reader.setPosition(info.position + 2 * sizeof(uint32_t));
+
+      switch (info.id)
+      {
+         case Eng::Ovo::ChunkId::node:
+         case Eng::Ovo::ChunkId::light:
+            chunks.insert(chunks.end(), chunk, chunk + chunkSize);
+            rec.chunkSize = chunkSize;
+            break;
+
+         case Eng::Ovo::ChunkId::material:
+         {
+            chunks.insert(chunks.end(), chunk, chunk + chunkSize);
+            rec.chunkSize = chunkSize;
+
+            // Collect texture files:
+            Eng::Ovo::getMaterialTextures(reader, images);
+         }
+         break;
+
+         case Eng::Ovo::ChunkId::mesh:
+         case Eng::Ovo::ChunkId::meshCompressed:
+         {
+            // Skip to the LOD section:
+            if (Eng::Ovo::skipMeshHeader(reader) == false)
+            {
+               ENG_LOG_ERROR("Corrupted mesh data in file '%s'", source.c_str());
+               return false;
+            }
+            const uint64_t lodSection = reader.getPosition();
+
+            // Keep the header (as a standard mesh) and replace the geometry with an empty LOD list:
+            const uint32_t chunkId = static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh);
+            const uint32_t noLods = 0;
+            const uint32_t headerSize = static_cast<uint32_t>(lodSection - info.position);
+            const uint32_t strippedSize = headerSize + sizeof(uint32_t) - 2 * sizeof(uint32_t);
+            chunks.insert(chunks.end(), chunk, chunk + headerSize);
+            chunks.insert(chunks.end(), reinterpret_cast<const uint8_t *>(&noLods), reinterpret_cast<const uint8_t *>(&noLods) + sizeof(uint32_t));
+            memcpy(chunks.data() + rec.chunkOffset, &chunkId, sizeof(uint32_t));
+            memcpy(chunks.data() + rec.chunkOffset + sizeof(uint32_t), &strippedSize, sizeof(uint32_t));
+            rec.chunkSize = headerSize + sizeof(uint32_t);
+            rec.id = Eng::Ovo::ChunkId::mesh;
+
+            // All the LODs go into the arenas:
+            uint32_t nrOfLods = 0;
+            reader.deserialize(nrOfLods);
+            std::vector<Eng::Simplifier::Lod> lods;
+            for (uint32_t l = 0; l < nrOfLods; l++)
+            {
+               uint32_t nrOfVertices = 0, nrOfFaces = 0;
+               reader.deserialize(nrOfVertices);
+               reader.deserialize(nrOfFaces);
+               Eng::Simplifier::Lod lod;
+               lod.error = 0.0f;
+
+               bool valid;
+               if (info.id == Eng::Ovo::ChunkId::meshCompressed)
+               {
+                  uint32_t vertexBytes = 0, faceBytes = 0;
+                  reader.deserialize(vertexBytes);
+                  reader.deserialize(faceBytes);
+                  const uint8_t *vertexStream = reader.readSpan<uint8_t>(vertexBytes);
+                  const uint8_t *faceStream = reader.readSpan<uint8_t>(faceBytes);
+
+                  // Same sanity check as Mesh::loadLods() before allocating:
+                  valid = !reader.hasOverflow() && nrOfFaces < faceBytes && nrOfVertices / 64 <= vertexBytes / Eng::MeshCodec::vertexStride;
+                  if (valid)
+                  {
+                     lod.vertices.resize(nrOfVertices);
+                     lod.faces.resize(nrOfFaces);
+                     valid = Eng::MeshCodec::decodeVertices(vertexStream, vertexBytes, lod.vertices.data(), nrOfVertices) &&
+                             Eng::MeshCodec::decodeFaces(faceStream, faceBytes, lod.faces.data(), nrOfFaces);
+                  }
+               }
+               else
+               {
+                  const Eng::Vbo::VertexData *v = reader.readSpan<Eng::Vbo::VertexData>(nrOfVertices);
+                  const Eng::Ebo::FaceData *f = reader.readSpan<Eng::Ebo::FaceData>(nrOfFaces);
+                  valid = !reader.hasOverflow();
+                  if (valid)
+                  {
+                     lod.vertices.assign(v, v + nrOfVertices);
+                     lod.faces.assign(f, f + nrOfFaces);
+                  }
+               }
+               if (!valid)
+               {
+                  ENG_LOG_ERROR("Corrupted mesh data in file '%s'", source.c_str());
+                  return false;
+               }
+               lods.push_back(std::move(lod));
+            }
+            if (lods.empty())
+               break;
+
+            rec.mesh = static_cast<uint32_t>(meshes.size());
+            meshes.emplace_back();
+            geometry.push_back(std::move(lods));
+         }
+         break;
+
+         default:
+            ENG_LOG_WARN("Unknown chunk ID (%u) found: ignored", static_cast<uint32_t>(info.id));
+      }
+   }
+
+   // Generate missing LODs, as Mesh::loadLods() (load() rejects caches cooked with other settings):
+   const Eng::Simplifier &simplifier = Eng::Simplifier::getInstance();
+   if (simplifier.getNrOfLods())
+      Eng::ThreadPool::getInstance().parallelFor(static_cast<uint32_t>(meshes.size()), [&](uint32_t c)
+         {
+            std::vector<Eng::Simplifier::Lod> &lods = geometry[c];
+            if (lods.size() != 1 || lods[0].faces.empty())
+               return;
+
+            std::vector<Eng::Simplifier::Lod> generated;
+            simplifier.buildLods(lods[0].vertices.data(), static_cast<uint32_t>(lods[0].vertices.size()),
+                                 lods[0].faces.data(), static_cast<uint32_t>(lods[0].faces.size()), generated);
+            for (auto &lod : generated)
+               lods.push_back(std::move(lod));
+         });
+
+   // Reorder for the vertex cache, overdraw and vertex fetch, as Ovo::save():
+   const Eng::MeshOptimizer &optimizer = Eng::MeshOptimizer::getInstance();
+   if (optimizer.isEnabled())
+   {
+      std::vector<Eng::Simplifier::Lod *> all;
+      for (auto &mesh : geometry)
+         for (auto &lod : mesh)
+            all.push_back(&lod);
+
+      std::atomic<bool> failed{ false };
+      Eng::ThreadPool::getInstance().parallelFor(static_cast<uint32_t>(all.size()), [&](uint32_t c)
+         {
+            if (optimizer.optimize(all[c]->vertices, all[c]->faces) == false)
+               failed = true;
+         });
+      if (failed)
+      {
+         ENG_LOG_ERROR("Unable to optimize the meshes of file '%s'", source.c_str());
+         return false;
+      }
+   }
+
+   // Bounds (finest LOD):
+   Eng::ThreadPool::getInstance().parallelFor(static_cast<uint32_t>(meshes.size()), [&](uint32_t c)
+      {
+         Eng::Cooked::MeshRecord &mesh = meshes[c];
+         const std::vector<Eng::Vbo::VertexData> &vertices = geometry[c][0].vertices;
+         glm::vec3 bboxMin = glm::vec3(std::numeric_limits<float>::max());
+         glm::vec3 bboxMax = glm::vec3(-std::numeric_limits<float>::max());
+         for (const Eng::Vbo::VertexData &v : vertices)
+         {
+            bboxMin = glm::min(bboxMin, v.vertex);
+            bboxMax = glm::max(bboxMax, v.vertex);
+         }
+         mesh.center = (bboxMin + bboxMax) * 0.5f;
+         mesh.radius = 0.0f;
+         for (const Eng::Vbo::VertexData &v : vertices)
+            mesh.radius = std::max(mesh.radius, glm::distance(mesh.center, v.vertex));
+      });
+
+   // LOD table (ranges within the arenas):
+   std::vector<Eng::Cooked::LodRecord> lods;
+   uint64_t nrOfVertexBytes = 0;
+   uint64_t nrOfFaceBytes = 0;
+   for (uint32_t c = 0; c < meshes.size(); c++)
+   {
+      meshes[c].firstLod = static_cast<uint32_t>(lods.size());
+      meshes[c].nrOfLods = static_cast<uint32_t>(geometry[c].size());
+      for (const Eng::Simplifier::Lod &lod : geometry[c])
+      {
+         Eng::Cooked::LodRecord rec;
+         rec.vertexOffset = nrOfVertexBytes;
+         rec.faceOffset = nrOfFaceBytes;
+         rec.nrOfVertices = static_cast<uint32_t>(lod.vertices.size());
+         rec.nrOfFaces = static_cast<uint32_t>(lod.faces.size());
+         rec.error = lod.error;
+         rec._pad = 0;
+         nrOfVertexBytes += lod.vertices.size() * sizeof(Eng::Vbo::VertexData);
+         nrOfFaceBytes += lod.faces.size() * sizeof(Eng::Ebo::FaceData);
+         lods.push_back(rec);
+      }
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 3: write sections
+   FILE *dat = fopen(filename.c_str(), "wb");
+   if (dat == nullptr)
+   {
+      ENG_LOG_ERROR("Unable to create file '%s'", filename.c_str());
+      return false;
+   }
+
+   Eng::Cooked::Header header;
+   memset(&header, 0, sizeof(Eng::Cooked::Header));
+   header.magic = Eng::Cooked::magic;
+   header.version = Eng::Cooked::version;
+   header.sourceHash = computeHash(serial.getData(), serial.getNrOfBytes());
+   header.sourceSize = serial.getNrOfBytes();
+   header.sourceTime = getModificationTime(source);
+   header.settingsHash = getSettingsHash();
+
+   uint64_t position = 0;
+   bool error = false;
+   auto write = [&](const void *data, uint64_t nrOfBytes)
+   {
+      if (nrOfBytes && fwrite(data, sizeof(uint8_t), nrOfBytes, dat) != nrOfBytes)
+         error = true;
+      position += nrOfBytes;
+   };
+   auto align = [&]()
+   {
+      static const uint8_t zero[Eng::Cooked::pageSize] = { 0 };
+      write(zero, (Eng::Cooked::pageSize - position % Eng::Cooked::pageSize) % Eng::Cooked::pageSize);
+   };
+   auto begin = [&](Eng::Cooked::SectionId id)
+   {
+      align();
+      header.section[static_cast<uint32_t>(id)].offset = position;
+   };
+   auto end = [&](Eng::Cooked::SectionId id)
+   {
+      Eng::Cooked::Section &s = header.section[static_cast<uint32_t>(id)];
+      s.size = position - s.offset;
+   };
+
+   write(&header, sizeof(Eng::Cooked::Header)); // Placeholder
+
+   // Images (DDS files, each one page-aligned):
+   std::vector<Eng::Cooked::TextureRecord> textures;
+   std::vector<char> strings;
+   begin(Eng::Cooked::SectionId::images);
+   for (auto &name : images)
+   {
+      Eng::MappedFile image;
+      if (image.open(name) == false)
+      {
+         ENG_LOG_WARN("Texture '%s' not embedded", name.c_str());
+         continue;
+      }
+
+      align();
+      Eng::Cooked::TextureRecord rec;
+      rec.name = strings.size();
+      rec.offset = position;
+      rec.size = image.getNrOfBytes();
+      rec.time = getModificationTime(name);
+      strings.insert(strings.end(), name.c_str(), name.c_str() + name.size() + 1);
+      textures.push_back(rec);
+      write(image.getData(), image.getNrOfBytes());
+   }
+   end(Eng::Cooked::SectionId::images);
+
+   // Geometry arenas:
+   begin(Eng::Cooked::SectionId::vertices);
+   for (auto &mesh : geometry)
+      for (auto &lod : mesh)
+         write(lod.vertices.data(), lod.vertices.size() * sizeof(Eng::Vbo::VertexData));
+   end(Eng::Cooked::SectionId::vertices);
+
+   begin(Eng::Cooked::SectionId::faces);
+   for (auto &mesh : geometry)
+      for (auto &lod : mesh)
+         write(lod.faces.data(), lod.faces.size() * sizeof(Eng::Ebo::FaceData));
+   end(Eng::Cooked::SectionId::faces);
+
+   // Tables:
+   begin(Eng::Cooked::SectionId::chunks);
+   write(chunks.data(), chunks.size());
+   end(Eng::Cooked::SectionId::chunks);
+
+   begin(Eng::Cooked::SectionId::strings);
+   write(strings.data(), strings.size());
+   end(Eng::Cooked::SectionId::strings);
+
+   begin(Eng::Cooked::SectionId::textures);
+   write(textures.data(), textures.size() * sizeof(Eng::Cooked::TextureRecord));
+   end(Eng::Cooked::SectionId::textures);
+
+   begin(Eng::Cooked::SectionId::meshes);
+   write(meshes.data(), meshes.size() * sizeof(Eng::Cooked::MeshRecord));
+   end(Eng::Cooked::SectionId::meshes);
+
+   begin(Eng::Cooked::SectionId::lods);
+   write(lods.data(), lods.size() * sizeof(Eng::Cooked::LodRecord));
+   end(Eng::Cooked::SectionId::lods);
+
+   begin(Eng::Cooked::SectionId::nodes);
+   write(nodes.data(), nodes.size() * sizeof(Eng::Cooked::NodeRecord));
+   end(Eng::Cooked::SectionId::nodes);
+   align();
+
+   // Final header:
+   fseek(dat, 0, SEEK_SET);
+   if (fwrite(&header, sizeof(Eng::Cooked::Header), 1, dat) != 1)
+      error = true;
+   fclose(dat);
+   if (error)
+   {
+      ENG_LOG_ERROR("Unable to write file '%s'", filename.c_str());
+      remove(filename.c_str());
+      return false;
+   }
+
+   // Done:
+   ENG_LOG_PLAIN("Cooked '%s': %zu nodes, %zu meshes, %zu LODs, %zu textures, %llu bytes", source.c_str(), nodes.size(), meshes.size(), lods.size(), textures.size(), (unsigned long long) position);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Loads a cooked cache. Geometry and textures are uploaded straight from the mapped sections.
+ * Call from the thread owning the OpenGL context.
+ * @param filename cooked file
+ * @param source OVO file the cache was cooked from: when given, a cache not matching its content (or the one of its
+ *        embedded textures) is rejected
+ * @return root node or Node::empty if error (e.g., stale or missing cache)
+ */
+Eng::Node ENG_API &Eng::Cooked::load(const std::string &filename, const std::string &source)
+{
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return Eng::Node::empty;
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 1: map file and validate it
+   Eng::Serializer serial;
+   if (serial.map(filename) == false)
+   {
+      ENG_LOG_WARN("Cache '%s' not available", filename.c_str());
+      return Eng::Node::empty;
+   }
+
+   const uint8_t *base = static_cast<const uint8_t *>(serial.getData());
+   const Eng::Cooked::Header *header = reinterpret_cast<const Eng::Cooked::Header *>(base);
+   if (serial.getNrOfBytes() < sizeof(Eng::Cooked::Header) || header->magic != Eng::Cooked::magic || header->version != Eng::Cooked::version)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
+      return Eng::Node::empty;
+   }
+   for (uint32_t c = 0; c < static_cast<uint32_t>(Eng::Cooked::SectionId::last); c++)
+      if (header->section[c].offset + header->section[c].size > serial.getNrOfBytes())
+      {
+         ENG_LOG_ERROR("File '%s' is truncated", filename.c_str());
+         return Eng::Node::empty;
+      }
+
+   if (header->settingsHash != getSettingsHash())
+   {
+      ENG_LOG_WARN("Cache '%s' was cooked with other mesh settings", filename.c_str());
+      return Eng::Node::empty;
+   }
+   if (!source.empty())
+   {
+      // Size and modification time first, content only when touched:
+      std::error_code error;
+      const uint64_t sourceSize = std::filesystem::file_size(source, error);
+      bool stale = error || sourceSize != header->sourceSize;
+      if (!stale && (header->sourceTime == 0 || getModificationTime(source) != header->sourceTime))
+      {
+         Eng::MappedFile file;
+         stale = file.open(source) == false ||
+                 file.getNrOfBytes() != header->sourceSize ||
+                 computeHash(file.getData(), file.getNrOfBytes()) != header->sourceHash;
+      }
+      if (stale)
+      {
+         ENG_LOG_WARN("Cache '%s' is stale", filename.c_str());
+         return Eng::Node::empty;
+      }
+   }
+
+   auto getSection = [&](Eng::Cooked::SectionId id) -> const Eng::Cooked::Section &
+   {
+      return header->section[static_cast<uint32_t>(id)];
+   };
+   const Eng::Cooked::NodeRecord *nodes = reinterpret_cast<const Eng::Cooked::NodeRecord *>(base + getSection(Eng::Cooked::SectionId::nodes).offset);
+   const uint32_t nrOfNodes = static_cast<uint32_t>(getSection(Eng::Cooked::SectionId::nodes).size / sizeof(Eng::Cooked::NodeRecord));
+   const Eng::Cooked::MeshRecord *meshes = reinterpret_cast<const Eng::Cooked::MeshRecord *>(base + getSection(Eng::Cooked::SectionId::meshes).offset);
+   const uint32_t nrOfMeshes = static_cast<uint32_t>(getSection(Eng::Cooked::SectionId::meshes).size / sizeof(Eng::Cooked::MeshRecord));
+   const Eng::Cooked::LodRecord *lods = reinterpret_cast<const Eng::Cooked::LodRecord *>(base + getSection(Eng::Cooked::SectionId::lods).offset);
+   const uint32_t nrOfLods = static_cast<uint32_t>(getSection(Eng::Cooked::SectionId::lods).size / sizeof(Eng::Cooked::LodRecord));
+   const uint8_t *vertices = base + getSection(Eng::Cooked::SectionId::vertices).offset;
+   const uint8_t *faces = base + getSection(Eng::Cooked::SectionId::faces).offset;
+
+   // Embedded textures:
+   std::unordered_map<std::string, const Eng::Cooked::TextureRecord *> textures;
+   const Eng::Cooked::TextureRecord *texture = reinterpret_cast<const Eng::Cooked::TextureRecord *>(base + getSection(Eng::Cooked::SectionId::textures).offset);
+   const char *strings = reinterpret_cast<const char *>(base + getSection(Eng::Cooked::SectionId::strings).offset);
+   const uint64_t nrOfStringBytes = getSection(Eng::Cooked::SectionId::strings).size;
+   for (uint64_t c = 0; c < getSection(Eng::Cooked::SectionId::textures).size / sizeof(Eng::Cooked::TextureRecord); c++)
+   {
+      // Zero-terminated name and data within the file:
+      const Eng::Cooked::TextureRecord &rec = texture[c];
+      if (rec.name >= nrOfStringBytes || memchr(strings + rec.name, 0, nrOfStringBytes - rec.name) == nullptr ||
+          rec.size == 0 || rec.offset > serial.getNrOfBytes() || rec.size > serial.getNrOfBytes() - rec.offset)
+      {
+         ENG_LOG_ERROR("Corrupted texture table in file '%s'", filename.c_str());
+         return Eng::Node::empty;
+      }
+
+      // DDS file edited since cooked (a missing one keeps the embedded copy):
+      if (!source.empty())
+      {
+         std::error_code error;
+         const uint64_t size = std::filesystem::file_size(strings + rec.name, error);
+         if (!error && (size != rec.size || getModificationTime(strings + rec.name) != rec.time))
+         {
+            ENG_LOG_WARN("Cache '%s' is stale (texture '%s' changed)", filename.c_str(), strings + rec.name);
+            return Eng::Node::empty;
+         }
+      }
+      textures[strings + rec.name] = &rec;
+   }
+
+   Eng::Ovo::LoadInfo info;
+   info.deferUpload = true;
+   info.lazy = false;
+   info.keepBitmaps = false;
+   info.loadBitmap = [&](const std::string &name, Eng::Bitmap &bitmap)
+   {
+      auto it = textures.find(name);
+      if (it == textures.end())
+         return bitmap.load(name);
+
+      // Zero-copy view on the cooked file:
+      std::shared_ptr<Eng::MappedFile> view = std::make_shared<Eng::MappedFile>();
+      if (view->open(serial.getMappedFile(), it->second->offset, it->second->size, name) == false)
+      {
+         ENG_LOG_ERROR("Unable to map texture '%s' from file '%s'", name.c_str(), filename.c_str());
+         return false;
+      }
+      return bitmap.load(view);
+   };
+
+
+   /////////////////////////////////////////
+   // STEP 2: rebuild objects and hierarchy
+   Eng::Container &container = Eng::Container::getInstance();
+   std::vector<std::reference_wrapper<Eng::Node>> node(nrOfNodes, Eng::Node::empty);
+   std::reference_wrapper<Eng::Node> root(Eng::Node::empty);
+   for (uint32_t c = 0; c < nrOfNodes; c++)
+   {
+      const Eng::Cooked::NodeRecord &rec = nodes[c];
+      if (rec.chunkSize == 0)
+      {
+         if (rec.parent < 0)
+            root = Eng::Node::empty;
+         continue;
+      }
+
+      Eng::Serializer chunk(serial); // Shares the mapping
+      chunk.setPosition(getSection(Eng::Cooked::SectionId::chunks).offset + rec.chunkOffset);
+
+      switch (rec.id)
+      {
+         case Eng::Ovo::ChunkId::material:
+         {
+            Eng::Material mat;
+            mat.loadChunk(chunk, &info);
+            mat.upload();
+            container.add(mat);
+         }
+         break;
+
+         case Eng::Ovo::ChunkId::node:
+         {
+            Eng::Node n;
+            n.loadChunk(chunk, &info);
+            container.add(n);
+            node[c] = container.getLastNode();
+         }
+         break;
+
+         case Eng::Ovo::ChunkId::mesh:
+         {
+            Eng::Mesh mesh;
+            mesh.loadChunk(chunk, &info);
+            if (rec.mesh < nrOfMeshes)
+            {
+               // Precomputed bounds, then all the LODs, finest first:
+               const Eng::Cooked::MeshRecord &m = meshes[rec.mesh];
+               mesh.setBounds(m.center, m.radius);
+               for (uint32_t l = m.firstLod; l < m.firstLod + m.nrOfLods && l < nrOfLods; l++)
+               {
+                  const Eng::Cooked::LodRecord &lod = lods[l];
+                  if (lod.vertexOffset + lod.nrOfVertices * sizeof(Eng::Vbo::VertexData) > getSection(Eng::Cooked::SectionId::vertices).size ||
+                      lod.faceOffset + lod.nrOfFaces * sizeof(Eng::Ebo::FaceData) > getSection(Eng::Cooked::SectionId::faces).size)
+                  {
+                     ENG_LOG_ERROR("Corrupted mesh data in file '%s'", filename.c_str());
+                     break;
+                  }
+                  mesh.stage(lod.nrOfVertices, vertices + lod.vertexOffset, lod.nrOfFaces, faces + lod.faceOffset, serial.getMappedFile(), lod.error);
+               }
+               mesh.upload();
+
+               // Same LOD chain as when loading the OVO file:
+               if (mesh.getNrOfLods() != m.nrOfLods)
+                  ENG_LOG_WARN("Mesh '%s': %u LODs uploaded, %u cooked", mesh.getName().c_str(), mesh.getNrOfLods(), m.nrOfLods);
+            }
+            container.add(mesh);
+            node[c] = container.getLastMesh();
+         }
+         break;
+
+         case Eng::Ovo::ChunkId::light:
+         {
+            Eng::Light light;
+            light.loadChunk(chunk, &info);
+            container.add(light);
+            node[c] = container.getLastLight();
+         }
+         break;
+
+         default:
+            break;
+      }
+
+      // Same hierarchy and root as Ovo::load():
+      if (rec.parent >= 0 && rec.parent < static_cast<int32_t>(c) && node[c].get() != Eng::Node::empty)
+         node[rec.parent].get().addChild(node[c]);
+      if (rec.parent < 0)
+         root = node[c];
+   }
+
+   // Done:
+   ENG_LOG_DEBUG("Cache '%s': %u nodes, %u meshes, %zu textures", filename.c_str(), nrOfNodes, nrOfMeshes, textures.size());
+   return root;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file		engine_cooked.h
+ * @brief	Cooked (preprocessed, GPU-ready) scene cache
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Cooked scene manager. An OVO file is converted offline (cook) into a binary cache made of page-aligned
+ *        sections that are memory-mapped and uploaded as they are at runtime (load). The cache is bound to the
+ *        size, modification time and content hash of its source file, so stale caches are rejected. The content is
+ *        only hashed when the modification time differs. Embedded textures are bound to the size and modification
+ *        time of their DDS file (when still available). Meshes are cooked with their full LOD chain (generated
+ *        LODs included) already reordered by the MeshOptimizer, so a cache is also rejected when cooked with other
+ *        LOD generation or optimization settings.
+ */
+class ENG_API Cooked
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief Section IDs.
+    */
+   enum class SectionId : uint32_t
+   {
+      nodes,         ///< Flattened node table (NodeRecord)
+      meshes,        ///< Mesh LOD ranges and bounds (MeshRecord)
+      lods,          ///< Geometry ranges of the levels of detail (LodRecord)
+      textures,      ///< Texture table (TextureRecord)
+      strings,       ///< Zero-terminated strings
+      chunks,        ///< OVO chunks without geometry
+      vertices,      ///< Vertex arena (Vbo::VertexData)
+      faces,         ///< Index arena (Ebo::FaceData)
+      images,        ///< DDS files, each one page-aligned
+
+      // Terminator:
+      last
+   };
+
+
+   /**
+    * @brief Section descriptor.
+    */
+   struct Section
+   {
+      uint64_t offset;                          ///< Offset from the beginning of the file (page-aligned)
+      uint64_t size;                            ///< Size in bytes
+   };
+
+
+   /**
+    * @brief File header.
+    */
+   struct Header
+   {
+      uint32_t magic;                           ///< Magic number
+      uint32_t version;                         ///< Format revision
+      uint64_t sourceHash;                      ///< Content hash of the source OVO file
+      uint64_t sourceSize;                      ///< Size of the source OVO file
+      uint64_t sourceTime;                      ///< Modification time of the source OVO file (file clock ticks)
+      uint64_t settingsHash;                    ///< Mesh processing settings the cache was cooked with
+      Section section[static_cast<uint32_t>(SectionId::last)];
+   };
+
+
+   /**
+    * @brief Node table entry. Entries are stored in the same order as the OVO chunks (scene-graph pre-order).
+    */
+   struct NodeRecord
+   {
+      Eng::Ovo::ChunkId id;                     ///< Chunk type
+      int32_t parent;                           ///< Parent entry, or -1 if top-level
+      uint32_t mesh;                            ///< Entry in the mesh table, or noMesh
+      uint32_t chunkSize;                       ///< Size of the chunk (header included), 0 if ignored
+      uint64_t chunkOffset;                     ///< Offset of the chunk in the chunk section
+   };
+
+
+   /**
+    * @brief Mesh table entry.
+    */
+   struct MeshRecord
+   {
+      uint32_t firstLod;                        ///< First entry in the LOD table
+      uint32_t nrOfLods;                        ///< Number of LODs (finest first)
+      glm::vec3 center;                         ///< Bounding sphere center (center of the bounding box)
+      float radius;                             ///< Bounding sphere radius (tight around the finest LOD)
+   };
+
+
+   /**
+    * @brief LOD table entry.
+    */
+   struct LodRecord
+   {
+      uint64_t vertexOffset;                    ///< Offset of the first vertex in the vertex section
+      uint64_t faceOffset;                      ///< Offset of the first face in the face section
+      uint32_t nrOfVertices;                    ///< Number of vertices
+      uint32_t nrOfFaces;                       ///< Number of faces (indices relative to the first vertex)
+      float error;                              ///< Error w.r.t. the finest LOD (mesh units, 0 when authored)
+      uint32_t _pad;                            ///< Padding
+   };
+
+
+   /**
+    * @brief Texture table entry.
+    */
+   struct TextureRecord
+   {
+      uint64_t name;                            ///< Offset of the file name in the string section
+      uint64_t offset;                          ///< Offset of the DDS data from the beginning of the file
+      uint64_t size;                            ///< Size of the DDS data
+      uint64_t time;                            ///< Modification time of the DDS file (file clock ticks)
+   };
+
+
+   // Consts:
+   static constexpr uint32_t magic = 0x444B4345;   ///< 'ECKD'
+   static constexpr uint32_t version = 6;          ///< Format revision
+   static constexpr uint32_t pageSize = 4096;      ///< Section alignment
+   static constexpr uint32_t noMesh = 0xFFFFFFFF;  ///< Node without geometry
+
+   // Cooking:
+   bool cook(const std::string &source, const std::string &filename);
+   static uint64_t computeHash(const void *data, uint64_t nrOfBytes);
+   static uint64_t getModificationTime(const std::string &filename);
+   static uint64_t getSettingsHash();
+
+   // Loading:
+   Eng::Node &load(const std::string &filename, const std::string &source = "");
+};
@@ -36,16 +36,17 @@
 /**
  * @brief EBO reserved structure.
  */
-struct Eng::Ebo::Reserved
+struct Eng::Ebo::Reserved : public Eng::Pooled<Eng::Ebo::Reserved>
 {  
    GLuint oglId;        ///< OpenGL shader ID
    uint32_t nrOfFaces;  ///< Nr. of faces
+   uint32_t indexSize;  ///< Bytes per index (2 or 4)
 
 
    /**
     * Constructor.
     */
-   Reserved() : oglId{ 0 }, nrOfFaces{ 0 }
+   Reserved() : oglId{ 0 }, nrOfFaces{ 0 }, indexSize{ sizeof(uint32_t) }
    {}
 };
 
@@ -120,6 +121,28 @@ uint32_t ENG_API Eng::Ebo::getNrOfFaces() const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the size of the indices stored in this EBO.
+ * @return bytes per index (2 or 4)
+ */
+uint32_t ENG_API Eng::Ebo::getIndexSize() const
+{
+   return reserved->indexSize;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the OpenGL type of the indices stored in this EBO, as required by glDrawElements*().
+ * @return GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+ */
+uint32_t ENG_API Eng::Ebo::getOglIndexType() const
+{
+   return (reserved->indexSize == sizeof(uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Initializes an OpenGL EBO.
@@ -174,14 +197,22 @@ bool ENG_API Eng::Ebo::free()
  * Create element buffer by allocating the required storage.
  * @param nfOfFaces number of faces to store
  * @param data pointer to the data to copy into the buffer
+ * @param indexSize bytes per index: sizeof(uint32_t) (FaceData) or sizeof(uint16_t) (meshes up to 65536 vertices)
  * @return TF
  */
-bool ENG_API Eng::Ebo::create(uint32_t nrOfFaces, const void *data)
+bool ENG_API Eng::Ebo::create(uint32_t nrOfFaces, const void *data, uint32_t indexSize)
 {	
+   // Safety net:
+   if (indexSize != sizeof(uint32_t) && indexSize != sizeof(uint16_t))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
    // Init buffer:
    if (!this->isInitialized())
       this->init();
-   uint64_t size = nrOfFaces * sizeof(FaceData); 
+   uint64_t size = static_cast<uint64_t>(nrOfFaces) * 3 * indexSize; 
 
 	// Create it:		              
    const GLuint oglId = this->getOglHandle();
@@ -190,6 +221,7 @@ bool ENG_API Eng::Ebo::create(uint32_t nrOfFaces, const void *data)
 
    // Done:
    reserved->nrOfFaces = nrOfFaces;
+   reserved->indexSize = indexSize;
    return true;
 }
 
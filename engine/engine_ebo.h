@@ -45,10 +45,12 @@ public: //
    
    // Get/set:   
    uint32_t getNrOfFaces() const;
+   uint32_t getIndexSize() const;
+   uint32_t getOglIndexType() const;
    uint32_t getOglHandle() const;
 
    // Data:
-   bool create(uint32_t nrOfFaces, const void *data = nullptr);
+   bool create(uint32_t nrOfFaces, const void *data = nullptr, uint32_t indexSize = sizeof(uint32_t));
 
    // Rendering methods:   
    bool render(uint32_t value = 0, void *data = nullptr) const;
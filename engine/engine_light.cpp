@@ -32,7 +32,7 @@
 /**
  * @brief Light reserved structure.
  */
-struct Eng::Light::Reserved
+struct Eng::Light::Reserved : public Eng::Pooled<Eng::Light::Reserved>
 {  
    glm::vec3 color;              ///< Light color
    glm::vec3 ambient;            ///< Ambient color
@@ -14,6 +14,10 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <algorithm>
+   #include <cmath>
+
 
 
 ////////////
@@ -163,9 +167,55 @@ bool ENG_API Eng::List::process(const Eng::Node &node, const glm::mat4 &prevMatr
       return false;
    }
    
+   const glm::mat4 matrix = prevMatrix * node.getMatrix();
+   append(node, matrix);
+
+   // Parse hierarchy recursively:
+   for (auto &n : node.getListOfChildren())
+      if (const Eng::Node &child = Eng::Node::resolve(n); child != Eng::Node::empty) // Skip destroyed children
+         if (process(child, matrix) == false)
+            return false;
+
+	// Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Appends the elements of an already flattened scenegraph to this list, using its world matrices (same result as
+ * the recursive version starting at the root of the table, without recomputing the matrices).
+ * @param transforms transform table, updated
+ * @return TF
+ */
+bool ENG_API Eng::List::process(const Eng::TransformTable &transforms)
+{
+   // Safety net:
+   if (transforms.isUpToDate() == false)
+   {
+      ENG_LOG_ERROR("Transform table not updated");
+      return false;
+   }
+
+   for (uint32_t c = 0; c < transforms.getNrOfNodes(); c++)
+      append(transforms.getNode(c), transforms.getWorldMatrix(c));
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Appends a node to this list, when renderable.
+ * @param node node
+ * @param matrix world matrix of the node
+ */
+void ENG_API Eng::List::append(const Eng::Node &node, const glm::mat4 &matrix)
+{
    RenderableElem re;
-   re.matrix = prevMatrix * node.getMatrix();
-   re.reference = node;   
+   re.matrix = matrix;
+   re.reference = node.getHandle();
    
    // Store only renderable elements:
    if (dynamic_cast<const Eng::Light *>(&node)) // Lights first
@@ -174,16 +224,14 @@ bool ENG_API Eng::List::process(const Eng::Node &node, const glm::mat4 &prevMatr
       reserved->nrOfLights++;
    }
    else
-      if (dynamic_cast<const Eng::Mesh *>(&node)) // Only meshes
+      if (const Eng::Mesh *mesh = dynamic_cast<const Eng::Mesh *>(&node)) // Only meshes
+      {
+         // Bounds for the LOD selection (largest scale factor):
+         const float scale = glm::max(glm::length(glm::vec3(re.matrix[0])), glm::max(glm::length(glm::vec3(re.matrix[1])), glm::length(glm::vec3(re.matrix[2]))));
+         re.center = glm::vec3(re.matrix * glm::vec4(mesh->getCenter(), 1.0f));
+         re.radius = mesh->getRadius() * scale;
          reserved->renderableElem.push_back(re);
-
-   // Parse hierarchy recursively:
-   for (auto &n : node.getListOfChildren())
-      if (process(n, re.matrix) == false)
-         return false;
-
-	// Done:
-   return true;
+      }
 }
 
 
@@ -192,9 +240,10 @@ bool ENG_API Eng::List::process(const Eng::Node &node, const glm::mat4 &prevMatr
  * Parse the list and call the render method of each renderable.
  * @param cameraMatrix camera (also view) matrix (must be already inverted) 
  * @param pass type of pass
+ * @param lodParams level of detail selection for this pass, or nullptr to always draw the finest LOD
  * @return number of loaded renderable elements
  */
-bool ENG_API Eng::List::render(const glm::mat4 &cameraMatrix, Eng::List::Pass pass) const
+bool ENG_API Eng::List::render(const glm::mat4 &cameraMatrix, Eng::List::Pass pass, const LodParams *lodParams) const
 {	
    // Define range:
    size_t startRange = 0;
@@ -220,14 +269,48 @@ bool ENG_API Eng::List::render(const glm::mat4 &cameraMatrix, Eng::List::Pass pa
    // Iterate through the range:
    RenderableElemInfo info;
    info.camMatrix = cameraMatrix;
+   info.lod = 0;
 
    for (size_t c = startRange; c < endRange; c++)
    {      
       RenderableElem &re = reserved->renderableElem.at(c);
       info.objMatrix = re.matrix;
-      re.reference.get().render(0, &info);
+      if (lodParams)
+         info.lod = selectLod(cameraMatrix, re, *lodParams);
+      Eng::Node::resolve(re.reference).render(0, &info);
    }
 
    // Done:
    return true;
 }
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Selects the level of detail of an element for a pass. The finest LOD is used while the bounding sphere covers
+ * at least lodSize pixels, then each halving of the projected size moves to the next LOD. Works with both
+ * perspective and orthographic projections (e.g., shadow maps of directional lights). Meshes clamp the result to
+ * their coarsest LOD.
+ * @param viewMatrix camera (also view) matrix of the pass (already inverted)
+ * @param re renderable element
+ * @param lodParams level of detail selection
+ * @return level of detail
+ */
+uint32_t ENG_API Eng::List::selectLod(const glm::mat4 &viewMatrix, const RenderableElem &re, const LodParams &lodParams)
+{
+   // Clip-space w of the center (view depth with perspective, 1 with orthographic projections):
+   const float z = (viewMatrix * glm::vec4(re.center, 1.0f)).z;
+   const float w = lodParams.projMatrix[2][3] * z + lodParams.projMatrix[3][3];
+   const bool perspective = lodParams.projMatrix[3][3] == 0.0f;
+   if (re.radius <= 0.0f || w <= 0.0f || (perspective && w <= re.radius))
+      return 0;
+
+   // Projected diameter in pixels:
+   const float size = re.radius * lodParams.projMatrix[1][1] * lodParams.viewportHeight / w;
+   const float level = std::log2(lodSize / size) + lodParams.bias;
+   if (level <= 0.0f)
+      return 0;
+
+   // Done:
+   return static_cast<uint32_t>(std::min(level, 15.0f));
+}
@@ -43,14 +43,16 @@ public: //
     */
    struct RenderableElem
    {            
-      std::reference_wrapper<const Eng::Object> reference;  ///< Reference to the original object
+      Eng::Handle<Eng::Node> reference;                     ///< Handle of the original node (see Node::resolve())
       glm::mat4 matrix;                                     ///< Final position in world coordinates     
+      glm::vec3 center;                                     ///< Bounding sphere center in world coordinates (meshes only)
+      float radius;                                         ///< Bounding sphere radius in world coordinates (meshes only)
 
 
       /**
        * Constructor. 
        */
-      RenderableElem() : reference{ Eng::Object::empty }, matrix{ 1.0f }
+      RenderableElem() : matrix{ 1.0f }, center{ 0.0f }, radius{ 0.0f }
       {}
    };
 
@@ -62,9 +64,25 @@ public: //
    {
       glm::mat4 objMatrix;                                     ///< object Matrix
       glm::mat4 camMatrix;                                     ///< camera Matrix
+      uint32_t lod;                                            ///< Level of detail to draw (0 = finest)
    };
 
 
+   /**
+    * @brief Level of detail selection for a pass: the LOD is chosen from the projected size of the bounding sphere.
+    */
+   struct LodParams
+   {
+      glm::mat4 projMatrix;                                    ///< Projection matrix of the pass
+      float viewportHeight;                                    ///< Height of the render target (pixels)
+      float bias;                                              ///< Added to the selected level (> 0 means coarser)
+   };
+
+
+   // Consts:
+   static constexpr float lodSize = 256.0f;                    ///< Projected diameter (pixels) below which LOD 1 is used, halved for each following LOD
+
+
    // Const/dest:
 	List();      
 	List(List &&other);
@@ -78,11 +96,13 @@ public: //
    // Scene graph traversal:
    void reset();
    bool process(const Eng::Node &node, const glm::mat4 &prevMatrix = glm::mat4(1.0f));
+   bool process(const Eng::TransformTable &transforms);
    uint32_t getNrOfRenderableElems() const;
    uint32_t getNrOfLights() const;
 
    // Rendering:   
-   bool render(const glm::mat4 &cameraMatrix, Pass pass = Pass::all) const;
+   bool render(const glm::mat4 &cameraMatrix, Pass pass = Pass::all, const LodParams *lodParams = nullptr) const;
+   static uint32_t selectLod(const glm::mat4 &viewMatrix, const RenderableElem &re, const LodParams &lodParams);
 
 
 /////////////
@@ -96,6 +116,9 @@ protected: //
    // Const/dest:
    List(const std::string &name);
 
+   // Scene graph traversal:
+   void append(const Eng::Node &node, const glm::mat4 &matrix);
+
    // Workaround for disabling the unneeded rendering method:
    using Object::render;
 };
@@ -33,7 +33,6 @@
 struct Eng::Log::StaticReserved
 {
    std::ofstream outputFile;              ///< Textual output file
-   std::recursive_mutex mutex;            ///< Mutex to enable concurrent writing   
    CustomCallbackProto customCallback;    ///< Optional callback invoked after each message
 
 
@@ -53,6 +52,18 @@ struct Eng::Log::StaticReserved
    Eng::Log::StaticReserved *Eng::Log::staticReserved = nullptr; // No unique_ptr, as the pointer might go out of scope *before* the atexit invocation!
 
 
+/**
+ * Gets the mutex serializing the messages (and the lazy initialization). Created before the atexit hook registered by
+ * init(), hence destroyed after it. Recursive, as logging may log.
+ * @return mutex
+ */
+static std::recursive_mutex &getMutex()
+{
+   static std::recursive_mutex mutex;
+   return mutex;
+}
+
+
 
 ///////////////////////
 // BODY OF CLASS Log //
@@ -102,6 +113,8 @@ bool ENG_API Eng::Log::init()
  */
 bool ENG_API Eng::Log::free()
 {
+   std::lock_guard<std::recursive_mutex> lock(getMutex());
+
    // Safety net:
    if (staticReserved == nullptr)
       return false;
@@ -125,10 +138,12 @@ bool ENG_API Eng::Log::free()
  * @param fileName name of the file invoking the log
  * @param functionName name of the function invoking the log
  * @param text message, with custom series of params
- * @warning race conditions when run concurrently
  */
 bool ENG_API Eng::Log::log(level lvl, const char *fileName, const char *functionName, int32_t codeLine, const char *text, ...)
 {
+   // Messages from worker threads:
+   std::lock_guard<std::recursive_mutex> lock(getMutex());
+
    // Init at first usage:  
    if (staticReserved == nullptr)
       if (Log::init())
@@ -209,6 +224,8 @@ bool ENG_API Eng::Log::log(level lvl, const char *fileName, const char *function
  */
 void ENG_API Eng::Log::setCustomCallback(CustomCallbackProto cb)
 {
+   std::lock_guard<std::recursive_mutex> lock(getMutex());
+
    // Init at first usage:  
    if (staticReserved == nullptr)
       if (Log::init())
@@ -14,6 +14,9 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <map>
+
    // OGL:      
    #include <GL/glew.h>
    #include <GLFW/glfw3.h>
@@ -24,8 +27,47 @@
 // STATIC //
 ////////////
 
-   // Keep track of created instances:
-   std::list<std::reference_wrapper<Eng::Managed>> allManaged;
+/**
+ * @brief Node of the (circular, doubly linked) list of initialized instances, embedded in their reserved structure.
+ *        The reserved structure does not move with the instance, so moving an instance only updates the owner.
+ */
+struct ManagedLink
+{
+   Eng::Managed *owner;                         ///< Instance (nullptr for the list head)
+   ManagedLink *prev;                           ///< Previous node (nullptr when not in the list)
+   ManagedLink *next;                           ///< Next node (nullptr when not in the list)
+};
+
+
+   // Keep track of initialized instances (list head):
+   ManagedLink allManaged = { nullptr, &allManaged, &allManaged };
+
+
+/**
+ * Appends a node to the list.
+ * @param link node (not in the list)
+ */
+static void linkManaged(ManagedLink &link)
+{
+   link.prev = allManaged.prev;
+   link.next = &allManaged;
+   allManaged.prev->next = &link;
+   allManaged.prev = &link;
+}
+
+
+/**
+ * Removes a node from the list, when in the list.
+ * @param link node
+ */
+static void unlinkManaged(ManagedLink &link)
+{
+   if (link.next == nullptr)
+      return;
+   link.prev->next = link.next;
+   link.next->prev = link.prev;
+   link.prev = link.next = nullptr;
+}
 
 
 
@@ -36,15 +78,16 @@
 /**
  * @brief Managed reserved structure.
  */
-struct Eng::Managed::Reserved
+struct Eng::Managed::Reserved : public Eng::Pooled<Eng::Managed::Reserved>
 {  
    bool initialized;    ///< True when the object is allocated on the device 
+   ManagedLink link;    ///< Node in the list of initialized instances
 
 
    /**
     * Constructor.
     */
-   Reserved() : initialized{ false }
+   Reserved() : initialized{ false }, link{ nullptr, nullptr, nullptr }
    {}
 };
 
@@ -61,6 +104,7 @@ struct Eng::Managed::Reserved
 ENG_API Eng::Managed::Managed() : reserved(std::make_unique<Eng::Managed::Reserved>())
 {
    ENG_LOG_DEBUG("[+]");
+   reserved->link.owner = this;
 }
 
 
@@ -73,12 +117,8 @@ ENG_API Eng::Managed::Managed(Managed &&other) : reserved(std::move(other.reserv
    ENG_LOG_DEBUG("[M]");
 
    // Update the reference:
-   for (auto it = allManaged.begin(); it != allManaged.end(); ++it)
-      if (it->get().reserved == other.reserved)
-      {
-         *it = *this; 
-         break;
-      }
+   if (reserved)
+      reserved->link.owner = this;
 }
 
 
@@ -90,13 +130,8 @@ ENG_API Eng::Managed::~Managed()
 {
    ENG_LOG_DEBUG("[-]");
 
-   if (!allManaged.empty())
-      for (auto it = allManaged.begin(); it != allManaged.end(); ++it)
-         if (it->get().reserved == this->reserved)
-         {  
-            allManaged.erase(it); // Already done in free
-            break;
-         }
+   if (reserved)
+      unlinkManaged(reserved->link); // Usually already done in free
 }
 
 
@@ -115,7 +150,7 @@ bool ENG_API Eng::Managed::init()
    }
 
    // Add to the list:
-   allManaged.push_back(*this);
+   linkManaged(reserved->link);
 
    // Done:
    reserved->initialized = true;
@@ -140,13 +175,7 @@ bool ENG_API Eng::Managed::free()
    }
    
    // Remove from list:
-   if (!allManaged.empty())
-      for (auto it = allManaged.begin(); it != allManaged.end(); ++it)
-         if (it->get().reserved == this->reserved)
-         {
-            allManaged.erase(it);
-            break;
-         }   
+   unlinkManaged(reserved->link);
 
    // Done:
    reserved->initialized = false;
@@ -164,23 +193,16 @@ bool ENG_API Eng::Managed::forceRelease()
    ENG_LOG_DEBUG("Forced release of managed objects...");
 
    uint64_t total = 0, initialized = 0;
-   if (!allManaged.empty())
+   while (allManaged.next != &allManaged) // Always restart from the head, free() may release other objects too
    {
-      auto it = allManaged.begin();
-      while (it != allManaged.end()) 
+      ManagedLink *link = allManaged.next;
+      total++;
+      if (link->owner->isInitialized())
       {
-         total++;
-         bool isInitialized = it->get().isInitialized();
-         if (isInitialized)
-         {
-            initialized++;
-            auto _it = it;            
-            it++;            
-            _it->get().free();
-         }
-         else
-            ++it;         
+         initialized++;
+         link->owner->free();
       }
+      unlinkManaged(*link); // In case free() did not
    }
 
    // Done:
@@ -191,21 +213,28 @@ bool ENG_API Eng::Managed::forceRelease()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Passes the list and forces resource deallocation.
- * @return TF
+ * Passes the list and prints the number of managed objects, per type.
  */
 void ENG_API Eng::Managed::dumpReport()
 {
+   std::map<std::string, std::pair<uint64_t, uint64_t>> perType; // Total and initialized, per type
    uint64_t total = 0, initialized = 0;
-   for (auto &m : allManaged)
+   for (ManagedLink *link = allManaged.next; link != &allManaged; link = link->next)
    {
+      std::pair<uint64_t, uint64_t> &counters = perType[typeid(*link->owner).name()];
       total++;
-      if (m.get().isInitialized())
-         initialized++;           
+      counters.first++;
+      if (link->owner->isInitialized())
+      {
+         initialized++;
+         counters.second++;
+      }
    }
 
    // Done:
    ENG_LOG_PLAIN("%llu managed object(s), %llu initialized", total, initialized); 
+   for (auto &type : perType)
+      ENG_LOG_PLAIN("   %s: %llu, %llu initialized", type.first.c_str(), type.second.first, type.second.second);
 }
 
 
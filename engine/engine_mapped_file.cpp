@@ -0,0 +1,299 @@
+/**
+ * @file		engine_mapped_file.cpp
+ * @brief	Read-only memory-mapped file
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // OS:
+#ifdef _WINDOWS
+   #include <Windows.h>
+#else
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief MappedFile reserved structure.
+ */
+struct Eng::MappedFile::Reserved
+{
+   std::string filename;         ///< Name of the mapped file
+   const uint8_t *data;          ///< Pointer to the first mapped byte
+   uint64_t nrOfBytes;           ///< Size of the mapping
+   std::shared_ptr<const Eng::MappedFile> parent;   ///< Mapping this file is a view of (e.g., an archive), if any
+
+#ifdef _WINDOWS
+   HANDLE file;                  ///< File handle
+   HANDLE mapping;               ///< File mapping handle
+#else
+   int file;                     ///< File descriptor
+#endif
+
+
+   /**
+    * Constructor.
+    */
+#ifdef _WINDOWS
+   Reserved() : data{ nullptr }, nrOfBytes{ 0 }, file{ INVALID_HANDLE_VALUE }, mapping{ nullptr }
+#else
+   Reserved() : data{ nullptr }, nrOfBytes{ 0 }, file{ -1 }
+#endif
+   {}
+};
+
+
+
+//////////////////////////////
+// BODY OF CLASS MappedFile //
+//////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::MappedFile::MappedFile() : reserved(std::make_unique<Eng::MappedFile::Reserved>())
+{
+   ENG_LOG_DETAIL("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Move constructor.
+ */
+ENG_API Eng::MappedFile::MappedFile(MappedFile &&other) : reserved(std::move(other.reserved))
+{
+   ENG_LOG_DETAIL("[M]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::MappedFile::~MappedFile()
+{
+   ENG_LOG_DETAIL("[-]");
+   if (reserved) // Because of the move constructor
+      this->close();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Pointer to the mapped bytes.
+ * @return pointer to the first byte, or nullptr if not mapped
+ */
+const uint8_t ENG_API *Eng::MappedFile::getData() const
+{
+   return reserved->data;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the size of the mapping.
+ * @return number of mapped bytes
+ */
+uint64_t ENG_API Eng::MappedFile::getNrOfBytes() const
+{
+   return reserved->nrOfBytes;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the name of the mapped file.
+ * @return filename
+ */
+const std::string ENG_API &Eng::MappedFile::getFilename() const
+{
+   return reserved->filename;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns true when a file is currently mapped.
+ * @return TF
+ */
+bool ENG_API Eng::MappedFile::isOpen() const
+{
+   return reserved->data != nullptr;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Maps the given file read-only.
+ * @param filename file name
+ * @return TF
+ */
+bool ENG_API Eng::MappedFile::open(const std::string &filename)
+{
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Release previous mapping:
+   this->close();
+
+   // Mounted archives first:
+   if (Eng::Archive::findMounted(filename, *this))
+      return true;
+
+#ifdef _WINDOWS
+   reserved->file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (reserved->file == INVALID_HANDLE_VALUE)
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
+      return false;
+   }
+
+   LARGE_INTEGER size;
+   if (!GetFileSizeEx(reserved->file, &size) || size.QuadPart == 0)
+   {
+      ENG_LOG_ERROR("File '%s' is empty or not accessible", filename.c_str());
+      this->close();
+      return false;
+   }
+
+   reserved->mapping = CreateFileMappingA(reserved->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (reserved->mapping == nullptr)
+   {
+      ENG_LOG_ERROR("Unable to map file '%s'", filename.c_str());
+      this->close();
+      return false;
+   }
+
+   reserved->data = static_cast<const uint8_t *>(MapViewOfFile(reserved->mapping, FILE_MAP_READ, 0, 0, 0));
+   reserved->nrOfBytes = static_cast<uint64_t>(size.QuadPart);
+#else
+   reserved->file = ::open(filename.c_str(), O_RDONLY);
+   if (reserved->file < 0)
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
+      return false;
+   }
+
+   struct stat info;
+   if (fstat(reserved->file, &info) != 0 || info.st_size == 0)
+   {
+      ENG_LOG_ERROR("File '%s' is empty or not accessible", filename.c_str());
+      this->close();
+      return false;
+   }
+
+   void *ptr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, reserved->file, 0);
+   if (ptr != MAP_FAILED)
+   {
+      madvise(ptr, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+      reserved->data = static_cast<const uint8_t *>(ptr);
+   }
+   reserved->nrOfBytes = static_cast<uint64_t>(info.st_size);
+#endif
+
+   if (reserved->data == nullptr)
+   {
+      ENG_LOG_ERROR("Unable to map file '%s'", filename.c_str());
+      this->close();
+      return false;
+   }
+
+   // Done:
+   reserved->filename = filename;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Opens a view on a range of bytes of another mapping. The other mapping is kept alive until this view is closed.
+ * @param parent mapping containing the data
+ * @param offset offset of the first byte of the view within the parent mapping
+ * @param nrOfBytes size of the view
+ * @param filename name given to the view
+ * @return TF
+ */
+bool ENG_API Eng::MappedFile::open(const std::shared_ptr<const Eng::MappedFile> &parent, uint64_t offset, uint64_t nrOfBytes, const std::string &filename)
+{
+   // Safety net:
+   if (parent == nullptr || parent->isOpen() == false || nrOfBytes == 0 || offset + nrOfBytes > parent->getNrOfBytes())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Release previous mapping:
+   this->close();
+
+   // Done:
+   reserved->parent = parent;
+   reserved->data = parent->getData() + offset;
+   reserved->nrOfBytes = nrOfBytes;
+   reserved->filename = filename;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases the mapping. Pointers previously returned by getData() are no longer valid.
+ * @return TF
+ */
+bool ENG_API Eng::MappedFile::close()
+{
+   // View on another mapping?
+   if (reserved->parent)
+   {
+      reserved->parent.reset();
+      reserved->data = nullptr;
+      reserved->nrOfBytes = 0;
+      reserved->filename.clear();
+      return true;
+   }
+
+#ifdef _WINDOWS
+   if (reserved->data)
+      UnmapViewOfFile(reserved->data);
+   if (reserved->mapping)
+      CloseHandle(reserved->mapping);
+   if (reserved->file != INVALID_HANDLE_VALUE)
+      CloseHandle(reserved->file);
+   reserved->mapping = nullptr;
+   reserved->file = INVALID_HANDLE_VALUE;
+#else
+   if (reserved->data)
+      munmap(const_cast<uint8_t *>(reserved->data), static_cast<size_t>(reserved->nrOfBytes));
+   if (reserved->file >= 0)
+      ::close(reserved->file);
+   reserved->file = -1;
+#endif
+
+   // Done:
+   reserved->data = nullptr;
+   reserved->nrOfBytes = 0;
+   reserved->filename.clear();
+   return true;
+}
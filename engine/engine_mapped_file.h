@@ -0,0 +1,49 @@
+/**
+ * @file		engine_mapped_file.h
+ * @brief	Read-only memory-mapped file
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Class for mapping a whole file read-only into the address space. Pages are loaded on demand by the OS.
+ *        Files stored in a mounted Archive are served as views on the archive mapping.
+ */
+class ENG_API MappedFile
+{
+//////////
+public: //
+//////////
+
+   // Const/dest:
+   MappedFile();
+   MappedFile(MappedFile &&other);
+   MappedFile(MappedFile const &) = delete;
+   virtual ~MappedFile();
+
+   // Operators:
+   void operator=(MappedFile const &) = delete;
+
+   // Get/set:
+   const uint8_t *getData() const;
+   uint64_t getNrOfBytes() const;
+   const std::string &getFilename() const;
+   bool isOpen() const;
+
+   // Mapping:
+   bool open(const std::string &filename);
+   bool open(const std::shared_ptr<const Eng::MappedFile> &parent, uint64_t offset, uint64_t nrOfBytes, const std::string &filename);
+   bool close();
+
+
+/////////////
+protected: //
+/////////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+};
@@ -23,6 +23,74 @@
    // Special values:
    Eng::Material Eng::Material::empty("[empty]");
 
+/**
+ * Computes the content hash of a bitmap (format, size and all of its levels).
+ * @param bitmap bitmap
+ * @return hash value
+ */
+static uint64_t hashBitmap(const Eng::Bitmap &bitmap)
+{
+   uint64_t hash = static_cast<uint64_t>(bitmap.getFormat()) * 0x100000001b3ull;
+   hash ^= (static_cast<uint64_t>(bitmap.getSizeX()) << 32) | bitmap.getSizeY();
+   for (uint32_t s = 0; s < bitmap.getNrOfSides(); s++)
+      for (uint32_t l = 0; l < bitmap.getNrOfLevels(); l++)
+         hash = (hash ^ Eng::Cooked::computeHash(bitmap.getData(l, s), bitmap.getNrOfBytes(l, s))) * 0x100000001b3ull;
+
+   // Avoid the "unknown" value:
+   return hash ? hash : 1;
+}
+
+
+/**
+ * Computes the mip chain of images stored without one, so that they can be streamed and don't rely on the driver.
+ * Albedo is gamma-corrected.
+ * @param bitmap bitmap
+ * @param type texture level the bitmap is used for
+ */
+static void completeMipmaps(Eng::Bitmap &bitmap, Eng::Texture::Type type)
+{
+   if (bitmap.getNrOfLevels() == 1 && bitmap.getNrOfSides() == 1 && (bitmap.getSizeX() > 1 || bitmap.getSizeY() > 1))
+      bitmap.generateMipmaps(Eng::Bitmap::Filter::kaiser, type == Eng::Texture::Type::albedo);
+}
+
+
+/**
+ * Decodes an image file and completes its mip chain.
+ * @param name image file
+ * @param type texture level the image is used for
+ * @param info loading options (can be nullptr)
+ * @return image or nullptr on error
+ */
+static std::shared_ptr<Eng::Bitmap> decodeImage(const std::string &name, Eng::Texture::Type type, const Eng::Ovo::LoadInfo *info)
+{
+   std::shared_ptr<Eng::Bitmap> bitmap = std::make_shared<Eng::Bitmap>();
+   bool loaded = (info && info->loadBitmap) ? info->loadBitmap(name, *bitmap) : bitmap->load(name);
+   if (!loaded)
+   {
+      ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
+      return nullptr;
+   }
+
+   // Done:
+   completeMipmaps(*bitmap, type);
+   return bitmap;
+}
+
+
+/**
+ * Packs a roughness and a metalness image into a single one (red and green channels).
+ * @param roughness roughness image
+ * @param metalness metalness image
+ * @return packed image or nullptr on error
+ */
+static std::shared_ptr<Eng::Bitmap> packImages(const Eng::Bitmap &roughness, const Eng::Bitmap &metalness)
+{
+   std::shared_ptr<Eng::Bitmap> packed = std::make_shared<Eng::Bitmap>();
+   if (packed->pack(roughness, metalness) == false)
+      return nullptr;
+   return packed;
+}
+
 
 
 /////////////////////////
@@ -32,7 +100,7 @@
 /**
  * @brief Material reserved structure.
  */
-struct Eng::Material::Reserved
+struct Eng::Material::Reserved : public Eng::Pooled<Eng::Material::Reserved>
 {
    // Keep these vars first and in this order...:
    glm::vec3 emission;                                   ///< Emissive term
@@ -44,6 +112,13 @@ struct Eng::Material::Reserved
    // ...48 bytes
 
    std::reference_wrapper<const Eng::Texture> texture[Eng::Material::maxNrOfTextures];
+   std::shared_ptr<const Eng::Bitmap> bitmap[Eng::Material::maxNrOfTextures];   ///< Loaded images waiting for upload
+   std::shared_future<std::shared_ptr<const Eng::Bitmap>> decoded[Eng::Material::maxNrOfTextures];   ///< Images decoded by loadChunk(), possibly by another material
+   std::string bitmapName[Eng::Material::maxNrOfTextures];               ///< Images to load on first use (lazy mode)
+   std::string texturePath[Eng::Material::maxNrOfTextures];              ///< Source files of the cached textures
+   uint32_t atlasRef[Eng::Material::maxNrOfTextures];                    ///< Images stored in the TextureAtlas (or TextureAtlas::none)
+   bool keepBitmaps;                                                     ///< Textures keep their images after upload
+   bool ormPacked;                                                       ///< Roughness (red) and metalness (green) share the roughness texture
 
 
    /**
@@ -54,8 +129,37 @@ struct Eng::Material::Reserved
                 opacity{ 1.0f },
                 roughness{ 0.5f }, metalness{ 0.01f }, 
                 _pad{ 0.0f },
-                texture{ Eng::Texture::empty, Eng::Texture::empty, Eng::Texture::empty, Eng::Texture::empty }
+                texture{ Eng::Texture::empty, Eng::Texture::empty, Eng::Texture::empty, Eng::Texture::empty },
+                atlasRef{ Eng::TextureAtlas::none, Eng::TextureAtlas::none, Eng::TextureAtlas::none, Eng::TextureAtlas::none },
+                keepBitmaps{ false }, ormPacked{ false }
    {}
+
+
+   /**
+    * Packs the loaded roughness and metalness images into the roughness slot (red and green channels), under the
+    * combined path "roughness|metalness". CPU only (BC5 encode and mips), hence not done by upload(). When packing
+    * fails, both images are uploaded separately.
+    * @return TF
+    */
+   bool pack()
+   {
+      const uint32_t r = static_cast<uint32_t>(Eng::Texture::Type::roughness) - 1;
+      const uint32_t m = static_cast<uint32_t>(Eng::Texture::Type::metalness) - 1;
+      if (bitmap[r] == nullptr || bitmap[m] == nullptr)
+         return false;
+
+      std::shared_ptr<const Eng::Bitmap> packed = packImages(*bitmap[r], *bitmap[m]);
+      if (packed == nullptr)
+         return false;
+
+      // Done:
+      texturePath[r] += "|" + texturePath[m];
+      texturePath[m].clear();
+      bitmap[r] = std::move(packed);
+      bitmap[m].reset();
+      ormPacked = true;
+      return true;
+   }
 };
 
 
@@ -101,6 +205,16 @@ ENG_API Eng::Material::Material(Material &&other) : Eng::Object(std::move(other)
  */
 ENG_API Eng::Material::~Material()
 {
+   // Release cached textures:
+   if (reserved)
+      for (uint32_t c = 0; c < Eng::Material::maxNrOfTextures; c++)
+      {
+         if (!reserved->texturePath[c].empty() && reserved->texture[c].get() != Eng::Texture::empty)
+            Eng::Container::getInstance().releaseTexture(reserved->texture[c]);
+         if (reserved->atlasRef[c] != Eng::TextureAtlas::none)
+            Eng::TextureAtlas::getInstance().release(reserved->atlasRef[c]);
+      }
+
    ENG_LOG_DETAIL("[-]");
 }
 
@@ -230,17 +344,33 @@ float ENG_API Eng::Material::getOpacity() const
 bool ENG_API Eng::Material::setTexture(const Eng::Texture &tex, Eng::Texture::Type type)
 {  
    // Set texture accordingly:
+   uint32_t slot;
    switch (type)
    {  
-      case Eng::Texture::Type::albedo:    reserved->texture[0] = tex; break;
-      case Eng::Texture::Type::normal:    reserved->texture[1] = tex; break;
-      case Eng::Texture::Type::roughness: reserved->texture[2] = tex; break;
-      case Eng::Texture::Type::metalness: reserved->texture[3] = tex; break;
+      case Eng::Texture::Type::albedo:    slot = 0; break;
+      case Eng::Texture::Type::normal:    slot = 1; break;
+      case Eng::Texture::Type::roughness: slot = 2; break;
+      case Eng::Texture::Type::metalness: slot = 3; break;
       default:
          ENG_LOG_ERROR("Unsupported texture level");
          return false;
    }
 
+   // Replacing a cached texture:
+   if (!reserved->texturePath[slot].empty() && reserved->texture[slot].get() != Eng::Texture::empty)
+   {
+      Eng::Container::getInstance().releaseTexture(reserved->texture[slot]);
+      reserved->texturePath[slot].clear();
+   }
+   if (reserved->atlasRef[slot] != Eng::TextureAtlas::none)
+   {
+      Eng::TextureAtlas::getInstance().release(reserved->atlasRef[slot]);
+      reserved->atlasRef[slot] = Eng::TextureAtlas::none;
+   }
+   reserved->texture[slot] = tex;
+   if (type == Eng::Texture::Type::roughness || type == Eng::Texture::Type::metalness)
+      reserved->ormPacked = false;
+
    // Done:
    return true;
 }
@@ -268,6 +398,36 @@ const Eng::Texture ENG_API &Eng::Material::getTexture(Eng::Texture::Type type) c
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether roughness and metalness are packed into the roughness texture (red and green channels), in which
+ * case there is no metalness texture.
+ * @return TF
+ */
+bool ENG_API Eng::Material::isOrmPacked() const
+{
+   return reserved->ormPacked;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the TextureAtlas reference of a texture level, used instead of getTexture() when the image was stored
+ * in the atlas.
+ * @param type texture level
+ * @return atlas reference, or TextureAtlas::none
+ */
+uint32_t ENG_API Eng::Material::getAtlasRef(Eng::Texture::Type type) const
+{
+   if (type == Eng::Texture::Type::none || type >= Eng::Texture::Type::last)
+   {
+      ENG_LOG_ERROR("Unsupported texture level");
+      return Eng::TextureAtlas::none;
+   }
+   return reserved->atlasRef[static_cast<uint32_t>(type) - 1];
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Loads the specific information of a given object. In its base class, this function loads the file version chunk.
@@ -300,83 +460,252 @@ uint32_t ENG_API Eng::Material::loadChunk(Eng::Serializer &serial, void *data)
    serial.deserialize(reserved->metalness);
    serial.deserialize(reserved->opacity);
 
-   // Textures:
-   Eng::Container &container = Eng::Container::getInstance();
-
-   // Albedo:
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (albedo): %s", name.c_str());
-   if (name != "[none]")
+   // Textures (images are decoded here, or on first use in lazy mode; GPU upload happens in upload()):
+   Eng::Ovo::LoadInfo *info = static_cast<Eng::Ovo::LoadInfo *>(data);
+   reserved->keepBitmaps = info && info->keepBitmaps;
+   auto readName = [&serial](const char *label)
    {
-      Eng::Bitmap bitmap;
-      if (!bitmap.load(name))
-         ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
-      else
+      std::string name;
+      serial.deserialize(name);
+      ENG_LOG_PLAIN("Texture (%s): %s", label, name.c_str());
+      return name;
+   };
+   auto decodeBitmap = [this, info](const std::string &name, Eng::Texture::Type type)
+   {
+      // Files shared by several materials are decoded once, also when loaded in parallel (resolved by upload()):
+      reserved->decoded[static_cast<uint32_t>(type) - 1] = Eng::Container::getInstance().decodeBitmap(name, [&name, type, info]()
+         {
+            return std::shared_ptr<const Eng::Bitmap>(decodeImage(name, type, info));
+         });
+      reserved->texturePath[static_cast<uint32_t>(type) - 1] = name;
+   };
+   auto loadBitmap = [this, info, &decodeBitmap](const std::string &name, Eng::Texture::Type type)
+   {
+      if (name == "[none]")
+         return;
+      if (info && info->lazy)
       {
-         Eng::Texture tex;
-         tex.load(bitmap);
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::albedo);
+         reserved->bitmapName[static_cast<uint32_t>(type) - 1] = name;
+         return;
       }
-   }
 
-   // Normal:
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (normal): %s", name.c_str());
-   if (name != "[none]")
-   {
-      Eng::Bitmap bitmap;
-      if (!bitmap.load(name))
-         ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
-      else
+      // Already loaded by another material?
+      const uint32_t atlasRef = Eng::TextureAtlas::getInstance().acquire(name);
+      if (atlasRef != Eng::TextureAtlas::none)
       {
-         Eng::Texture tex;
-         tex.load(bitmap);
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::normal);
+         reserved->atlasRef[static_cast<uint32_t>(type) - 1] = atlasRef;
+         reserved->texturePath[static_cast<uint32_t>(type) - 1] = name;
+         return;
+      }
+      Eng::Texture &cached = Eng::Container::getInstance().acquireTexture(name);
+      if (cached != Eng::Texture::empty)
+      {
+         reserved->texture[static_cast<uint32_t>(type) - 1] = cached;
+         reserved->texturePath[static_cast<uint32_t>(type) - 1] = name;
+         return;
       }
-   }
+
+      decodeBitmap(name, type);
+   };
+   loadBitmap(readName("albedo"), Eng::Texture::Type::albedo);
+   loadBitmap(readName("normal"), Eng::Texture::Type::normal);
 
    // Height (ignored):
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (height): %s", name.c_str());
-   
-   // Roughness:
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (roughness): %s", name.c_str());
-   if (name != "[none]")
+   readName("height");
+
+   // Roughness and metalness, packed into a single texture when enabled (reusing the packed texture, if any):
+   const std::string roughnessName = readName("roughness");
+   const std::string metalnessName = readName("metalness");
+   const bool packing = Eng::Container::getInstance().getTexturePacking() && (info == nullptr || info->lazy == false) &&
+                        roughnessName != "[none]" && metalnessName != "[none]";
+   bool packed = false;
+   if (packing)
    {
-      Eng::Bitmap bitmap;
-      if (!bitmap.load(name))
-         ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
+      const uint32_t r = static_cast<uint32_t>(Eng::Texture::Type::roughness) - 1;
+      const std::string path = roughnessName + "|" + metalnessName;
+      const uint32_t atlasRef = Eng::TextureAtlas::getInstance().acquire(path);
+      if (atlasRef != Eng::TextureAtlas::none)
+         reserved->atlasRef[r] = atlasRef;
       else
       {
-         Eng::Texture tex;
-         tex.load(bitmap);
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::roughness);
+         Eng::Texture &cached = Eng::Container::getInstance().acquireTexture(path);
+         if (cached != Eng::Texture::empty)
+            reserved->texture[r] = cached;
+      }
+      if (atlasRef != Eng::TextureAtlas::none || reserved->texture[r].get() != Eng::Texture::empty)
+      {
+         reserved->texturePath[r] = path;
+         reserved->ormPacked = true;
+         packed = true;
       }
+      else
+      {
+         // Decoded and packed once, as a whole:
+         std::shared_future<std::shared_ptr<const Eng::Bitmap>> decoded = Eng::Container::getInstance().decodeBitmap(path, [&roughnessName, &metalnessName, info]()
+            {
+               std::shared_ptr<Eng::Bitmap> roughness = decodeImage(roughnessName, Eng::Texture::Type::roughness, info);
+               std::shared_ptr<Eng::Bitmap> metalness = decodeImage(metalnessName, Eng::Texture::Type::metalness, info);
+               return std::shared_ptr<const Eng::Bitmap>((roughness && metalness) ? packImages(*roughness, *metalness) : nullptr);
+            });
+
+         // Failed here (not by another material, still pending)?
+         if (decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready || decoded.get() != nullptr)
+         {
+            reserved->decoded[r] = decoded;
+            reserved->texturePath[r] = path;
+            reserved->ormPacked = true;
+            packed = true;
+         }
+      }
+   }
+   if (!packed)
+   {
+      loadBitmap(roughnessName, Eng::Texture::Type::roughness);
+      loadBitmap(metalnessName, Eng::Texture::Type::metalness);
    }
 
-   // Metalness:
-   serial.deserialize(name); // Metalness
-   ENG_LOG_PLAIN("Texture (metalness): %s", name.c_str());
-   if (name != "[none]")
+   // Upload now, unless the caller defers it:
+   if (info == nullptr || (info->deferUpload == false && info->lazy == false))
+      this->upload();
+
+   // Done:
+   return 1;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates the textures for the images loaded by loadChunk() and releases them (unless loaded with
+ * LoadInfo::keepBitmaps). Requires an OpenGL context.
+ * @return TF
+ */
+bool ENG_API Eng::Material::upload()
+{
+   Eng::Container &container = Eng::Container::getInstance();
+   Eng::TextureAtlas &atlas = Eng::TextureAtlas::getInstance();
+   const bool useAtlas = atlas.isEnabled() && reserved->keepBitmaps == false;
+   const uint32_t roughness = static_cast<uint32_t>(Eng::Texture::Type::roughness) - 1;
+
+   // Images are ready (roughness and metalness already packed by loadChunk(), if enabled), only GL work here:
+   for (uint32_t c = 0; c < Eng::Material::maxNrOfTextures; c++)
    {
-      Eng::Bitmap bitmap;
-      if (!bitmap.load(name))
-         ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
-      else
+      // Images decoded by another material are ready by now:
+      if (reserved->decoded[c].valid())
+      {
+         reserved->bitmap[c] = reserved->decoded[c].get();
+         reserved->decoded[c] = {};
+         if (reserved->bitmap[c] == nullptr)
+         {
+            reserved->texturePath[c].clear();
+            if (c == roughness)
+               reserved->ormPacked = false;
+         }
+      }
+      if (reserved->bitmap[c] == nullptr)
+         continue;
+
+      // Texture arrays (not streamed). Images that don't fit fall back to standalone textures:
+      const std::string path = reserved->texturePath[c];
+      if (useAtlas)
+      {
+         uint32_t atlasRef = atlas.acquire(path);
+         if (atlasRef == Eng::TextureAtlas::none)
+            atlasRef = atlas.add(*reserved->bitmap[c], path);
+         if (atlasRef != Eng::TextureAtlas::none)
+         {
+            reserved->texturePath[c].clear();
+            this->setTexture(Eng::Texture::empty, static_cast<Eng::Texture::Type>(c + 1));
+            reserved->texturePath[c] = path;
+            reserved->atlasRef[c] = atlasRef;
+            reserved->bitmap[c].reset();
+            container.releaseBitmap(path);
+            continue;
+         }
+      }
+
+      // Reuse a texture with the same path or content, if any:
+      uint64_t hash = 0;
+      Eng::Texture *tex = &container.acquireTexture(path);
+      if (*tex == Eng::Texture::empty && container.getTextureHashing())
       {
-         Eng::Texture tex;
-         tex.load(bitmap);
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::metalness);
+         hash = hashBitmap(*reserved->bitmap[c]);
+         tex = &container.acquireTexture(path, hash);
       }
-   }   
+      if (*tex == Eng::Texture::empty)
+      {
+         // Streamed textures start with their mip tail only (packed images have no file to stream from):
+         Eng::TextureStreamer &streamer = Eng::TextureStreamer::getInstance();
+         std::shared_ptr<const Eng::Bitmap> bitmap(std::move(reserved->bitmap[c]));
+         const bool streamed = streamer.isEnabled() && !path.empty() && bitmap->getNrOfSides() == 1 && streamer.getTailLevel(*bitmap) > 0 &&
+                               (reserved->ormPacked == false || c != roughness);
+
+         Eng::Texture created;
+         created.load(bitmap, streamed ? streamer.getTailLevel(*bitmap) : 0, reserved->keepBitmaps);
+         tex = &container.addTexture(created, path, hash);
+         if (streamed)
+            streamer.add(*tex, *bitmap, path, c + 1 == static_cast<uint32_t>(Eng::Texture::Type::albedo));
+      }
+      reserved->texturePath[c].clear();
+      this->setTexture(*tex, static_cast<Eng::Texture::Type>(c + 1));
+      reserved->texturePath[c] = path;
+      reserved->bitmap[c].reset();
+      container.releaseBitmap(path);
+   }
 
    // Done:
-   return 1;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Loads and uploads the textures of a material loaded in lazy mode, on first use. Requires an OpenGL context.
+ * @return TF
+ */
+bool ENG_API Eng::Material::materialize() const
+{
+   bool pending = false;
+   for (uint32_t c = 0; c < Eng::Material::maxNrOfTextures; c++)
+   {
+      if (reserved->bitmapName[c].empty())
+         continue;
+
+      // Already loaded by another material?
+      const uint32_t atlasRef = Eng::TextureAtlas::getInstance().acquire(reserved->bitmapName[c]);
+      if (atlasRef != Eng::TextureAtlas::none)
+      {
+         reserved->atlasRef[c] = atlasRef;
+         reserved->texturePath[c] = reserved->bitmapName[c];
+         reserved->bitmapName[c].clear();
+         continue;
+      }
+      Eng::Texture &cached = Eng::Container::getInstance().acquireTexture(reserved->bitmapName[c]);
+      if (cached != Eng::Texture::empty)
+      {
+         reserved->texture[c] = cached;
+         reserved->texturePath[c] = reserved->bitmapName[c];
+         reserved->bitmapName[c].clear();
+         continue;
+      }
+
+      std::shared_ptr<Eng::Bitmap> bitmap = decodeImage(reserved->bitmapName[c], static_cast<Eng::Texture::Type>(c + 1), nullptr);
+      if (bitmap)
+      {
+         reserved->bitmap[c] = std::move(bitmap);
+         reserved->texturePath[c] = reserved->bitmapName[c];
+         pending = true;
+      }
+      reserved->bitmapName[c].clear();
+   }
+
+   // Done (lazy materials are loaded on first use, packing included):
+   if (pending)
+   {
+      if (Eng::Container::getInstance().getTexturePacking())
+         reserved->pack();
+      return const_cast<Eng::Material &>(*this).upload();
+   }
+   return true;
 }
 
 
@@ -389,13 +718,36 @@ uint32_t ENG_API Eng::Material::loadChunk(Eng::Serializer &serial, void *data)
  */
 bool ENG_API Eng::Material::render(uint32_t value, void *data) const
 {	
-   // Pass textures:
+   materialize();
+
+   // Pass textures. Streamed ones get the levels reported by the GPU feedback, when active, or full resolution:
+   Eng::TextureStreamer &streamer = Eng::TextureStreamer::getInstance();
+   const bool feedback = streamer.isFeedbackActive();
    for (uint32_t c = 0; c < Eng::Material::maxNrOfTextures; c++)
+   {
+      uint32_t slot = Eng::TextureStreamer::noSlot;
       if (reserved->texture[c].get() != Eng::Texture::empty)
-         reserved->texture[c].get().render(c);
+      {
+         const Eng::Texture &tex = reserved->texture[c].get();
+         slot = streamer.getSlot(tex);
+         if (feedback && slot != Eng::TextureStreamer::noSlot)
+            streamer.request(tex, tex.getBaseLevel(), 0.0f); // Just mark it as used
+         else
+            streamer.request(tex);
+         tex.render(c);
+      }
       else
          Eng::Texture::getDefault().render(c);
 
+      if (streamer.isEnabled())
+         Eng::Program::getCached().setUInt("feedback" + std::to_string(c), feedback ? slot : Eng::TextureStreamer::noSlot);
+   }
+   if (Eng::Container::getInstance().getTexturePacking())
+      Eng::Program::getCached().setInt("ormPacked", reserved->ormPacked);
+   if (Eng::TextureAtlas::getInstance().isEnabled())
+      for (uint32_t c = 0; c < Eng::Material::maxNrOfTextures; c++)
+         Eng::Program::getCached().setUInt("atlas" + std::to_string(c), reserved->atlasRef[c]);
+
    // Done:
    return true;
 }
@@ -41,12 +41,15 @@ public: //
    float getMetalness() const;   
    bool setTexture(const Eng::Texture &tex, Eng::Texture::Type type = Eng::Texture::Type::albedo);
    const Eng::Texture &getTexture(Eng::Texture::Type type = Eng::Texture::Type::albedo) const;
+   bool isOrmPacked() const;
+   uint32_t getAtlasRef(Eng::Texture::Type type = Eng::Texture::Type::albedo) const;
 
    // Rendering methods:   
    bool render(uint32_t value = 0, void *data = nullptr) const;
 
    // Ovo:   
    uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr);
+   bool upload();
 
 
 /////////////
@@ -59,6 +62,9 @@ protected: //
 
    // Const/dest:
    Material(const std::string &name);
+
+   // Internal:
+   bool materialize() const;
 };
 
 
@@ -14,6 +14,9 @@
     // Main include:
 #include "engine.h"
 
+// C/C++:
+#include <algorithm>
+
 // GLM:
 #include <glm/gtc/packing.hpp>  
 
@@ -39,7 +42,7 @@ Eng::Mesh Eng::Mesh::empty("[empty]");
 /**
  * @brief Mesh class reserved structure.
  */
-struct Eng::Mesh::Reserved
+struct Eng::Mesh::Reserved : public Eng::Pooled<Eng::Mesh::Reserved>
 {
    // Buffers:
    Eng::Vao vao;
@@ -47,16 +50,41 @@ struct Eng::Mesh::Reserved
    Eng::Ebo ebo;
 
    // Material:
-   std::reference_wrapper<const Eng::Material> material;
+   Eng::Handle<Eng::Material> materialHandle;            ///< Material stored in the Container
+   std::reference_wrapper<const Eng::Material> material; ///< Material not stored in the Container (used when the handle is null)
 
    // Bounding volumes:
    float radius;
+   glm::vec3 center;                                     ///< Center of the bounding box
+
+   // Staging (geometry decoded by loadChunk() and waiting for upload()):
+   Eng::Serializer source;                               ///< Mapped LOD section, decoded on first use (lazy mode)
+   std::shared_ptr<const Eng::MappedFile> stagingFile;   ///< Keeps the mapped source alive
+   std::vector<uint8_t> stagingCopy;                     ///< Used when the source is not mapped
+
+   /**
+    * @brief Geometry of a LOD waiting for upload().
+    */
+   struct Staged
+   {
+      const void *vertices;                              ///< Vertex data, or nullptr when stored in stagingCopy
+      const void *faces;                                 ///< Face data, or nullptr when stored in stagingCopy
+      uint64_t offset;                                   ///< Position in stagingCopy (vertices, then faces)
+      uint32_t nrOfVertices;
+      uint32_t nrOfFaces;
+      float error;                                       ///< Simplification error (0 when authored)
+   };
+   std::vector<Staged> staged;
+   bool compressed;                                      ///< LOD section encoded by MeshCodec
+
+   // LODs (ranges within vbo and ebo):
+   std::vector<Eng::Mesh::Lod> lods;
 
 
    /**
     * Constructor
     */
-   Reserved() : material{ Eng::Material::empty }, radius { 1.0f }
+   Reserved() : material{ Eng::Material::empty }, radius { 1.0f }, center{ 0.0f }, compressed{ false }
    {}
 };
 
@@ -109,13 +137,15 @@ ENG_API Eng::Mesh::~Mesh()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Sets material.
+ * Sets material. Materials stored in the Container are referenced by handle, so that a removed material reads as
+ * Material::empty instead of dangling.
  * @param mat material
  * @return TF
  */
 bool ENG_API Eng::Mesh::setMaterial(const Eng::Material& mat)
 {
-   reserved->material = mat;
+   reserved->materialHandle = Eng::Container::getInstance().getHandle(mat);
+   reserved->material = reserved->materialHandle.isNull() ? mat : Eng::Material::empty;
 
    // Done:
    return true;
@@ -129,7 +159,9 @@ bool ENG_API Eng::Mesh::setMaterial(const Eng::Material& mat)
  */
 const Eng::Material ENG_API& Eng::Mesh::getMaterial() const
 {
-   return reserved->material;
+   if (reserved->materialHandle.isNull())
+      return reserved->material;
+   return Eng::Container::getInstance().resolve(reserved->materialHandle);
 }
 
 
@@ -140,6 +172,7 @@ const Eng::Material ENG_API& Eng::Mesh::getMaterial() const
  */
 const Eng::Vbo ENG_API& Eng::Mesh::getVbo() const
 {
+   materialize();
    return reserved->vbo;
 }
 
@@ -151,10 +184,24 @@ const Eng::Vbo ENG_API& Eng::Mesh::getVbo() const
  */
 const Eng::Ebo ENG_API& Eng::Mesh::getEbo() const
 {
+   materialize();
    return reserved->ebo;
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the bounding sphere of this mesh, replacing the one read by loadChunk() (e.g., with tighter precomputed bounds).
+ * @param center bounding sphere center in local coordinates
+ * @param radius bounding sphere radius
+ */
+void ENG_API Eng::Mesh::setBounds(const glm::vec3 &center, float radius)
+{
+   reserved->center = center;
+   reserved->radius = radius;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Gets the bounding sphere radius for this mesh.
@@ -166,6 +213,43 @@ const float ENG_API Eng::Mesh::getRadius() const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the center of the bounding sphere (center of the bounding box) for this mesh.
+ * @return bounding sphere center in local coordinates
+ */
+const glm::vec3 ENG_API &Eng::Mesh::getCenter() const
+{
+   return reserved->center;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of levels of detail uploaded.
+ * @return number of LODs
+ */
+uint32_t ENG_API Eng::Mesh::getNrOfLods() const
+{
+   return static_cast<uint32_t>(reserved->lods.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the range of a level of detail within the VBO and EBO.
+ * @param lod level of detail (clamped to the coarsest one)
+ * @return LOD range (empty range if the mesh has no geometry)
+ */
+const Eng::Mesh::Lod ENG_API &Eng::Mesh::getLod(uint32_t lod) const
+{
+   static const Eng::Mesh::Lod none = { 0, 0, 0, 0, 0.0f };
+   if (reserved->lods.empty())
+      return none;
+   return reserved->lods[std::min(lod, static_cast<uint32_t>(reserved->lods.size()) - 1)];
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Loads the specific information of a given object. In its base class, this function loads the file version chunk.
@@ -176,13 +260,15 @@ const float ENG_API Eng::Mesh::getRadius() const
 uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer& serial, void* data)
 {
    // Chunk header
+   const uint64_t start = serial.getPosition();
    uint32_t chunkId;
    serial.deserialize(&chunkId, sizeof(uint32_t));
-   if (chunkId != static_cast<uint32_t>(Ovo::ChunkId::mesh))
+   if (chunkId != static_cast<uint32_t>(Ovo::ChunkId::mesh) && chunkId != static_cast<uint32_t>(Ovo::ChunkId::meshCompressed))
    {
       ENG_LOG_ERROR("Invalid chunk ID found");
       return 0;
    }
+   reserved->compressed = chunkId == static_cast<uint32_t>(Ovo::ChunkId::meshCompressed);
    uint32_t chunkSize;
    serial.deserialize(&chunkSize, sizeof(uint32_t));
 
@@ -207,9 +293,7 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer& serial, void* data)
 
    std::string materialName;
    serial.deserialize(materialName);
-   std::reference_wrapper<const Eng::Material> mat = Eng::Material::empty;
-   mat = dynamic_cast<Eng::Material&>(Eng::Container::getInstance().find(materialName));
-   this->setMaterial(mat);
+   this->setMaterial(Eng::Container::getInstance().findMaterial(materialName));
 
    float radius;
    serial.deserialize(radius);
@@ -220,6 +304,9 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer& serial, void* data)
    glm::vec3 bboxMax;
    serial.deserialize(bboxMax);
 
+   reserved->radius = radius;
+   reserved->center = (bboxMin + bboxMax) * 0.5f;
+
    uint8_t hasPhysics;
    serial.deserialize(hasPhysics);
    if (hasPhysics)
@@ -228,6 +315,41 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer& serial, void* data)
       return 0;
    }
 
+   // Geometry:
+   Eng::Ovo::LoadInfo *info = static_cast<Eng::Ovo::LoadInfo *>(data);
+   if (info && info->lazy && serial.isMapped())
+   {
+      // Keep a view on the LOD section and skip it, geometry is decoded on first use:
+      reserved->source = serial;
+      serial.setPosition(start + 2 * sizeof(uint32_t) + chunkSize);
+      return nrOfChildren;
+   }
+   if (loadLods(serial) == false)
+      return 0;
+
+   // Upload now, unless the caller defers it:
+   if (info == nullptr || info->deferUpload == false)
+      this->upload();
+
+   // Done:      
+   return nrOfChildren;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reads the LOD section of a mesh chunk and stages the geometry of all the LODs. Compressed LODs are decoded
+ * straight into the staging memory. Meshes with a single LOD get coarser ones from the Simplifier, when enabled. All
+ * the LODs are reordered by the MeshOptimizer only when enabled on load (saved and cooked files already are).
+ * @param serial serial data, positioned at the LOD section
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::loadLods(Eng::Serializer &serial)
+{
+   reserved->staged.clear();
+   reserved->stagingCopy.clear();
+   reserved->stagingFile.reset();
+
    uint32_t nrOfLods;
    serial.deserialize(nrOfLods);
 
@@ -241,25 +363,248 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer& serial, void* data)
 
       ENG_LOG_PLAIN("LOD: %u, v: %u, f: %u", curLod + 1, nrOfVertices, nrOfFaces);
 
-      std::vector<Eng::Vbo::VertexData> allVertices(nrOfVertices);
-      serial.deserialize(allVertices.data(), nrOfVertices * sizeof(Eng::Vbo::VertexData));
+      if (reserved->compressed)
+      {
+         uint32_t vertexBytes, faceBytes;
+         serial.read(vertexBytes);
+         serial.read(faceBytes);
+         const uint8_t *vertexStream = serial.readSpan<uint8_t>(vertexBytes);
+         const uint8_t *faceStream = serial.readSpan<uint8_t>(faceBytes);
+
+         // Each face takes at least one byte after the format one, each group of 64 vertices at least 18 (rejects bogus counts before allocating):
+         if (serial.hasOverflow() || nrOfFaces >= faceBytes || nrOfVertices / 64 > vertexBytes / Eng::MeshCodec::vertexStride)
+         {
+            ENG_LOG_ERROR("Corrupted mesh data");
+            return false;
+         }
+
+         Reserved::Staged lod = { nullptr, nullptr, reserved->stagingCopy.size(), nrOfVertices, nrOfFaces, 0.0f };
+         const uint64_t vertexSize = static_cast<uint64_t>(nrOfVertices) * sizeof(Eng::Vbo::VertexData);
+         reserved->stagingCopy.resize(lod.offset + vertexSize + static_cast<uint64_t>(nrOfFaces) * sizeof(Eng::Ebo::FaceData));
+         uint8_t *dst = reserved->stagingCopy.data() + lod.offset;
+         if (Eng::MeshCodec::decodeVertices(vertexStream, vertexBytes, reinterpret_cast<Eng::Vbo::VertexData *>(dst), nrOfVertices) == false ||
+             Eng::MeshCodec::decodeFaces(faceStream, faceBytes, reinterpret_cast<Eng::Ebo::FaceData *>(dst + vertexSize), nrOfFaces) == false)
+         {
+            reserved->staged.clear();
+            reserved->stagingCopy.clear();
+            return false;
+         }
+         reserved->staged.push_back(lod);
+         continue;
+      }
 
-      std::vector<Eng::Ebo::FaceData> allFaces(nrOfFaces);
-      serial.deserialize(allFaces.data(), nrOfFaces * sizeof(Eng::Ebo::FaceData));
+      // Vertices and faces are read in place (no copy when the serializer is mapped):
+      const Eng::Vbo::VertexData *allVertices = serial.readSpan<Eng::Vbo::VertexData>(nrOfVertices);
+      const Eng::Ebo::FaceData *allFaces = serial.readSpan<Eng::Ebo::FaceData>(nrOfFaces);
+      if (serial.hasOverflow())
+      {
+         ENG_LOG_ERROR("Corrupted mesh data");
+         reserved->staged.clear();
+         return false;
+      }
+      this->stage(nrOfVertices, allVertices, nrOfFaces, allFaces, serial.getMappedFile());
+   }
 
-      // Store only first LOD for now:
-      if (curLod == 0)
+   // Generate missing LODs:
+   const Eng::Simplifier &simplifier = Eng::Simplifier::getInstance();
+   if (reserved->staged.size() == 1 && reserved->staged[0].nrOfFaces && simplifier.getNrOfLods())
+   {
+      const Reserved::Staged &lod0 = reserved->staged[0];
+      const uint8_t *copy = reserved->stagingCopy.data() + lod0.offset;
+      const void *vertices = lod0.vertices ? lod0.vertices : copy;
+      const void *faces = lod0.faces ? lod0.faces : copy + lod0.nrOfVertices * sizeof(Eng::Vbo::VertexData);
+
+      std::vector<Eng::Simplifier::Lod> lods;
+      simplifier.buildLods(static_cast<const Eng::Vbo::VertexData *>(vertices), lod0.nrOfVertices,
+                           static_cast<const Eng::Ebo::FaceData *>(faces), lod0.nrOfFaces, lods);
+      for (auto &lod : lods)
       {
-         reserved->vao.init();
-         reserved->vao.render();
+         ENG_LOG_DEBUG("Generated LOD: v: %zu, f: %zu, error: %f", lod.vertices.size(), lod.faces.size(), lod.error);
+         this->stage(static_cast<uint32_t>(lod.vertices.size()), lod.vertices.data(), static_cast<uint32_t>(lod.faces.size()), lod.faces.data(), nullptr, lod.error);
+      }
+   }
 
-         reserved->vbo.create(nrOfVertices, allVertices.data());
-         reserved->ebo.create(nrOfFaces, allFaces.data());
+   // Reorder for the vertex cache, overdraw and vertex fetch:
+   const Eng::MeshOptimizer &optimizer = Eng::MeshOptimizer::getInstance();
+   if (optimizer.isEnabledOnLoad())
+   {
+      std::vector<Reserved::Staged> staged;
+      std::vector<uint8_t> stagingCopy;
+      staged.swap(reserved->staged);
+      stagingCopy.swap(reserved->stagingCopy);
+      for (const Reserved::Staged &lod : staged)
+      {
+         const uint8_t *copy = stagingCopy.data() + lod.offset;
+         const Eng::Vbo::VertexData *v = static_cast<const Eng::Vbo::VertexData *>(lod.vertices ? lod.vertices : copy);
+         const Eng::Ebo::FaceData *f = static_cast<const Eng::Ebo::FaceData *>(lod.faces ? lod.faces : copy + lod.nrOfVertices * sizeof(Eng::Vbo::VertexData));
+         std::vector<Eng::Vbo::VertexData> vertices(v, v + lod.nrOfVertices);
+         std::vector<Eng::Ebo::FaceData> faces(f, f + lod.nrOfFaces);
+
+         if (optimizer.optimize(vertices, faces) == false)
+         {
+            reserved->staged.clear();
+            reserved->stagingCopy.clear();
+            return false;
+         }
+         ENG_LOG_DEBUG("Optimized LOD: v: %u -> %zu", lod.nrOfVertices, vertices.size());
+
+         const uint8_t *vertexBytes = reinterpret_cast<const uint8_t *>(vertices.data());
+         const uint8_t *faceBytes = reinterpret_cast<const uint8_t *>(faces.data());
+         reserved->staged.push_back({ nullptr, nullptr, reserved->stagingCopy.size(), static_cast<uint32_t>(vertices.size()), lod.nrOfFaces, lod.error });
+         reserved->stagingCopy.insert(reserved->stagingCopy.end(), vertexBytes, vertexBytes + vertices.size() * sizeof(Eng::Vbo::VertexData));
+         reserved->stagingCopy.insert(reserved->stagingCopy.end(), faceBytes, faceBytes + faces.size() * sizeof(Eng::Ebo::FaceData));
       }
+      reserved->stagingFile.reset();
    }
 
-   // Done:      
-   return nrOfChildren;
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Stages the geometry of the next level of detail (the first call stages the finest one) for a later upload().
+ * When a mapped file is given, the data is referenced in place and the mapping is kept alive until the upload;
+ * otherwise, the data is copied.
+ * @param nrOfVertices number of vertices
+ * @param vertices pointer to the vertex data
+ * @param nrOfFaces number of faces (indices are relative to the first vertex of this LOD)
+ * @param faces pointer to the face data
+ * @param file mapped file containing vertices and faces, or nullptr
+ * @param error simplification error w.r.t. the finest LOD (mesh units, 0 when authored)
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::stage(uint32_t nrOfVertices, const void *vertices, uint32_t nrOfFaces, const void *faces, std::shared_ptr<const Eng::MappedFile> file, float error)
+{
+   // Safety net:
+   if (vertices == nullptr || faces == nullptr)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   Reserved::Staged lod = { vertices, faces, 0, nrOfVertices, nrOfFaces, error };
+   if (file)
+      reserved->stagingFile = file;
+   else
+   {
+      const uint64_t vertexBytes = nrOfVertices * sizeof(Eng::Vbo::VertexData);
+      const uint64_t faceBytes = nrOfFaces * sizeof(Eng::Ebo::FaceData);
+      const uint8_t *v = static_cast<const uint8_t *>(vertices);
+      const uint8_t *f = static_cast<const uint8_t *>(faces);
+      lod.vertices = lod.faces = nullptr;
+      lod.offset = reserved->stagingCopy.size();
+      reserved->stagingCopy.insert(reserved->stagingCopy.end(), v, v + vertexBytes);
+      reserved->stagingCopy.insert(reserved->stagingCopy.end(), f, f + faceBytes);
+   }
+   reserved->staged.push_back(lod);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Makes the geometry available on the GPU. Meshes loaded in lazy mode are decoded and uploaded here, on first use.
+ * Requires an OpenGL context.
+ * @return true if GPU buffers are ready, false while an upload is still pending
+ */
+bool ENG_API Eng::Mesh::materialize() const
+{
+   if (reserved->source.isMapped())
+   {
+      Eng::Mesh &self = const_cast<Eng::Mesh &>(*this);
+      bool done = self.loadLods(reserved->source);
+      reserved->source.clear();
+      if (done)
+         done = self.upload();
+      return done;
+   }
+
+   // Done:
+   return reserved->staged.empty();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates the GPU buffers for the geometry staged by loadChunk() and releases the staging memory. LODs are stored
+ * one after the other in the same VBO and EBO, with 16-bit indices when no LOD exceeds 65536 vertices.
+ * Requires an OpenGL context.
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::upload()
+{
+   // Safety net:
+   if (reserved->staged.empty())
+   {
+      ENG_LOG_ERROR("No staged geometry");
+      return false;
+   }
+
+   // Ranges:
+   uint64_t nrOfVertices = 0;
+   uint64_t nrOfFaces = 0;
+   reserved->lods.clear();
+   for (const Reserved::Staged &lod : reserved->staged)
+   {
+      reserved->lods.push_back({ static_cast<uint32_t>(nrOfVertices), lod.nrOfVertices, static_cast<uint32_t>(nrOfFaces), lod.nrOfFaces, lod.error });
+      nrOfVertices += lod.nrOfVertices;
+      nrOfFaces += lod.nrOfFaces;
+   }
+   if (nrOfVertices > UINT32_MAX || nrOfFaces > UINT32_MAX)
+   {
+      ENG_LOG_ERROR("Mesh too large");
+      reserved->lods.clear();
+      return false;
+   }
+
+   reserved->vao.init();
+   reserved->vao.render();
+
+   // Indices are relative to the first vertex of each LOD, so 16 bits are enough when no LOD exceeds 65536 vertices:
+   uint32_t indexSize = sizeof(uint16_t);
+   for (const Reserved::Staged &lod : reserved->staged)
+      if (lod.nrOfVertices > UINT16_MAX + 1)
+         indexSize = sizeof(uint32_t);
+
+   reserved->vbo.create(static_cast<uint32_t>(nrOfVertices));
+   reserved->ebo.create(static_cast<uint32_t>(nrOfFaces), nullptr, indexSize);
+   std::vector<uint16_t> shortIndices;
+   for (uint32_t c = 0; c < reserved->staged.size(); c++)
+   {
+      const Reserved::Staged &lod = reserved->staged[c];
+      const uint64_t vertexBytes = lod.nrOfVertices * sizeof(Eng::Vbo::VertexData);
+      const uint8_t *copy = reserved->stagingCopy.data() + lod.offset;
+      const void *vertices = lod.vertices ? lod.vertices : copy;
+      const void *faces = lod.faces ? lod.faces : copy + vertexBytes;
+      if (indexSize == sizeof(uint16_t))
+      {
+         const Eng::Ebo::FaceData *f = static_cast<const Eng::Ebo::FaceData *>(faces);
+         shortIndices.resize(3 * static_cast<size_t>(lod.nrOfFaces));
+         for (uint32_t i = 0; i < lod.nrOfFaces; i++)
+         {
+            shortIndices[3 * i + 0] = static_cast<uint16_t>(f[i].a);
+            shortIndices[3 * i + 1] = static_cast<uint16_t>(f[i].b);
+            shortIndices[3 * i + 2] = static_cast<uint16_t>(f[i].c);
+         }
+         faces = shortIndices.data();
+      }
+      glNamedBufferSubData(reserved->vbo.getOglHandle(), reserved->lods[c].firstVertex * sizeof(Eng::Vbo::VertexData), vertexBytes, vertices);
+      glNamedBufferSubData(reserved->ebo.getOglHandle(), reserved->lods[c].firstFace * 3 * indexSize, lod.nrOfFaces * 3 * indexSize, faces);
+   }
+
+   // Release staging:
+   reserved->staged.clear();
+   reserved->staged.shrink_to_fit();
+   reserved->stagingCopy.clear();
+   reserved->stagingCopy.shrink_to_fit();
+   reserved->stagingFile.reset();
+
+   // Done:
+   return true;
 }
 
 
@@ -272,6 +617,10 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer& serial, void* data)
  */
 bool ENG_API Eng::Mesh::render(uint32_t value, void* data) const
 {
+   // Not uploaded yet?
+   if (materialize() == false)
+      return true;
+
    Eng::Program& program = dynamic_cast<Eng::Program&>(Eng::Program::getCached());
 
    Eng::List::RenderableElemInfo* info = (Eng::List::RenderableElemInfo*)data;
@@ -280,10 +629,14 @@ bool ENG_API Eng::Mesh::render(uint32_t value, void* data) const
    program.setMat4("viewMat", info->camMatrix);
    program.setMat3("normalMat", glm::inverseTranspose(glm::mat3(info->objMatrix)));
 
-   reserved->material.get().render();
+   getMaterial().render();
 
+   // Level of detail selected by the list:
+   const Eng::Mesh::Lod &lod = getLod(info->lod);
    reserved->vao.render();
-   glDrawElements(GL_TRIANGLES, reserved->ebo.getNrOfFaces() * 3, GL_UNSIGNED_INT, nullptr);
+   const uint32_t indexSize = reserved->ebo.getIndexSize();
+   glDrawElementsBaseVertex(GL_TRIANGLES, lod.nrOfFaces * 3, reserved->ebo.getOglIndexType(),
+                            reinterpret_cast<void *>(static_cast<uintptr_t>(lod.firstFace * 3 * indexSize)), lod.firstVertex);
 
    // Done:
    return true;
@@ -9,7 +9,8 @@
 
 
  /**
-  * @brief Class for modeling a geometric mesh.
+  * @brief Class for modeling a geometric mesh. All the levels of detail share the same VBO and EBO, one range each
+  *        (finest first); the one drawn is selected by List::render().
   */
 class ENG_API Mesh : public Eng::Node
 {
@@ -21,6 +22,19 @@ public: //
    static Mesh empty;
 
 
+   /**
+    * @brief Range of a level of detail within the mesh buffers.
+    */
+   struct Lod
+   {
+      uint32_t firstVertex;                     ///< First vertex in the VBO (added to the indices of this LOD)
+      uint32_t nrOfVertices;                    ///< Number of vertices
+      uint32_t firstFace;                       ///< First face in the EBO
+      uint32_t nrOfFaces;                       ///< Number of faces
+      float error;                              ///< Error w.r.t. the finest LOD (mesh units, 0 when authored)
+   };
+
+
    // Const/dest:
    Mesh();
    Mesh(Mesh&& other);
@@ -35,13 +49,19 @@ public: //
    const Eng::Material& getMaterial() const;
    const Eng::Vbo& getVbo() const;
    const Eng::Ebo& getEbo() const;
+   void setBounds(const glm::vec3 &center, float radius);
    const float getRadius() const;
+   const glm::vec3 &getCenter() const;
+   uint32_t getNrOfLods() const;
+   const Eng::Mesh::Lod &getLod(uint32_t lod) const;
 
    // Rendering methods:   
    bool render(uint32_t value = 0, void* data = nullptr) const;
 
    // Ovo:   
    uint32_t loadChunk(Eng::Serializer& serial, void* data = nullptr);
+   bool stage(uint32_t nrOfVertices, const void* vertices, uint32_t nrOfFaces, const void* faces, std::shared_ptr<const Eng::MappedFile> file = nullptr, float error = 0.0f);
+   bool upload();
 
 
    ///////////
@@ -54,6 +74,10 @@ private: //
 
    // Const/dest:
    Mesh(const std::string& name);
+
+   // Internal:
+   bool loadLods(Eng::Serializer& serial);
+   bool materialize() const;
 };
 
 
@@ -0,0 +1,656 @@
+/**
+ * @file		engine_mesh_codec.cpp
+ * @brief	Compressed geometry encoding
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <cmath>
+
+   // SIMD (SSE2 is part of the x64 baseline):
+   #if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+      #include <emmintrin.h>
+      #define ENG_MESH_CODEC_SSE
+   #endif
+
+
+
+////////////
+// STATIC //
+////////////
+
+/**
+ * Stream header: quantization grid of the positions.
+ */
+struct StreamHeader
+{
+   glm::vec3 origin;                            ///< Position of the quantized value 0
+   glm::vec3 step;                              ///< Size of a quantization step along each axis
+};
+
+
+/**
+ * Gets the bit width code of a group of values (0 = 0 bits, 1 = 2 bits, 2 = 4 bits, 3 = 8 bits).
+ * @param values group of values
+ * @return width code
+ */
+static inline uint32_t getWidthCode(const uint8_t *values)
+{
+   uint8_t any = 0;
+   for (uint32_t c = 0; c < Eng::MeshCodec::groupSize; c++)
+      any |= values[c];
+   if (any == 0)
+      return 0;
+   if (any < 4)
+      return 1;
+   if (any < 16)
+      return 2;
+   return 3;
+}
+
+
+/**
+ * Gets the size of a packed group.
+ * @param code width code
+ * @return size in bytes
+ */
+static inline uint32_t getGroupSize(uint32_t code)
+{
+   static const uint32_t size[] = { 0, Eng::MeshCodec::groupSize / 4, Eng::MeshCodec::groupSize / 2, Eng::MeshCodec::groupSize };
+   return size[code];
+}
+
+
+/**
+ * Appends the values of one byte lane of a block: a header with the width codes of the groups (2 bits each), then
+ * the packed groups.
+ * @param values zigzag-encoded deltas
+ * @param count number of values
+ * @param out output stream
+ */
+static void encodeLane(const uint8_t *values, uint32_t count, std::vector<uint8_t> &out)
+{
+   const uint32_t nrOfGroups = (count + Eng::MeshCodec::groupSize - 1) / Eng::MeshCodec::groupSize;
+   const size_t header = out.size();
+   out.resize(out.size() + (nrOfGroups + 3) / 4, 0);
+
+   for (uint32_t g = 0; g < nrOfGroups; g++)
+   {
+      // Last group is padded with zeros:
+      uint8_t v[Eng::MeshCodec::groupSize] = { 0 };
+      memcpy(v, values + g * Eng::MeshCodec::groupSize, std::min(Eng::MeshCodec::groupSize, count - g * Eng::MeshCodec::groupSize));
+
+      const uint32_t code = getWidthCode(v);
+      out[header + g / 4] |= static_cast<uint8_t>(code << ((g % 4) * 2));
+      switch (code)
+      {
+         case 1:
+            for (uint32_t c = 0; c < Eng::MeshCodec::groupSize; c += 4)
+               out.push_back(static_cast<uint8_t>(v[c] | (v[c + 1] << 2) | (v[c + 2] << 4) | (v[c + 3] << 6)));
+            break;
+
+         case 2:
+            for (uint32_t c = 0; c < Eng::MeshCodec::groupSize; c += 2)
+               out.push_back(static_cast<uint8_t>(v[c] | (v[c + 1] << 4)));
+            break;
+
+         case 3:
+            out.insert(out.end(), v, v + Eng::MeshCodec::groupSize);
+            break;
+
+         default:
+            break;
+      }
+   }
+}
+
+
+#ifndef ENG_MESH_CODEC_SSE
+/**
+ * @brief Lane decoding tables: each packed byte expanded into its values, already zigzag-decoded into deltas.
+ */
+struct LaneTables
+{
+   uint8_t unpack2[256][4];         ///< 4 values of 2 bits
+   uint8_t unpack4[256][2];         ///< 2 values of 4 bits
+   uint8_t unzigzag[256];           ///< 1 value of 8 bits
+
+
+   /**
+    * Constructor.
+    */
+   LaneTables()
+   {
+      auto decode = [](uint32_t value) { return static_cast<uint8_t>((value >> 1) ^ (0u - (value & 1u))); };
+      for (uint32_t c = 0; c < 256; c++)
+      {
+         for (uint32_t v = 0; v < 4; v++)
+            unpack2[c][v] = decode((c >> (v * 2)) & 3);
+         for (uint32_t v = 0; v < 2; v++)
+            unpack4[c][v] = decode((c >> (v * 4)) & 15);
+         unzigzag[c] = decode(c);
+      }
+   }
+};
+
+
+/**
+ * Returns the lane decoding tables (built on first use).
+ * @return tables
+ */
+static const LaneTables &getLaneTables()
+{
+   static const LaneTables tables;
+   return tables;
+}
+#endif
+
+
+/**
+ * Reads the values of one byte lane of a block (see encodeLane()) and rebuilds them from their deltas.
+ * @param data current position in the stream, moved past the lane
+ * @param end end of the stream
+ * @param values decoded values (room for a multiple of groupSize values)
+ * @param count number of values
+ * @param last last value of the previous block, updated
+ * @return TF (false if the stream is truncated)
+ */
+static inline bool decodeLane(const uint8_t *&data, const uint8_t *end, uint8_t *values, uint32_t count, uint8_t &last)
+{
+   const uint32_t nrOfGroups = (count + Eng::MeshCodec::groupSize - 1) / Eng::MeshCodec::groupSize;
+   const uint8_t *header = data;
+   data += (nrOfGroups + 3) / 4;
+   if (data > end)
+      return false;
+
+#ifdef ENG_MESH_CODEC_SSE
+   // One group at a time, rebuilt from its deltas with a prefix sum:
+   const __m128i mask1 = _mm_set1_epi8(1), mask2 = _mm_set1_epi8(3), mask4 = _mm_set1_epi8(15), mask7 = _mm_set1_epi8(127);
+   __m128i prev = _mm_set1_epi8(static_cast<char>(last));
+   for (uint32_t g = 0; g < nrOfGroups; g++)
+   {
+      const uint32_t code = (header[g / 4] >> ((g % 4) * 2)) & 3;
+      if (static_cast<uint64_t>(end - data) < getGroupSize(code))
+         return false;
+
+      __m128i v;
+      switch (code)
+      {
+         case 0:
+            v = _mm_setzero_si128();
+            break;
+
+         case 1:
+         {
+            int32_t packed;
+            memcpy(&packed, data, sizeof(int32_t));
+            const __m128i x = _mm_cvtsi32_si128(packed);
+            const __m128i lo = _mm_unpacklo_epi8(_mm_and_si128(x, mask2), _mm_and_si128(_mm_srli_epi16(x, 2), mask2));
+            const __m128i hi = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(x, 4), mask2), _mm_and_si128(_mm_srli_epi16(x, 6), mask2));
+            v = _mm_unpacklo_epi16(lo, hi);
+            break;
+         }
+
+         case 2:
+         {
+            const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(data));
+            v = _mm_unpacklo_epi8(_mm_and_si128(x, mask4), _mm_and_si128(_mm_srli_epi16(x, 4), mask4));
+            break;
+         }
+
+         default:
+            v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+      }
+      data += getGroupSize(code);
+
+      // Zigzag, then running sum:
+      v = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(v, 1), mask7), _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(v, mask1)));
+      v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+      v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+      v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+      v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+      v = _mm_add_epi8(v, prev);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(values + g * Eng::MeshCodec::groupSize), v);
+
+      // Last value, broadcast:
+      prev = _mm_unpackhi_epi8(v, v);
+      prev = _mm_unpackhi_epi16(prev, prev);
+      prev = _mm_shuffle_epi32(prev, 0xFF);
+   }
+   last = values[count - 1];
+#else
+   // Deltas:
+   const LaneTables &tables = getLaneTables();
+   for (uint32_t g = 0; g < nrOfGroups; g++)
+   {
+      const uint32_t code = (header[g / 4] >> ((g % 4) * 2)) & 3;
+      if (static_cast<uint64_t>(end - data) < getGroupSize(code))
+         return false;
+
+      uint8_t *v = values + g * Eng::MeshCodec::groupSize;
+      switch (code)
+      {
+         case 0:
+            memset(v, 0, Eng::MeshCodec::groupSize);
+            break;
+
+         case 1:
+            for (uint32_t c = 0; c < Eng::MeshCodec::groupSize; c += 4)
+               memcpy(v + c, tables.unpack2[*data++], 4);
+            break;
+
+         case 2:
+            for (uint32_t c = 0; c < Eng::MeshCodec::groupSize; c += 2)
+               memcpy(v + c, tables.unpack4[*data++], 2);
+            break;
+
+         default:
+            for (uint32_t c = 0; c < Eng::MeshCodec::groupSize; c++)
+               v[c] = tables.unzigzag[data[c]];
+            data += Eng::MeshCodec::groupSize;
+      }
+   }
+
+   // Values:
+   uint32_t value = last;
+   for (uint32_t v = 0; v < count; v++)
+   {
+      value += values[v];
+      values[v] = static_cast<uint8_t>(value);
+   }
+   last = static_cast<uint8_t>(value);
+#endif
+
+   // Done:
+   return true;
+}
+
+
+/**
+ * @brief Index stream state, mirrored by the encoder and the decoder: FIFOs of the last edges and vertices seen, the
+ *        next vertex never referenced so far and the last index stored explicitly.
+ */
+struct IndexState
+{
+   uint32_t edges[16][2] = {};      ///< Edges of the last faces, in reverse winding (as seen from the adjacent face)
+   uint32_t vertices[16] = {};      ///< Last vertices not taken from this FIFO
+   uint32_t edgeHead = 0;           ///< Next edge slot
+   uint32_t vertexHead = 0;         ///< Next vertex slot
+   uint32_t next = 0;               ///< Next new vertex (optimized meshes reference vertices in order)
+   uint32_t last = 0;               ///< Last explicit index
+
+
+   /**
+    * Adds an edge to the FIFO.
+    * @param a first vertex
+    * @param b second vertex
+    */
+   inline void pushEdge(uint32_t a, uint32_t b)
+   {
+      edges[edgeHead & 15][0] = a;
+      edges[edgeHead & 15][1] = b;
+      edgeHead++;
+   }
+};
+
+
+/**
+ * Gets the code of an index and updates the state (0 = next new vertex, 1 to 14 = vertex FIFO entry, 15 = explicit).
+ * @param state stream state
+ * @param index vertex index
+ * @param out output stream, receiving the difference from the last explicit index when needed
+ * @return code
+ */
+static inline uint32_t encodeIndex(IndexState &state, uint32_t index, std::vector<uint8_t> &out)
+{
+   uint32_t code = 15;
+   if (index == state.next)
+   {
+      code = 0;
+      state.next++;
+   }
+   else
+      for (uint32_t c = 1; c < 15; c++)
+         if (state.vertices[(state.vertexHead - c) & 15] == index)
+            return c;
+
+   if (code == 15)
+   {
+      const int32_t delta = static_cast<int32_t>(index - state.last);
+      uint32_t value = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+      while (value >= 0x80)
+      {
+         out.push_back(static_cast<uint8_t>(value | 0x80));
+         value >>= 7;
+      }
+      out.push_back(static_cast<uint8_t>(value));
+      state.last = index;
+   }
+   state.vertices[state.vertexHead++ & 15] = index;
+   return code;
+}
+
+
+/**
+ * Gets the index of a code and updates the state (see encodeIndex()).
+ * @param state stream state
+ * @param code index code
+ * @param data current position in the stream, moved past the explicit index when needed
+ * @param end end of the stream
+ * @param index vertex index
+ * @return TF (false if the stream is truncated)
+ */
+static inline bool decodeIndex(IndexState &state, uint32_t code, const uint8_t *&data, const uint8_t *end, uint32_t &index)
+{
+   if (code == 0)
+      index = state.next++;
+   else if (code < 15)
+   {
+      index = state.vertices[(state.vertexHead - code) & 15];
+      return true;
+   }
+   else
+   {
+      uint32_t value = 0;
+      uint32_t shift = 0;
+      uint8_t byte;
+      do
+      {
+         if (data == end || shift > 28)
+            return false;
+         byte = *data++;
+         value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+         shift += 7;
+      } while (byte & 0x80);
+      index = state.last += (value >> 1) ^ (0u - (value & 1u));
+   }
+   state.vertices[state.vertexHead++ & 15] = index;
+   return true;
+}
+
+
+
+/////////////////////////////
+// BODY OF CLASS MeshCodec //
+/////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Encodes vertices. Positions are quantized to 16 bits within their bounding box.
+ * @param vertices vertices
+ * @param nrOfVertices number of vertices
+ * @param out encoded stream (replaced)
+ * @return TF
+ */
+bool ENG_API Eng::MeshCodec::encodeVertices(const Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices, std::vector<uint8_t> &out)
+{
+   // Safety net:
+   if (vertices == nullptr && nrOfVertices)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Quantization grid:
+   StreamHeader header;
+   glm::vec3 bboxMin(0.0f), bboxMax(0.0f);
+   for (uint32_t v = 0; v < nrOfVertices; v++)
+   {
+      bboxMin = v ? glm::min(bboxMin, vertices[v].vertex) : vertices[v].vertex;
+      bboxMax = v ? glm::max(bboxMax, vertices[v].vertex) : vertices[v].vertex;
+   }
+   header.origin = bboxMin;
+   header.step = (bboxMax - bboxMin) / 65535.0f;
+
+   out.clear();
+   out.reserve(sizeof(StreamHeader) + nrOfVertices * vertexStride / 2);
+   out.insert(out.end(), reinterpret_cast<const uint8_t *>(&header), reinterpret_cast<const uint8_t *>(&header) + sizeof(StreamHeader));
+
+   // Blocks:
+   uint8_t record[blockSize * vertexStride];
+   uint8_t lane[blockSize];
+   uint8_t last[vertexStride] = { 0 };
+   for (uint32_t first = 0; first < nrOfVertices; first += blockSize)
+   {
+      const uint32_t count = std::min(blockSize, nrOfVertices - first);
+      for (uint32_t v = 0; v < count; v++)
+      {
+         const Eng::Vbo::VertexData &src = vertices[first + v];
+         uint8_t *dst = record + v * vertexStride;
+         for (uint32_t axis = 0; axis < 3; axis++)
+         {
+            const float q = header.step[axis] > 0.0f ? std::round((src.vertex[axis] - header.origin[axis]) / header.step[axis]) : 0.0f;
+            const uint16_t value = static_cast<uint16_t>(std::clamp(q, 0.0f, 65535.0f));
+            memcpy(dst + axis * sizeof(uint16_t), &value, sizeof(uint16_t));
+         }
+         memcpy(dst + 6, &src.normal, sizeof(uint32_t));
+         memcpy(dst + 10, &src.uv, sizeof(uint32_t));
+         memcpy(dst + 14, &src.tangent, sizeof(uint32_t));
+      }
+
+      // Byte lanes, delta-coded against the previous vertex:
+      for (uint32_t k = 0; k < vertexStride; k++)
+      {
+         for (uint32_t v = 0; v < count; v++)
+         {
+            const uint8_t value = record[v * vertexStride + k];
+            const uint8_t delta = static_cast<uint8_t>(value - last[k]);
+            lane[v] = static_cast<uint8_t>((delta << 1) ^ static_cast<uint8_t>(static_cast<int8_t>(delta) >> 7));
+            last[k] = value;
+         }
+         encodeLane(lane, count, out);
+      }
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Decodes vertices encoded with encodeVertices().
+ * @param data encoded stream
+ * @param nrOfBytes size of the encoded stream
+ * @param vertices output vertices
+ * @param nrOfVertices number of vertices
+ * @return TF
+ */
+bool ENG_API Eng::MeshCodec::decodeVertices(const uint8_t *data, uint64_t nrOfBytes, Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices)
+{
+   // Safety net:
+   if (data == nullptr || nrOfBytes < sizeof(StreamHeader) || (vertices == nullptr && nrOfVertices))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   StreamHeader header;
+   memcpy(&header, data, sizeof(StreamHeader));
+   const uint8_t *cur = data + sizeof(StreamHeader);
+   const uint8_t *end = data + nrOfBytes;
+
+   // Blocks, decoded one byte lane at a time:
+   uint8_t lane[vertexStride][blockSize];
+   uint8_t last[vertexStride] = { 0 };
+   for (uint32_t first = 0; first < nrOfVertices; first += blockSize)
+   {
+      const uint32_t count = std::min(blockSize, nrOfVertices - first);
+      for (uint32_t k = 0; k < vertexStride; k++)
+         if (decodeLane(cur, end, lane[k], count, last[k]) == false)
+         {
+            ENG_LOG_ERROR("Corrupted vertex stream");
+            return false;
+         }
+
+      for (uint32_t v = 0; v < count; v++)
+      {
+         Eng::Vbo::VertexData &dst = vertices[first + v];
+         const uint32_t qx = lane[0][v] | (lane[1][v] << 8);
+         const uint32_t qy = lane[2][v] | (lane[3][v] << 8);
+         const uint32_t qz = lane[4][v] | (lane[5][v] << 8);
+         dst.vertex = header.origin + glm::vec3(static_cast<float>(qx), static_cast<float>(qy), static_cast<float>(qz)) * header.step;
+         dst.normal = lane[6][v] | (lane[7][v] << 8) | (lane[8][v] << 16) | (static_cast<uint32_t>(lane[9][v]) << 24);
+         dst.uv = lane[10][v] | (lane[11][v] << 8) | (lane[12][v] << 16) | (static_cast<uint32_t>(lane[13][v]) << 24);
+         dst.tangent = lane[14][v] | (lane[15][v] << 8) | (lane[16][v] << 16) | (static_cast<uint32_t>(lane[17][v]) << 24);
+      }
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Encodes faces. Each face takes a code byte, whose high nibble is the entry of the edge FIFO holding the edge it shares
+ * with a recent face (15 if none) and whose low nibble codes the remaining vertex (see encodeIndex()). Faces without a
+ * shared edge take a second byte for the codes of their other two vertices. Explicit indices follow as variable-length
+ * differences. Faces may be rotated (their winding is kept). On meshes ordered by the MeshOptimizer, most faces take a
+ * single byte.
+ * @param faces faces
+ * @param nrOfFaces number of faces
+ * @param out encoded stream (replaced)
+ * @return TF
+ */
+bool ENG_API Eng::MeshCodec::encodeFaces(const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces, std::vector<uint8_t> &out)
+{
+   // Safety net:
+   if (faces == nullptr && nrOfFaces)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   out.clear();
+   out.reserve(1 + nrOfFaces * 2);
+   out.push_back(faceFormat);
+
+   IndexState state;
+   std::vector<uint8_t> explicitIndices;
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+   {
+      const uint32_t index[3] = { faces[f].a, faces[f].b, faces[f].c };
+
+      // Most recent shared edge, over the 3 rotations of the face:
+      uint32_t edge = 15, rotation = 0;
+      for (uint32_t e = 0; e < 15 && edge == 15; e++)
+      {
+         const uint32_t *entry = state.edges[(state.edgeHead - 1 - e) & 15];
+         for (uint32_t r = 0; r < 3; r++)
+            if (entry[0] == index[r] && entry[1] == index[(r + 1) % 3])
+            {
+               edge = e;
+               rotation = r;
+               break;
+            }
+      }
+
+      const uint32_t a = index[rotation], b = index[(rotation + 1) % 3], c = index[(rotation + 2) % 3];
+      explicitIndices.clear();
+      if (edge < 15)
+      {
+         out.push_back(static_cast<uint8_t>((edge << 4) | encodeIndex(state, c, explicitIndices)));
+         state.pushEdge(c, b);
+         state.pushEdge(a, c);
+      }
+      else
+      {
+         const uint32_t codeA = encodeIndex(state, a, explicitIndices);
+         const uint32_t codeB = encodeIndex(state, b, explicitIndices);
+         const uint32_t codeC = encodeIndex(state, c, explicitIndices);
+         out.push_back(static_cast<uint8_t>(0xF0 | codeA));
+         out.push_back(static_cast<uint8_t>((codeB << 4) | codeC));
+         state.pushEdge(b, a);
+         state.pushEdge(c, b);
+         state.pushEdge(a, c);
+      }
+      out.insert(out.end(), explicitIndices.begin(), explicitIndices.end());
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Decodes faces encoded with encodeFaces().
+ * @param data encoded stream
+ * @param nrOfBytes size of the encoded stream
+ * @param faces output faces
+ * @param nrOfFaces number of faces
+ * @return TF
+ */
+bool ENG_API Eng::MeshCodec::decodeFaces(const uint8_t *data, uint64_t nrOfBytes, Eng::Ebo::FaceData *faces, uint32_t nrOfFaces)
+{
+   // Safety net:
+   if (data == nullptr || nrOfBytes == 0 || (faces == nullptr && nrOfFaces))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (data[0] != faceFormat)
+   {
+      ENG_LOG_ERROR("Unsupported index stream format");
+      return false;
+   }
+
+   const uint8_t *cur = data + 1;
+   const uint8_t *end = data + nrOfBytes;
+   IndexState state;
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+   {
+      if (cur == end)
+      {
+         ENG_LOG_ERROR("Corrupted index stream");
+         return false;
+      }
+      const uint32_t code = *cur++;
+      const uint32_t edge = code >> 4;
+
+      uint32_t a, b, c;
+      bool valid;
+      if (edge < 15)
+      {
+         const uint32_t *entry = state.edges[(state.edgeHead - 1 - edge) & 15];
+         a = entry[0];
+         b = entry[1];
+         valid = decodeIndex(state, code & 15, cur, end, c);
+         state.pushEdge(c, b);
+         state.pushEdge(a, c);
+      }
+      else
+      {
+         valid = cur != end;
+         const uint32_t codes = valid ? *cur++ : 0;
+         valid = valid && decodeIndex(state, code & 15, cur, end, a) && decodeIndex(state, codes >> 4, cur, end, b) &&
+                 decodeIndex(state, codes & 15, cur, end, c);
+         state.pushEdge(b, a);
+         state.pushEdge(c, b);
+         state.pushEdge(a, c);
+      }
+      if (valid == false)
+      {
+         ENG_LOG_ERROR("Corrupted index stream");
+         return false;
+      }
+      faces[f].a = a;
+      faces[f].b = b;
+      faces[f].c = c;
+   }
+
+   // Done:
+   return true;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file		engine_mesh_codec.h
+ * @brief	Compressed geometry encoding
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Byte-oriented vertex and index codec, used by the compressed OVO mesh chunks. Positions are quantized to
+ *        16 bits within the bounding box, packed normals, tangents and texture coordinates are kept as they are.
+ *        Vertices are encoded in blocks: each byte of the quantized vertex is delta-coded against the previous
+ *        vertex and stored with 0, 2, 4 or 8 bits per value, in groups of 16. Faces are coded against FIFOs of
+ *        the last edges and vertices seen, so that a face sharing an edge with a recent one usually takes a single
+ *        byte. Both streams decode without intermediate allocations.
+ */
+class ENG_API MeshCodec
+{
+//////////
+public: //
+//////////
+
+   // Consts:
+   static constexpr uint32_t vertexStride = 18;    ///< Size of a quantized vertex (bytes)
+   static constexpr uint32_t blockSize = 256;      ///< Number of vertices per encoded block
+   static constexpr uint32_t groupSize = 16;       ///< Number of values sharing the same bit width
+   static constexpr uint8_t faceFormat = 1;        ///< Revision of the face stream, stored in its first byte
+
+   // Vertices:
+   static bool encodeVertices(const Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices, std::vector<uint8_t> &out);
+   static bool decodeVertices(const uint8_t *data, uint64_t nrOfBytes, Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices);
+
+   // Faces:
+   static bool encodeFaces(const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces, std::vector<uint8_t> &out);
+   static bool decodeFaces(const uint8_t *data, uint64_t nrOfBytes, Eng::Ebo::FaceData *faces, uint32_t nrOfFaces);
+};
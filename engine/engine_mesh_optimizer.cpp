@@ -0,0 +1,786 @@
+/**
+ * @file		engine_mesh_optimizer.cpp
+ * @brief	Vertex cache, overdraw and vertex fetch optimization
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <cfloat>
+   #include <cmath>
+   #include <cstring>
+   #include <numeric>
+   #include <unordered_map>
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Special values:
+   static constexpr uint32_t noVertex = 0xFFFFFFFF;
+
+
+/**
+ * Whole vertex used to weld exact duplicates (bitwise comparison).
+ */
+struct VertexKey
+{
+   Eng::Vbo::VertexData data;
+
+   inline bool operator==(const VertexKey &other) const
+   {
+      return memcmp(&data, &other.data, sizeof(Eng::Vbo::VertexData)) == 0;
+   }
+};
+
+
+/**
+ * Hash of a VertexKey (FNV-1a over the 32-bit words).
+ */
+struct VertexKeyHash
+{
+   inline size_t operator()(const VertexKey &key) const
+   {
+      uint32_t words[sizeof(Eng::Vbo::VertexData) / sizeof(uint32_t)];
+      memcpy(words, &key.data, sizeof(words));
+      uint32_t hash = 2166136261u;
+      for (uint32_t word : words)
+         hash = (hash ^ word) * 16777619u;
+      return hash;
+   }
+};
+
+
+/**
+ * Post-transform vertex cache simulation (FIFO). A vertex is cached while fewer than cacheSize misses happened
+ * since it was last loaded.
+ */
+struct FifoCache
+{
+   std::vector<uint32_t> stamps;                ///< Miss counter when each vertex was loaded
+   uint32_t counter;                            ///< Number of misses so far, plus an offset
+   uint32_t size;                               ///< Number of entries
+
+
+   /**
+    * Constructor.
+    * @param nrOfVertices number of vertices
+    * @param cacheSize number of entries
+    */
+   FifoCache(uint32_t nrOfVertices, uint32_t cacheSize) : stamps(nrOfVertices, 0), counter{ cacheSize + 1 }, size{ cacheSize }
+   {}
+
+
+   /**
+    * Empties the cache.
+    */
+   inline void flush()
+   {
+      counter += size + 1;
+   }
+
+
+   /**
+    * Processes a face.
+    * @param face face
+    * @return number of misses (0 to 3)
+    */
+   inline uint32_t access(const Eng::Ebo::FaceData &face)
+   {
+      uint32_t misses = 0;
+      for (uint32_t v : { face.a, face.b, face.c })
+         if (counter - stamps[v] > size)
+         {
+            stamps[v] = counter++;
+            misses++;
+         }
+      return misses;
+   }
+};
+
+
+/**
+ * Checks that all the indices reference existing vertices.
+ * @param faces faces
+ * @param nrOfFaces number of faces
+ * @param nrOfVertices number of vertices
+ * @return TF
+ */
+static bool checkIndices(const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces, uint32_t nrOfVertices)
+{
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+      if (faces[f].a >= nrOfVertices || faces[f].b >= nrOfVertices || faces[f].c >= nrOfVertices)
+         return false;
+   return true;
+}
+
+
+/**
+ * Rasterizes a triangle into a depth buffer with a less-than depth test (pixel centers, top-left fill rule).
+ * @param p triangle in grid coordinates (x and y in pixels, z depth), counter-clockwise
+ * @param depth depth buffer (overdrawGridSize^2)
+ * @return number of pixels passing the depth test
+ */
+static uint64_t rasterize(const glm::vec3 p[3], std::vector<float> &depth)
+{
+   constexpr int32_t gridSize = static_cast<int32_t>(Eng::MeshOptimizer::overdrawGridSize);
+   const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+   if (area <= 0.0f)
+      return 0;
+
+   const int32_t minX = std::max(static_cast<int32_t>(std::floor(std::min({ p[0].x, p[1].x, p[2].x }))), 0);
+   const int32_t maxX = std::min(static_cast<int32_t>(std::ceil(std::max({ p[0].x, p[1].x, p[2].x }))), gridSize - 1);
+   const int32_t minY = std::max(static_cast<int32_t>(std::floor(std::min({ p[0].y, p[1].y, p[2].y }))), 0);
+   const int32_t maxY = std::min(static_cast<int32_t>(std::ceil(std::max({ p[0].y, p[1].y, p[2].y }))), gridSize - 1);
+
+   // Edge i goes from vertex i + 1 to vertex i + 2 (opposite to vertex i):
+   bool topLeft[3];
+   for (uint32_t e = 0; e < 3; e++)
+   {
+      const glm::vec3 &from = p[(e + 1) % 3], &to = p[(e + 2) % 3];
+      topLeft[e] = (to.y < from.y) || (to.y == from.y && to.x > from.x);
+   }
+
+   uint64_t shaded = 0;
+   for (int32_t y = minY; y <= maxY; y++)
+      for (int32_t x = minX; x <= maxX; x++)
+      {
+         const float px = x + 0.5f, py = y + 0.5f;
+         float w[3];
+         bool inside = true;
+         for (uint32_t e = 0; e < 3 && inside; e++)
+         {
+            const glm::vec3 &from = p[(e + 1) % 3], &to = p[(e + 2) % 3];
+            w[e] = (to.x - from.x) * (py - from.y) - (to.y - from.y) * (px - from.x);
+            inside = w[e] > 0.0f || (w[e] == 0.0f && topLeft[e]);
+         }
+         if (inside == false)
+            continue;
+
+         const float z = (w[0] * p[0].z + w[1] * p[1].z + w[2] * p[2].z) / area;
+         float &d = depth[y * gridSize + x];
+         if (z < d)
+         {
+            d = z;
+            shaded++;
+         }
+      }
+
+   // Done:
+   return shaded;
+}
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief MeshOptimizer reserved structure.
+ */
+struct Eng::MeshOptimizer::Reserved
+{
+   bool enabled;                                ///< Optimize meshes when saved or cooked
+   bool enabledOnLoad;                          ///< Also optimize meshes when loaded
+   uint32_t cacheSize;                          ///< Simulated FIFO cache size
+   float overdrawThreshold;                     ///< Max ACMR increase accepted to reduce overdraw
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : enabled{ true }, enabledOnLoad{ false }, cacheSize{ Eng::MeshOptimizer::dfltCacheSize }, overdrawThreshold{ Eng::MeshOptimizer::dfltOverdrawThreshold }
+   {}
+};
+
+
+
+/////////////////////////////////
+// BODY OF CLASS MeshOptimizer //
+/////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::MeshOptimizer::MeshOptimizer() : reserved(std::make_unique<Eng::MeshOptimizer::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::MeshOptimizer::~MeshOptimizer()
+{
+   ENG_LOG_DEBUG("[-]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::MeshOptimizer ENG_API &Eng::MeshOptimizer::getInstance()
+{
+   static MeshOptimizer instance;
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Enables or disables the optimization of meshes when saved or cooked.
+ * @param enabled enabled flag
+ */
+void ENG_API Eng::MeshOptimizer::setEnabled(bool enabled)
+{
+   reserved->enabled = enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether meshes are optimized when saved or cooked.
+ * @return TF
+ */
+bool ENG_API Eng::MeshOptimizer::isEnabled() const
+{
+   return reserved->enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Enables or disables the optimization of meshes when loaded (disabled by default). Meant for OVO files not written by
+ * Ovo::save(): it copies every LOD to the heap (no zero-copy staging) and slows down loading. Set before loading.
+ * @param enabled enabled flag
+ */
+void ENG_API Eng::MeshOptimizer::setEnabledOnLoad(bool enabled)
+{
+   reserved->enabledOnLoad = enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether meshes are optimized when loaded.
+ * @return TF
+ */
+bool ENG_API Eng::MeshOptimizer::isEnabledOnLoad() const
+{
+   return reserved->enabledOnLoad;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the size of the simulated post-transform cache. Tipsify is not very sensitive to it: values between 12 and 24
+ * suit most GPUs.
+ * @param cacheSize number of cached vertices (at least 3)
+ */
+void ENG_API Eng::MeshOptimizer::setCacheSize(uint32_t cacheSize)
+{
+   reserved->cacheSize = std::max(cacheSize, 3u);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the size of the simulated post-transform cache.
+ * @return number of cached vertices
+ */
+uint32_t ENG_API Eng::MeshOptimizer::getCacheSize() const
+{
+   return reserved->cacheSize;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets how much the ACMR of a cluster may exceed the one of its whole fan sequence when splitting it into smaller
+ * clusters for the overdraw sort. Higher values give more clusters (less overdraw, more cache misses).
+ * @param threshold ratio (1 = only split where the ACMR does not get worse)
+ */
+void ENG_API Eng::MeshOptimizer::setOverdrawThreshold(float threshold)
+{
+   reserved->overdrawThreshold = std::max(threshold, 1.0f);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the overdraw threshold.
+ * @return ratio
+ */
+float ENG_API Eng::MeshOptimizer::getOverdrawThreshold() const
+{
+   return reserved->overdrawThreshold;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Runs all the steps on a mesh: welding, vertex cache, overdraw and vertex fetch optimization.
+ * @param vertices vertices (replaced)
+ * @param faces faces (replaced)
+ * @param stats when not nullptr, filled with the figures before and after (measuring overdraw is not free)
+ * @return TF
+ */
+bool ENG_API Eng::MeshOptimizer::optimize(std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces, Stats *stats) const
+{
+   // Safety net:
+   if (checkIndices(faces.data(), static_cast<uint32_t>(faces.size()), static_cast<uint32_t>(vertices.size())) == false)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   if (stats)
+   {
+      stats->nrOfVerticesBefore = static_cast<uint32_t>(vertices.size());
+      stats->acmrBefore = computeAcmr(faces.data(), static_cast<uint32_t>(faces.size()), static_cast<uint32_t>(vertices.size()), reserved->cacheSize);
+      stats->overdrawBefore = computeOverdraw(vertices.data(), faces.data(), static_cast<uint32_t>(faces.size()));
+   }
+
+   std::vector<uint32_t> clusters;
+   if (weld(vertices, faces) == false ||
+       optimizeVertexCache(faces, static_cast<uint32_t>(vertices.size()), reserved->cacheSize, &clusters) == false ||
+       optimizeOverdraw(vertices, faces, clusters, reserved->cacheSize, reserved->overdrawThreshold) == false ||
+       optimizeVertexFetch(vertices, faces) == false)
+      return false;
+
+   if (stats)
+   {
+      stats->nrOfVerticesAfter = static_cast<uint32_t>(vertices.size());
+      stats->acmrAfter = computeAcmr(faces.data(), static_cast<uint32_t>(faces.size()), static_cast<uint32_t>(vertices.size()), reserved->cacheSize);
+      stats->overdrawAfter = computeOverdraw(vertices.data(), faces.data(), static_cast<uint32_t>(faces.size()));
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Merges vertices with identical data (position and all attributes). Unreferenced vertices are kept.
+ * @param vertices vertices (replaced)
+ * @param faces faces (remapped)
+ * @return TF
+ */
+bool ENG_API Eng::MeshOptimizer::weld(std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces)
+{
+   // Safety net:
+   if (checkIndices(faces.data(), static_cast<uint32_t>(faces.size()), static_cast<uint32_t>(vertices.size())) == false)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   std::vector<uint32_t> remap(vertices.size());
+   std::unordered_map<VertexKey, uint32_t, VertexKeyHash> unique;
+   unique.reserve(vertices.size());
+   uint32_t nrOfUnique = 0;
+   for (uint32_t v = 0; v < vertices.size(); v++)
+   {
+      const auto it = unique.emplace(VertexKey{ vertices[v] }, nrOfUnique);
+      if (it.second)
+         vertices[nrOfUnique++] = vertices[v];
+      remap[v] = it.first->second;
+   }
+   if (nrOfUnique == vertices.size())
+      return true;
+
+   vertices.resize(nrOfUnique);
+   for (Eng::Ebo::FaceData &face : faces)
+   {
+      face.a = remap[face.a];
+      face.b = remap[face.b];
+      face.c = remap[face.c];
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reorders the faces for the post-transform vertex cache with Tipsify: faces are emitted as fans around a vertex,
+ * the next one being picked among the vertices of the last fan that will still be cached once fanned. When the
+ * candidates are exhausted, the walk restarts from a recently used vertex (or the next unprocessed one) and a new
+ * cluster begins.
+ * @param faces faces (reordered)
+ * @param nrOfVertices number of vertices
+ * @param cacheSize simulated cache size
+ * @param clusters when not nullptr, filled with the first face of each cluster (for optimizeOverdraw())
+ * @return TF
+ */
+bool ENG_API Eng::MeshOptimizer::optimizeVertexCache(std::vector<Eng::Ebo::FaceData> &faces, uint32_t nrOfVertices, uint32_t cacheSize,
+                                                     std::vector<uint32_t> *clusters)
+{
+   // Safety net:
+   if (cacheSize < 3 || checkIndices(faces.data(), static_cast<uint32_t>(faces.size()), nrOfVertices) == false)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (clusters)
+      clusters->clear();
+   if (faces.empty())
+      return true;
+
+   // Vertex to faces adjacency:
+   const uint32_t nrOfFaces = static_cast<uint32_t>(faces.size());
+   std::vector<uint32_t> live(nrOfVertices, 0);
+   for (const Eng::Ebo::FaceData &face : faces)
+   {
+      live[face.a]++;
+      live[face.b]++;
+      live[face.c]++;
+   }
+   std::vector<uint32_t> offsets(nrOfVertices + 1, 0);
+   for (uint32_t v = 0; v < nrOfVertices; v++)
+      offsets[v + 1] = offsets[v] + live[v];
+   std::vector<uint32_t> adjacency(offsets.back());
+   std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+   {
+      adjacency[fill[faces[f].a]++] = f;
+      adjacency[fill[faces[f].b]++] = f;
+      adjacency[fill[faces[f].c]++] = f;
+   }
+
+   // Fans:
+   std::vector<Eng::Ebo::FaceData> out;
+   out.reserve(nrOfFaces);
+   std::vector<uint8_t> emitted(nrOfFaces, 0);
+   std::vector<uint32_t> cacheTime(nrOfVertices, 0);
+   std::vector<uint32_t> deadEnd;
+   deadEnd.reserve(3 * static_cast<size_t>(nrOfFaces));
+   std::vector<uint32_t> candidates;
+   uint32_t timestamp = cacheSize + 1;
+   uint32_t cursor = 0;
+   while (live[cursor] == 0)
+      cursor++;
+
+   uint32_t fanned = cursor;
+   if (clusters)
+      clusters->push_back(0);
+   while (fanned != noVertex)
+   {
+      candidates.clear();
+      for (uint32_t i = offsets[fanned]; i < offsets[fanned + 1]; i++)
+      {
+         const uint32_t f = adjacency[i];
+         if (emitted[f])
+            continue;
+         emitted[f] = 1;
+         out.push_back(faces[f]);
+         for (uint32_t v : { faces[f].a, faces[f].b, faces[f].c })
+         {
+            deadEnd.push_back(v);
+            candidates.push_back(v);
+            live[v]--;
+            if (timestamp - cacheTime[v] > cacheSize)
+               cacheTime[v] = timestamp++;
+         }
+      }
+
+      // Next vertex: the oldest candidate still cached after its fan, or any candidate with faces left:
+      fanned = noVertex;
+      int64_t bestPriority = -1;
+      for (uint32_t v : candidates)
+         if (live[v])
+         {
+            int64_t priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize)
+               priority = timestamp - cacheTime[v];
+            if (priority > bestPriority)
+            {
+               bestPriority = priority;
+               fanned = v;
+            }
+         }
+
+      // Dead end:
+      if (fanned == noVertex)
+      {
+         while (deadEnd.empty() == false && fanned == noVertex)
+         {
+            const uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v])
+               fanned = v;
+         }
+         while (fanned == noVertex && cursor < nrOfVertices)
+         {
+            if (live[cursor])
+               fanned = cursor;
+            cursor++;
+         }
+         if (fanned != noVertex && clusters)
+            clusters->push_back(static_cast<uint32_t>(out.size()));
+      }
+   }
+   faces.swap(out);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sorts clusters of faces to reduce overdraw from any point of view. The clusters produced by
+ * optimizeVertexCache() are first split where the ACMR allows it, then sorted so that the ones facing away from the
+ * center of the mesh (likely occluders) come first. The order within a cluster is kept.
+ * @param vertices vertices
+ * @param faces faces, as reordered by optimizeVertexCache() (reordered)
+ * @param clusters first face of each cluster, as returned by optimizeVertexCache()
+ * @param cacheSize simulated cache size
+ * @param threshold max ACMR increase accepted w.r.t. the original cluster
+ * @return TF
+ */
+bool ENG_API Eng::MeshOptimizer::optimizeOverdraw(const std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces,
+                                                  const std::vector<uint32_t> &clusters, uint32_t cacheSize, float threshold)
+{
+   // Safety net:
+   const uint32_t nrOfFaces = static_cast<uint32_t>(faces.size());
+   const uint32_t nrOfVertices = static_cast<uint32_t>(vertices.size());
+   if (cacheSize < 3 || checkIndices(faces.data(), nrOfFaces, nrOfVertices) == false ||
+       (clusters.empty() == false && (clusters[0] != 0 || clusters.back() >= nrOfFaces)))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (clusters.size() == 0 || nrOfFaces == 0)
+      return true;
+
+   // Split clusters where the running ACMR drops below the threshold:
+   std::vector<uint32_t> split;
+   FifoCache cache(nrOfVertices, cacheSize);
+   for (uint32_t c = 0; c < clusters.size(); c++)
+   {
+      const uint32_t first = clusters[c];
+      const uint32_t last = (c + 1 < clusters.size()) ? clusters[c + 1] : nrOfFaces;
+
+      cache.flush();
+      uint32_t misses = 0;
+      for (uint32_t f = first; f < last; f++)
+         misses += cache.access(faces[f]);
+      const float limit = threshold * static_cast<float>(misses) / static_cast<float>(last - first);
+
+      cache.flush();
+      split.push_back(first);
+      uint32_t start = first;
+      misses = 0;
+      for (uint32_t f = first; f < last; f++)
+      {
+         misses += cache.access(faces[f]);
+         if (f + 1 < last && static_cast<float>(misses) / static_cast<float>(f + 1 - start) <= limit)
+         {
+            split.push_back(f + 1);
+            start = f + 1;
+            misses = 0;
+            cache.flush();
+         }
+      }
+   }
+
+   // Area-weighted centroid and normal of each cluster:
+   struct Cluster
+   {
+      glm::dvec3 centroid;
+      glm::dvec3 normal;
+      double area;
+      float sortKey;
+      uint32_t first, last;
+   };
+   std::vector<Cluster> all(split.size());
+   glm::dvec3 meshCentroid(0.0);
+   double meshArea = 0.0;
+   for (uint32_t c = 0; c < split.size(); c++)
+   {
+      Cluster &cluster = all[c];
+      cluster.centroid = cluster.normal = glm::dvec3(0.0);
+      cluster.area = 0.0;
+      cluster.first = split[c];
+      cluster.last = (c + 1 < split.size()) ? split[c + 1] : nrOfFaces;
+      for (uint32_t f = cluster.first; f < cluster.last; f++)
+      {
+         const glm::dvec3 p0 = vertices[faces[f].a].vertex, p1 = vertices[faces[f].b].vertex, p2 = vertices[faces[f].c].vertex;
+         const glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+         const double area = glm::length(n);
+         cluster.centroid += (p0 + p1 + p2) * (area / 3.0);
+         cluster.normal += n;
+         cluster.area += area;
+      }
+      meshCentroid += cluster.centroid;
+      meshArea += cluster.area;
+      if (cluster.area > 0.0)
+         cluster.centroid /= cluster.area;
+   }
+   if (meshArea > 0.0)
+      meshCentroid /= meshArea;
+
+   for (Cluster &cluster : all)
+   {
+      const double length = glm::length(cluster.normal);
+      cluster.sortKey = (length > 0.0) ? static_cast<float>(glm::dot(cluster.centroid - meshCentroid, cluster.normal / length)) : -FLT_MAX;
+   }
+   std::stable_sort(all.begin(), all.end(), [](const Cluster &a, const Cluster &b)
+      {
+         return a.sortKey > b.sortKey;
+      });
+
+   std::vector<Eng::Ebo::FaceData> out;
+   out.reserve(nrOfFaces);
+   for (const Cluster &cluster : all)
+      out.insert(out.end(), faces.begin() + cluster.first, faces.begin() + cluster.last);
+   faces.swap(out);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reorders the vertices by first use, so that the vertex fetch reads memory sequentially. Unreferenced vertices are
+ * removed.
+ * @param vertices vertices (replaced)
+ * @param faces faces (remapped)
+ * @return TF
+ */
+bool ENG_API Eng::MeshOptimizer::optimizeVertexFetch(std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces)
+{
+   // Safety net:
+   if (checkIndices(faces.data(), static_cast<uint32_t>(faces.size()), static_cast<uint32_t>(vertices.size())) == false)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   std::vector<uint32_t> remap(vertices.size(), noVertex);
+   std::vector<Eng::Vbo::VertexData> out;
+   out.reserve(vertices.size());
+   for (Eng::Ebo::FaceData &face : faces)
+      for (uint32_t *index : { &face.a, &face.b, &face.c })
+      {
+         if (remap[*index] == noVertex)
+         {
+            remap[*index] = static_cast<uint32_t>(out.size());
+            out.push_back(vertices[*index]);
+         }
+         *index = remap[*index];
+      }
+   vertices.swap(out);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Computes the average cache miss ratio: vertices transformed per face with a FIFO post-transform cache. Ranges
+ * from 3 (no reuse) down to about 0.5 (regular grids).
+ * @param faces faces
+ * @param nrOfFaces number of faces
+ * @param nrOfVertices number of vertices
+ * @param cacheSize simulated cache size
+ * @return ACMR, or 0 on error
+ */
+float ENG_API Eng::MeshOptimizer::computeAcmr(const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces, uint32_t nrOfVertices, uint32_t cacheSize)
+{
+   // Safety net:
+   if (faces == nullptr || nrOfFaces == 0 || checkIndices(faces, nrOfFaces, nrOfVertices) == false)
+      return 0.0f;
+
+   FifoCache cache(nrOfVertices, cacheSize);
+   uint64_t misses = 0;
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+      misses += cache.access(faces[f]);
+
+   // Done:
+   return static_cast<float>(misses) / static_cast<float>(nrOfFaces);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Estimates the overdraw of a mesh drawn in order, with back-face culling and a less-than depth test: the mesh is
+ * rasterized with orthographic projections from the 6 axis directions, and the pixels passing the depth test are
+ * divided by the pixels covered. Ranges from 1 (no overdraw) up.
+ * @param vertices vertices
+ * @param faces faces (counter-clockwise front faces)
+ * @param nrOfFaces number of faces
+ * @return overdraw ratio, or 0 when nothing is covered
+ */
+float ENG_API Eng::MeshOptimizer::computeOverdraw(const Eng::Vbo::VertexData *vertices, const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces)
+{
+   // Safety net:
+   if (vertices == nullptr || faces == nullptr || nrOfFaces == 0)
+      return 0.0f;
+
+   // Fit the bounding box into the grid:
+   glm::vec3 bboxMin(FLT_MAX), bboxMax(-FLT_MAX);
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+      for (uint32_t v : { faces[f].a, faces[f].b, faces[f].c })
+      {
+         bboxMin = glm::min(bboxMin, vertices[v].vertex);
+         bboxMax = glm::max(bboxMax, vertices[v].vertex);
+      }
+   const glm::vec3 extent = bboxMax - bboxMin;
+   const float maxExtent = std::max({ extent.x, extent.y, extent.z });
+   if (maxExtent <= 0.0f)
+      return 0.0f;
+   const float scale = static_cast<float>(overdrawGridSize) / maxExtent;
+
+   // Views along +/- x, y and z (u, v, depth axes keep the handedness):
+   std::vector<float> depth(overdrawGridSize * overdrawGridSize);
+   uint64_t shaded = 0, covered = 0;
+   for (uint32_t axis = 0; axis < 3; axis++)
+      for (uint32_t side = 0; side < 2; side++)
+      {
+         const uint32_t u = (axis + 1) % 3, v = (axis + 2) % 3;
+         std::fill(depth.begin(), depth.end(), FLT_MAX);
+         for (uint32_t f = 0; f < nrOfFaces; f++)
+         {
+            glm::vec3 p[3];
+            const uint32_t index[3] = { faces[f].a, faces[f].b, faces[f].c };
+            for (uint32_t c = 0; c < 3; c++)
+            {
+               const glm::vec3 q = (vertices[index[c]].vertex - bboxMin) * scale;
+               p[c] = glm::vec3(q[u], q[v], side ? q[axis] : -q[axis]);
+            }
+
+            // Viewed from the negative side, the image is mirrored (winding flips):
+            if (side)
+               std::swap(p[1], p[2]);
+            shaded += rasterize(p, depth);
+         }
+         for (float d : depth)
+            covered += (d != FLT_MAX);
+      }
+
+   // Done:
+   return covered ? static_cast<float>(shaded) / static_cast<float>(covered) : 0.0f;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file		engine_mesh_optimizer.h
+ * @brief	Vertex cache, overdraw and vertex fetch optimization
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Reorders the geometry of a mesh for the GPU: duplicate vertices are welded, faces are sorted for the
+ *        post-transform vertex cache (Tipsify, Sander et al. 2007), clusters of faces are then sorted to reduce
+ *        overdraw (view-independent, outward-facing clusters first), and vertices are finally sorted by first use
+ *        for fetch locality. Neither the set of faces nor their winding change.
+ *        When enabled, each LOD is optimized when saved (Ovo::save()) or cooked (Cooked::cook()); optimizing when
+ *        loaded (Mesh) is opt-in, for files written without it. This class is a singleton.
+ */
+class ENG_API MeshOptimizer
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief Cache and overdraw figures before and after optimize().
+    */
+   struct Stats
+   {
+      uint32_t nrOfVerticesBefore, nrOfVerticesAfter;       ///< Vertices (before and after welding)
+      float acmrBefore, acmrAfter;                          ///< Average cache miss ratio (transformed vertices per face)
+      float overdrawBefore, overdrawAfter;                  ///< Shaded over covered pixels (averaged over 6 views)
+   };
+
+
+   // Consts:
+   static constexpr uint32_t dfltCacheSize = 16;            ///< Default simulated FIFO cache size (vertices)
+   static constexpr float dfltOverdrawThreshold = 1.05f;    ///< Default max ACMR increase accepted to reduce overdraw
+   static constexpr uint32_t overdrawGridSize = 256;        ///< Resolution of the views used by computeOverdraw()
+
+   // Const/dest:
+   MeshOptimizer(MeshOptimizer const &) = delete;
+   ~MeshOptimizer();
+
+   // Operators:
+   void operator=(MeshOptimizer const &) = delete;
+
+   // Singleton:
+   static MeshOptimizer &getInstance();
+
+   // Get/set:
+   void setEnabled(bool enabled);
+   bool isEnabled() const;
+   void setEnabledOnLoad(bool enabled);
+   bool isEnabledOnLoad() const;
+   void setCacheSize(uint32_t cacheSize);
+   uint32_t getCacheSize() const;
+   void setOverdrawThreshold(float threshold);
+   float getOverdrawThreshold() const;
+
+   // Optimization:
+   bool optimize(std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces, Stats *stats = nullptr) const;
+   static bool weld(std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces);
+   static bool optimizeVertexCache(std::vector<Eng::Ebo::FaceData> &faces, uint32_t nrOfVertices, uint32_t cacheSize,
+                                   std::vector<uint32_t> *clusters = nullptr);
+   static bool optimizeOverdraw(const std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces,
+                                const std::vector<uint32_t> &clusters, uint32_t cacheSize, float threshold);
+   static bool optimizeVertexFetch(std::vector<Eng::Vbo::VertexData> &vertices, std::vector<Eng::Ebo::FaceData> &faces);
+
+   // Analysis:
+   static float computeAcmr(const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces, uint32_t nrOfVertices, uint32_t cacheSize);
+   static float computeOverdraw(const Eng::Vbo::VertexData *vertices, const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces);
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   MeshOptimizer();
+};
@@ -16,6 +16,7 @@
 
    // C/C++:
    #include <map>
+   #include <mutex>
 
    
 
@@ -23,6 +24,135 @@
 // STATIC //
 ////////////
 
+/**
+ * Slots of the live nodes, resolving handles to the current address of a node (updated when moved). Slots are
+ * stored in fixed-size chunks that never move, so that resolve() can read them without locking.
+ */
+struct NodeRegistry
+{
+   /**
+    * @brief Registry entry.
+    */
+   struct Slot
+   {
+      Eng::Node *node;                          ///< Current address (nullptr when free)
+      uint32_t generation;                      ///< Changed whenever the slot is freed (never 0)
+   };
+
+   static constexpr uint32_t chunkSize = 1024;          ///< Slots per chunk
+   static constexpr uint32_t maxNrOfChunks = 4096;      ///< Max 4M live nodes
+
+   std::unique_ptr<Slot[]> chunks[maxNrOfChunks];       ///< Allocated on demand
+   uint32_t nrOfSlots = 0;                              ///< Slots used so far
+   std::vector<uint32_t> freeSlots;                     ///< Slots released by destroyed nodes
+   std::mutex mutex;                                    ///< Protects the above (not needed by resolve())
+
+
+   /**
+    * Gets a slot.
+    * @param index slot index
+    * @return slot
+    */
+   Slot &at(uint32_t index) const
+   {
+      return chunks[index / chunkSize][index % chunkSize];
+   }
+
+
+   /**
+    * Registers a node.
+    * @param node node
+    * @return handle of the node (null when the registry is full)
+    */
+   Eng::Handle<Eng::Node> add(Eng::Node *node)
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      uint32_t index;
+      if (freeSlots.empty() == false)
+      {
+         index = freeSlots.back();
+         freeSlots.pop_back();
+      }
+      else
+      {
+         if (nrOfSlots == maxNrOfChunks * chunkSize)
+         {
+            ENG_LOG_ERROR("Too many nodes");
+            return Eng::Handle<Eng::Node>();
+         }
+         if (nrOfSlots % chunkSize == 0)
+         {
+            chunks[nrOfSlots / chunkSize] = std::make_unique<Slot[]>(chunkSize);
+            for (uint32_t c = 0; c < chunkSize; c++)
+               chunks[nrOfSlots / chunkSize][c] = { nullptr, 1 };
+         }
+         index = nrOfSlots++;
+      }
+
+      // Done:
+      at(index).node = node;
+      return Eng::Handle<Eng::Node>(index, at(index).generation);
+   }
+
+
+   /**
+    * Updates the address of a moved node.
+    * @param handle handle of the node
+    * @param node new address
+    */
+   void relink(Eng::Handle<Eng::Node> handle, Eng::Node *node)
+   {
+      if (handle.isNull())
+         return;
+      std::lock_guard<std::mutex> lock(mutex);
+      at(handle.index).node = node;
+   }
+
+
+   /**
+    * Unregisters a destroyed node: its handles no longer resolve.
+    * @param handle handle of the node
+    */
+   void remove(Eng::Handle<Eng::Node> handle)
+   {
+      if (handle.isNull())
+         return;
+      std::lock_guard<std::mutex> lock(mutex);
+      Slot &slot = at(handle.index);
+      slot.node = nullptr;
+      if (++slot.generation == 0) // 0 is reserved to null handles
+         slot.generation = 1;
+      freeSlots.push_back(handle.index);
+   }
+
+
+   /**
+    * Resolves a handle.
+    * @param handle handle
+    * @return node, or nullptr when null or destroyed since
+    */
+   Eng::Node *get(Eng::Handle<Eng::Node> handle) const
+   {
+      if (handle.isNull() || handle.index >= maxNrOfChunks * chunkSize || chunks[handle.index / chunkSize] == nullptr)
+         return nullptr;
+      const Slot &slot = at(handle.index);
+      return (slot.generation == handle.generation) ? slot.node : nullptr;
+   }
+};
+
+
+/**
+ * Gets the registry (created on first use, never destroyed: nodes owned by other statics may still be destroyed
+ * at exit).
+ * @return registry
+ */
+static NodeRegistry &getRegistry()
+{
+   static NodeRegistry *registry = new NodeRegistry();
+   return *registry;
+}
+
+
    // Special values:
    Eng::Node Eng::Node::empty("[empty]");      
    
@@ -35,18 +165,21 @@
 /**
  * @brief Node reserved structure.
  */
-struct Eng::Node::Reserved
+struct Eng::Node::Reserved : public Eng::Pooled<Eng::Node::Reserved>
 {  
    glm::mat4 matrix;                                                    ///< Node matrix
-   std::reference_wrapper<Eng::Node> parent;                            ///< Parent node
-   std::list<std::reference_wrapper<Eng::Node>> children;               ///< List of children nodes      
+   Eng::Handle<Eng::Node> handle;                                       ///< Handle of this node
+   Eng::Handle<Eng::Node> parent;                                       ///< Parent node (null if none)
+   std::vector<Eng::Handle<Eng::Node>> children;                        ///< Children nodes
+   Eng::TransformTable *transforms;                                     ///< Table flattening this node, if any
+   uint32_t transformId;                                                ///< Index in the table
 
 
    /**
     * Constructor. 
     */
    Reserved() : matrix{ 1.0f },
-                parent{ Eng::Node::empty }
+                transforms{ nullptr }, transformId{ Eng::TransformTable::none }
    {}
 };
 
@@ -63,6 +196,7 @@ struct Eng::Node::Reserved
 ENG_API Eng::Node::Node() : reserved(std::make_unique<Eng::Node::Reserved>())
 {		
    ENG_LOG_DETAIL("[+]");
+   reserved->handle = getRegistry().add(this);
 }
 
 
@@ -74,6 +208,7 @@ ENG_API Eng::Node::Node() : reserved(std::make_unique<Eng::Node::Reserved>())
 ENG_API Eng::Node::Node(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Node::Reserved>())
 {	   
    ENG_LOG_DETAIL("[+]");
+   reserved->handle = getRegistry().add(this);
 }
 
 
@@ -84,6 +219,11 @@ ENG_API Eng::Node::Node(const std::string &name) : Eng::Object(name), reserved(s
 ENG_API Eng::Node::Node(Node &&other) : Eng::Object(std::move(other)), reserved(std::move(other.reserved))
 { 
    ENG_LOG_DETAIL("[M]");
+
+   // Update the references (handles are left untouched):
+   getRegistry().relink(reserved->handle, this);
+   if (reserved->transforms)
+      reserved->transforms->relink(reserved->transformId, *this);
 }
 
 
@@ -94,6 +234,12 @@ ENG_API Eng::Node::Node(Node &&other) : Eng::Object(std::move(other)), reserved(
 ENG_API Eng::Node::~Node()
 {	
    ENG_LOG_DETAIL("[-]");
+
+   if (reserved == nullptr) // Moved
+      return;
+   getRegistry().remove(reserved->handle);
+   if (reserved->transforms)
+      reserved->transforms->detach(reserved->transformId);
 }
 
 
@@ -105,6 +251,8 @@ ENG_API Eng::Node::~Node()
 void ENG_API Eng::Node::setMatrix(const glm::mat4 &matrix) 
 {		
    reserved->matrix = matrix;
+   if (reserved->transforms)
+      reserved->transforms->setLocalMatrix(reserved->transformId, matrix);
 }
 
 
@@ -121,24 +269,25 @@ const glm::mat4 ENG_API &Eng::Node::getMatrix() const
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Get the world coordinate matrix of this node starting from the specified node (if empty, root node is used)
+ * Get the world coordinate matrix of this node starting from the specified node (if empty, root node is used).
+ * Read from the TransformTable of the node when up to date, otherwise computed by walking the parents.
  * @param node starting node (root if empty)
  * @return world coordinate glm 4x4 matrix
  */
 glm::mat4 ENG_API Eng::Node::getWorldMatrix(Eng::Node &root) const
 {	
-   auto current = std::reference_wrapper<Eng::Node>(const_cast<Eng::Node &>(* this));   
-   glm::mat4 result = glm::mat4(1.0f);
+   // Flattened hierarchy:
+   if (root == Eng::Node::empty && reserved->transforms && reserved->transforms->isUpToDate() && 
+       reserved->transforms->getNode(0).getParent() == Eng::Node::empty)
+      return reserved->transforms->getWorldMatrix(reserved->transformId);
 
    // Back iteration:
-   do 
-   {
-      result = result * glm::transpose(current.get().getMatrix());
-      current = current.get().getParent();
-   } while (current.get() != Eng::Node::empty && current.get() != root);
+   glm::mat4 result = reserved->matrix;
+   for (const Eng::Node *current = &getParent(); *current != Eng::Node::empty && *current != root; current = &current->getParent())
+      result = current->getMatrix() * result;
    
    // Done:
-   return glm::transpose(result); 
+   return result; 
 }
 
 
@@ -149,7 +298,7 @@ glm::mat4 ENG_API Eng::Node::getWorldMatrix(Eng::Node &root) const
  */	
 Eng::Node ENG_API &Eng::Node::getParent() const
 {	   
-	return reserved->parent;
+	return resolve(reserved->parent);
 }
 
 
@@ -160,7 +309,31 @@ Eng::Node ENG_API &Eng::Node::getParent() const
  */	
 void ENG_API Eng::Node::setParent(Eng::Node &parent)
 {	   
-	reserved->parent = parent;
+	reserved->parent = (parent == Eng::Node::empty) ? Eng::Handle<Eng::Node>() : parent.getHandle();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the handle of this node. Handles stay valid when the node is moved and no longer resolve once it is destroyed.
+ * @return node handle
+ */
+Eng::Handle<Eng::Node> ENG_API Eng::Node::getHandle() const
+{
+   return reserved->handle;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the node referenced by a handle.
+ * @param handle node handle
+ * @return node reference, or empty reference if null or destroyed
+ */
+Eng::Node ENG_API &Eng::Node::resolve(Eng::Handle<Eng::Node> handle)
+{
+   Eng::Node *node = getRegistry().get(handle);
+   return node ? *node : Eng::Node::empty;
 }
 
 
@@ -179,11 +352,7 @@ Eng::Node ENG_API &Eng::Node::getChild(uint32_t id) const
 		return Node::empty;
 	}		
 	
-	// Iterate up to the good one:	
-	auto i = reserved->children.begin();				
-	for (uint32_t c = 0; c < id; c++)	
-		i++;		
-	return i->get();		
+	return resolve(reserved->children[id]);
 }
 
 
@@ -202,15 +371,13 @@ Eng::Node ENG_API &Eng::Node::removeChild(uint32_t id)
 		return Eng::Node::empty;
 	}		
 	
-	// Iterate up to the good one:	
-	auto i = reserved->children.begin();				
-	for (unsigned int c = 0; c < id; c++)	
-		i++;
-
    // Remove and update:
-   i->get().setParent(Eng::Node::empty);
-   auto &x = i->get();
-   reserved->children.erase(i);   
+   if (reserved->transforms)
+      reserved->transforms->invalidate();
+   Eng::Node &x = resolve(reserved->children[id]);
+   if (x != Eng::Node::empty)
+      x.setParent(Eng::Node::empty);
+   reserved->children.erase(reserved->children.begin() + id);
 	return x;		
 }
 
@@ -238,7 +405,11 @@ bool ENG_API Eng::Node::addChild(Eng::Node &child)
 	}
 	
 	// Add and update:
-   reserved->children.push_back(child);	
+   if (reserved->transforms)
+      reserved->transforms->invalidate();
+   if (child.reserved->transforms)
+      child.reserved->transforms->invalidate();
+   reserved->children.push_back(child.getHandle());	
    child.setParent(*this);
    return true;
 }
@@ -258,14 +429,50 @@ uint32_t ENG_API Eng::Node::getNrOfChildren() const
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////	 
 /** 
  * Return (as read-only) the internal list of children. This is used for perfomance reasons, to avoid iterating too much over the list.
+ * Handles of destroyed children resolve to the empty node.
  * @return reference to the internal list of children
  */	
-const std::list<std::reference_wrapper<Eng::Node>> ENG_API &Eng::Node::getListOfChildren() const
+const std::vector<Eng::Handle<Eng::Node>> ENG_API &Eng::Node::getListOfChildren() const
 {	   
    return reserved->children;	
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the TransformTable flattening this node (called by the table).
+ * @param table transform table, or nullptr to detach
+ * @param id index in the table
+ */
+void ENG_API Eng::Node::setTransformSlot(Eng::TransformTable *table, uint32_t id)
+{
+   reserved->transforms = table;
+   reserved->transformId = id;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the TransformTable flattening this node.
+ * @return transform table, or nullptr if none
+ */
+Eng::TransformTable ENG_API *Eng::Node::getTransformTable() const
+{
+   return reserved->transforms;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the index of this node in its TransformTable.
+ * @return index, or TransformTable::none if none
+ */
+uint32_t ENG_API Eng::Node::getTransformSlot() const
+{
+   return reserved->transformId;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Loads the specific information of a given object. In its base class, this function loads the file version chunk.
@@ -334,7 +541,8 @@ std::string ENG_API Eng::Node::getTreeAsString() const
    // Recursion:
    calls++;
       for (auto &i : reserved->children)
-         i.get().getTreeAsString();
+         if (Eng::Node &child = resolve(i); child != Eng::Node::empty)
+            child.getTreeAsString();
    calls--;
    
    // Done:
@@ -8,8 +8,14 @@
 
 
 
+// Forward declarations:
+class TransformTable;
+
+
+
 /**
- * @brief Class for modelling a generic node. 
+ * @brief Class for modelling a generic node. Nodes reference their parent and children by generational handle, so
+ * that they can be moved (e.g., within containers) without invalidating the hierarchy.
  */
 class ENG_API Node : public Eng::Object, public Eng::Ovo
 {
@@ -41,7 +47,16 @@ public: //
    bool addChild(Node &child);
    Node &getChild(uint32_t id) const;
    Node &removeChild(uint32_t id);   
-   const std::list<std::reference_wrapper<Node>> &getListOfChildren() const;      
+   const std::vector<Eng::Handle<Node>> &getListOfChildren() const;      
+
+   // Handles:
+   Eng::Handle<Node> getHandle() const;
+   static Node &resolve(Eng::Handle<Node> handle);
+
+   // Transforms:
+   void setTransformSlot(Eng::TransformTable *table, uint32_t id);
+   Eng::TransformTable *getTransformTable() const;
+   uint32_t getTransformSlot() const;
 
    // Ovo:   
    uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr);
@@ -14,6 +14,9 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <atomic>
+
 
 
 ////////////
@@ -23,9 +26,9 @@
    // Special values:
    Eng::Object Eng::Object::empty("[empty]");
 
-   // Parity check and counters:
-   static int32_t counter = 0;
-   static uint32_t idCounter = 0;
+   // Parity check and counters (atomic, as objects such as bitmaps can be created by worker threads):
+   static std::atomic<int32_t> counter{ 0 };
+   static std::atomic<uint32_t> idCounter{ 0 };
 
 
 
@@ -36,18 +39,19 @@
 /**
  * @brief Object reserved structure.
  */
-struct Eng::Object::Reserved
+struct Eng::Object::Reserved : public Eng::Pooled<Eng::Object::Reserved>
 {
    // General:
    std::string name;                         ///< Name
    uint32_t id;                              ///< UID
    bool dirty;                               ///< Object needs update  
+   uint32_t poolSlot;                        ///< Slot in the Pool storing this object, if any
 
 
    /**
     * Constructor.
     */
-   Reserved() : name{ "[none]" }, id{ idCounter++ }, dirty{ true }
+   Reserved() : name{ "[none]" }, id{ idCounter++ }, dirty{ true }, poolSlot{ 0xFFFFFFFF }
    {
       counter++;
    }
@@ -184,7 +188,7 @@ uint32_t ENG_API Eng::Object::getId() const
  */
 int32_t ENG_API Eng::Object::getNrOfObjects()
 {
-   return counter;
+   return counter.load();
 }
 
 
@@ -200,6 +204,28 @@ void ENG_API Eng::Object::setDirty(bool dirty) const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the slot of the Pool storing this object (called by the pool).
+ * @param slot slot index, or Pool::none
+ */
+void ENG_API Eng::Object::setPoolSlot(uint32_t slot)
+{
+   reserved->poolSlot = slot;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the slot of the Pool storing this object.
+ * @return slot index, or Pool::none if never stored
+ */
+uint32_t ENG_API Eng::Object::getPoolSlot() const
+{
+   return reserved->poolSlot;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Return true if dirty.
@@ -51,6 +51,10 @@ public: //
    bool isDirty() const;
    void setDirty(bool dirty) const;
 
+   // Pool:
+   void setPoolSlot(uint32_t slot);
+   uint32_t getPoolSlot() const;
+
    // Statistics:
    static int32_t getNrOfObjects();
 
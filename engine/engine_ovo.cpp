@@ -13,8 +13,11 @@
 
    // Main include:
    #include "engine.h"
+   #include <algorithm>
    #include <functional>
    #include <map>
+   #include <mutex>
+   #include <unordered_map>
 
    // GLM:
    #include <glm/gtc/packing.hpp>  
@@ -73,8 +76,13 @@ uint32_t ENG_API Eng::Ovo::ignoreChunk(Eng::Serializer &serial)
    uint32_t chunkSize;
    serial.deserialize(chunkSize);   
 
-   std::vector<uint8_t> dummy(chunkSize);
-   serial.deserialize(dummy.data(), chunkSize);
+   // Jump over the payload:
+   if (serial.setPosition(serial.getPosition() + chunkSize) == false)
+   {
+      ENG_LOG_ERROR("Corrupted chunk size");
+      serial.setPosition(serial.getNrOfBytes());
+      return 0;
+   }
 
    // Done:   
    return chunkSize;
@@ -85,9 +93,10 @@ uint32_t ENG_API Eng::Ovo::ignoreChunk(Eng::Serializer &serial)
 /**
  * Loads an OVO file.
  * @param filename 3D file 
+ * @param lazy when true, only the scene graph is loaded: mesh geometry and textures are loaded on first use
  * @return root node or Node::empty if error
  */
-Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
+Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename, bool lazy)
 {
    // Safety net:
    if (filename.empty())
@@ -98,31 +107,15 @@ Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
 
 
    /////////////////////////////////////////
-   // STEP 1: load file into a memory buffer
+   // STEP 1: map file into memory (read-only, pages loaded on demand)
    bool error = false;
-   FILE *dat = fopen(filename.c_str(), "rb");
-   if (dat == nullptr)
+   Eng::Serializer serial;
+   if (serial.map(filename) == false)
    {
       ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
       return Eng::Node::empty;
    }
 
-   // Get file length (max 2 GB):
-   uint64_t length;
-   fseek(dat, 0L, SEEK_END);
-      length = ftell(dat);
-   fseek(dat, 0L, SEEK_SET);
-
-   // Init mem and copy:
-   Eng::Serializer serial(nullptr, length);
-   if (fread(serial.getData(), sizeof(uint8_t), length, dat) != length)
-   {
-      ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
-      fclose(dat);
-      return Eng::Node::empty;
-   }
-   fclose(dat);  
-
    // First chunk must be the format version:   
    if (loadChunk(serial) == 0)
    {
@@ -134,10 +127,22 @@ Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
    ///////////////////////////////
    // STEP 2: Materials and geoms:  
    Eng::Container &container = Eng::Container::getInstance();
+   Eng::Ovo::LoadInfo info;
+   info.deferUpload = false;
+   info.lazy = lazy;
+   info.keepBitmaps = false;
    std::function<Eng::Node& (void)> parse;
-   parse = [&serial, &container, this, &parse, &error](void)->Eng::Node&
+   parse = [&serial, &container, &info, this, &parse, &error](void)->Eng::Node&
    {
-      switch (*(static_cast<uint8_t *>(serial.getDataAtCurPos())))
+      // Truncated file (e.g., children missing):
+      const uint8_t *chunkId = static_cast<const uint8_t *>(serial.getDataAtCurPos());
+      if (serial.hasOverflow() || chunkId == nullptr)
+      {
+         error = true;
+         return Eng::Node::empty;
+      }
+
+      switch (*chunkId)
       {
          ///////////////////////////////////////////////////////////
          case static_cast<uint32_t>(Eng::Ovo::ChunkId::material): //
@@ -145,7 +150,7 @@ Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
             ENG_LOG_DEBUG("Processing material...");
 
             Eng::Material mat;
-            mat.loadChunk(serial);
+            mat.loadChunk(serial, &info);
             container.add(mat);
             return Eng::Node::empty;            
          }
@@ -157,26 +162,37 @@ Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
             ENG_LOG_DEBUG("Processing node...");
 
             Eng::Node node;
-            uint32_t nrOfChildren = node.loadChunk(serial);            
+            uint32_t nrOfChildren = node.loadChunk(serial, &info);            
             container.add(node);
             std::reference_wrapper<Eng::Node> _node = container.getLastNode();
             while (_node.get().getNrOfChildren() < nrOfChildren)
-               _node.get().addChild(parse());              
+            {
+               Eng::Node &child = parse();
+               if (error)
+                  break;
+               _node.get().addChild(child);
+            }
             return _node;
          }
          break;
 
-         ///////////////////////////////////////////////////////
-         case static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh): //
+         /////////////////////////////////////////////////////////////////
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh):           //
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::meshCompressed): //
          {
             ENG_LOG_DEBUG("Processing mesh...");
 
             Eng::Mesh mesh;
-            uint32_t nrOfChildren = mesh.loadChunk(serial);            
+            uint32_t nrOfChildren = mesh.loadChunk(serial, &info);            
             container.add(mesh);
             std::reference_wrapper<Eng::Mesh> _mesh = container.getLastMesh();
             while (_mesh.get().getNrOfChildren() < nrOfChildren)
-               _mesh.get().addChild(parse());              
+            {
+               Eng::Node &child = parse();
+               if (error)
+                  break;
+               _mesh.get().addChild(child);
+            }
             return _mesh;
          }
          break;
@@ -187,11 +203,16 @@ Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
             ENG_LOG_DEBUG("Processing light...");
 
             Eng::Light light;
-            uint32_t nrOfChildren = light.loadChunk(serial);
+            uint32_t nrOfChildren = light.loadChunk(serial, &info);
             container.add(light);
             std::reference_wrapper<Eng::Light> _light = container.getLastLight();
             while (_light.get().getNrOfChildren() < nrOfChildren)
-               _light.get().addChild(parse());              
+            {
+               Eng::Node &child = parse();
+               if (error)
+                  break;
+               _light.get().addChild(child);
+            }
             return _light;
          }
          break;
@@ -207,8 +228,841 @@ Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
    // Iterate:
    std::reference_wrapper<Eng::Node> root(Eng::Node::empty);
    while (serial.getDataAtCurPos() && !error)
+   {
       root = parse();
 
+      // Truncated or corrupted chunk:
+      if (serial.hasOverflow() || error)
+      {
+         ENG_LOG_ERROR("Corrupted file '%s'", filename.c_str());
+         error = true;
+      }
+   }
+
    // Done:   
    return root;
 }
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Scans the chunks from the current position to the end of the data, without decoding their payload.
+ * Only the header of node-like chunks (node, mesh, compressed mesh, light) is read, to rebuild the hierarchy.
+ * @param serial serial data, positioned after the version chunk
+ * @param table chunk table, filled in file order (which is a pre-order traversal of the scene graph)
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::buildChunkTable(Eng::Serializer &serial, std::vector<ChunkInfo> &table)
+{
+   struct Open
+   {
+      int32_t index;
+      uint32_t nrOfMissing;
+   };
+   std::vector<Open> stack;
+
+   table.clear();
+   while (serial.getPosition() + 2 * sizeof(uint32_t) <= serial.getNrOfBytes())
+   {
+      ChunkInfo info;
+      info.position = serial.getPosition();
+      info.nrOfChildren = 0;
+
+      uint32_t chunkId;
+      serial.read(chunkId);
+      info.id = static_cast<Eng::Ovo::ChunkId>(chunkId);
+      serial.read(info.size);
+
+      const uint64_t next = info.position + 2 * sizeof(uint32_t) + info.size;
+      if (next > serial.getNrOfBytes())
+      {
+         ENG_LOG_ERROR("Corrupted chunk at offset %llu", (unsigned long long) info.position);
+         return false;
+      }
+
+      if (info.id == Eng::Ovo::ChunkId::node || info.id == Eng::Ovo::ChunkId::mesh ||
+          info.id == Eng::Ovo::ChunkId::meshCompressed || info.id == Eng::Ovo::ChunkId::light)
+      {
+         serial.deserializeString();       // Name
+         serial.readSpan<glm::mat4>(1);    // Matrix
+         serial.read(info.nrOfChildren);
+         if (serial.hasOverflow())
+         {
+            ENG_LOG_ERROR("Corrupted chunk at offset %llu", (unsigned long long) info.position);
+            return false;
+         }
+      }
+
+      // Hierarchy:
+      info.parent = -1;
+      if (!stack.empty())
+      {
+         info.parent = stack.back().index;
+         stack.back().nrOfMissing--;
+      }
+      while (!stack.empty() && stack.back().nrOfMissing == 0)
+         stack.pop_back();
+      if (info.nrOfChildren)
+         stack.push_back({ static_cast<int32_t>(table.size()), info.nrOfChildren });
+
+      table.push_back(info);
+      serial.setPosition(next);
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reads the names of the texture files referenced by a material chunk, without decoding it.
+ * @param serial serial data, positioned at the payload of a material chunk
+ * @param names texture file names, appended when not already in the list
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::getMaterialTextures(Eng::Serializer &serial, std::vector<std::string> &names)
+{
+   // Same layout as in Material::loadChunk():
+   serial.deserializeString();                                          // Name
+   serial.readSpan<uint8_t>(2 * sizeof(glm::vec3) + 3 * sizeof(float));  // Emission, albedo, roughness, metalness, opacity
+   for (uint32_t t = 0; t < 5; t++)
+   {
+      const std::string_view name = serial.deserializeString();
+      if (serial.hasOverflow())
+         return false;
+      if (name != "[none]" && std::find(names.begin(), names.end(), name) == names.end())
+         names.emplace_back(name);
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Moves past the header of a (compressed) mesh chunk, up to its LOD section.
+ * @param serial serial data, positioned at the payload of a mesh chunk
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::skipMeshHeader(Eng::Serializer &serial)
+{
+   // Same layout as in Mesh::loadChunk():
+   serial.deserializeString();                                          // Name
+   serial.readSpan<glm::mat4>(1);                                       // Matrix
+   serial.readSpan<uint32_t>(1);                                        // Number of children
+   serial.deserializeString();                                          // Target
+   serial.readSpan<uint8_t>(1);                                         // Subtype
+   serial.deserializeString();                                          // Material
+   serial.readSpan<uint8_t>(sizeof(float) + 2 * sizeof(glm::vec3));    // Radius, bounding box
+
+   uint8_t hasPhysics;
+   serial.read(hasPhysics);
+   if (hasPhysics)
+   {
+      ENG_LOG_ERROR("Physics section not supported");
+      return false;
+   }
+
+   // Done:
+   return serial.hasOverflow() == false;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Loads an OVO file in two phases: a fast scan builds the chunk table, then chunks are decoded in parallel
+ * by the ThreadPool (including compressed meshes, which makes them the cheapest to load this way). GPU resources are not created here: the corresponding jobs are pushed to the UploadQueue, which
+ * must be processed by the rendering thread (e.g., with a time budget per frame). The resulting scene graph
+ * is the same as the one returned by load(). Call from the thread owning the OpenGL context.
+ * @param filename 3D file
+ * @param lazy when true, mesh geometry and textures are loaded on first use instead of being queued
+ * @return root node or Node::empty if error
+ */
+Eng::Node ENG_API &Eng::Ovo::loadParallel(const std::string &filename, bool lazy)
+{
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return Eng::Node::empty;
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 1: map file and build chunk table
+   Eng::Serializer serial;
+   if (serial.map(filename) == false)
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
+      return Eng::Node::empty;
+   }
+
+   // First chunk must be the format version:   
+   if (loadChunk(serial) == 0)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
+      return Eng::Node::empty;
+   }
+
+   std::vector<ChunkInfo> table;
+   if (buildChunkTable(serial, table) == false)
+   {
+      ENG_LOG_ERROR("Unable to scan file '%s'", filename.c_str());
+      return Eng::Node::empty;
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 2: create objects (in file order, to keep IDs as in load())
+   std::vector<std::unique_ptr<Eng::Object>> object(table.size());
+   for (uint32_t c = 0; c < table.size(); c++)
+      switch (table[c].id)
+      {
+         case Eng::Ovo::ChunkId::material:   object[c] = std::make_unique<Eng::Material>(); break;
+         case Eng::Ovo::ChunkId::node:       object[c] = std::make_unique<Eng::Node>(); break;
+         case Eng::Ovo::ChunkId::mesh:
+         case Eng::Ovo::ChunkId::meshCompressed:
+                                             object[c] = std::make_unique<Eng::Mesh>(); break;
+         case Eng::Ovo::ChunkId::light:      object[c] = std::make_unique<Eng::Light>(); break;
+         default:
+            ENG_LOG_WARN("Unknown chunk ID (%u) found: ignored", static_cast<uint32_t>(table[c].id));
+      }
+
+   // Decodes the chunks accepted by the filter on the worker threads:
+   Eng::ThreadPool &pool = Eng::ThreadPool::getInstance();
+   Eng::Ovo::LoadInfo info;
+   info.deferUpload = true;
+   info.lazy = lazy;
+   info.keepBitmaps = false;
+   auto decode = [&](const std::function<bool(Eng::Ovo::ChunkId)> &filter)
+   {
+      pool.parallelFor(static_cast<uint32_t>(table.size()), [&](uint32_t c)
+         {
+            if (object[c] == nullptr || !filter(table[c].id))
+               return;
+
+            Eng::Serializer chunk(serial); // Shares the mapping
+            chunk.setPosition(table[c].position);
+            dynamic_cast<Eng::Ovo &>(*object[c]).loadChunk(chunk, &info);
+         });
+   };
+
+
+   /////////////////////////////////////////
+   // STEP 3: materials (and their bitmaps), required by meshes
+   std::unordered_map<std::string, std::vector<uint8_t>> images;
+   std::mutex imagesMutex;
+   if (!lazy)
+   {
+      // Prefetch all the images in one batch, while the materials wait for them:
+      std::vector<std::string> names;
+      for (uint32_t c = 0; c < table.size(); c++)
+         if (table[c].id == Eng::Ovo::ChunkId::material)
+         {
+            Eng::Serializer chunk(serial);
+            chunk.setPosition(table[c].position + 2 * sizeof(uint32_t));
+            getMaterialTextures(chunk, names);
+         }
+
+      std::vector<Eng::AsyncIo::Request> batch;
+      for (auto &name : names)
+         batch.emplace_back(name, [&images, &imagesMutex, name](bool success, const uint8_t *data, uint64_t nrOfBytes)
+            {
+               if (!success)
+                  return;
+               std::vector<uint8_t> bytes(data, data + nrOfBytes);
+               std::lock_guard<std::mutex> lock(imagesMutex);
+               images[name] = std::move(bytes);
+            });
+
+      Eng::AsyncIo &io = Eng::AsyncIo::getInstance();
+      io.submit(batch);
+      io.wait();
+
+      // Missing entries fall back to a regular load (and its error report):
+      info.loadBitmap = [&images](const std::string &name, Eng::Bitmap &bitmap)
+      {
+         auto it = images.find(name);
+         if (it == images.end())
+            return bitmap.load(name);
+         return bitmap.load(it->second.data(), it->second.size(), name);
+      };
+   }
+   decode([](Eng::Ovo::ChunkId id) { return id == Eng::Ovo::ChunkId::material; });
+
+   Eng::Container &container = Eng::Container::getInstance();
+   Eng::UploadQueue &uploads = Eng::UploadQueue::getInstance();
+   for (uint32_t c = 0; c < table.size(); c++)
+      if (table[c].id == Eng::Ovo::ChunkId::material)
+      {
+         container.add(*object[c]);
+         Eng::Material &mat = container.getLastMaterial();
+         if (!lazy)
+            uploads.push([&mat]() { return mat.upload(); });
+      }
+
+
+   /////////////////////////////////////////
+   // STEP 4: nodes, meshes and lights
+   decode([](Eng::Ovo::ChunkId id) { return id != Eng::Ovo::ChunkId::material; });
+
+   std::vector<std::reference_wrapper<Eng::Node>> node(table.size(), Eng::Node::empty);
+   for (uint32_t c = 0; c < table.size(); c++)
+      switch (table[c].id)
+      {
+         case Eng::Ovo::ChunkId::node:
+            container.add(*object[c]);
+            node[c] = container.getLastNode();
+            break;
+
+         case Eng::Ovo::ChunkId::mesh:
+         case Eng::Ovo::ChunkId::meshCompressed:
+         {
+            container.add(*object[c]);
+            Eng::Mesh &mesh = container.getLastMesh();
+            if (!lazy)
+               uploads.push([&mesh]() { return mesh.upload(); });
+            node[c] = mesh;
+         }
+         break;
+
+         case Eng::Ovo::ChunkId::light:
+            container.add(*object[c]);
+            node[c] = container.getLastLight();
+            break;
+
+         default:
+            break;
+      }
+
+   // Rebuild hierarchy (file order keeps the same order of children):
+   for (uint32_t c = 0; c < table.size(); c++)
+      if (table[c].parent >= 0 && node[c].get() != Eng::Node::empty)
+         node[table[c].parent].get().addChild(node[c]);
+
+   // As in load(), the root is the last top-level chunk:
+   std::reference_wrapper<Eng::Node> root(Eng::Node::empty);
+   for (uint32_t c = 0; c < table.size(); c++)
+      if (table[c].parent < 0)
+         root = node[c];
+
+   // Done:
+   ENG_LOG_DEBUG("%zu chunks decoded, %u uploads pending", table.size(), uploads.getNrOfPending());
+   return root;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Rewrites an OVO file, converting its meshes to compressed chunks (or back to standard ones). Meshes are
+ * (de)compressed in parallel by the ThreadPool, all the other chunks are copied as they are.
+ * @param source OVO file
+ * @param filename OVO file to create
+ * @param compressed when true, meshes are stored as ChunkId::meshCompressed, otherwise as ChunkId::mesh
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::save(const std::string &source, const std::string &filename, bool compressed)
+{
+   // Safety net:
+   if (source.empty() || filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 1: map source and build chunk table
+   Eng::Serializer serial;
+   if (serial.map(source) == false)
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", source.c_str());
+      return false;
+   }
+
+   Eng::Ovo ovo;
+   if (ovo.loadChunk(serial) == 0)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", source.c_str());
+      return false;
+   }
+   const uint64_t versionSize = serial.getPosition();
+
+   std::vector<ChunkInfo> table;
+   if (buildChunkTable(serial, table) == false)
+   {
+      ENG_LOG_ERROR("Unable to scan file '%s'", source.c_str());
+      return false;
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 2: convert meshes
+   const Eng::Ovo::ChunkId from = compressed ? Eng::Ovo::ChunkId::mesh : Eng::Ovo::ChunkId::meshCompressed;
+   const Eng::Ovo::ChunkId to = compressed ? Eng::Ovo::ChunkId::meshCompressed : Eng::Ovo::ChunkId::mesh;
+   const uint8_t *base = static_cast<const uint8_t *>(serial.getData());
+   std::vector<Eng::Serializer> converted(table.size());
+   std::vector<uint8_t> failed(table.size(), 0);
+   Eng::ThreadPool::getInstance().parallelFor(static_cast<uint32_t>(table.size()), [&](uint32_t c)
+      {
+         if (table[c].id != from)
+            return;
+
+         Eng::Serializer reader(serial); // Shares the mapping
+         const uint64_t payload = table[c].position + 2 * sizeof(uint32_t);
+         reader.setPosition(payload);
+         if (skipMeshHeader(reader) == false)
+         {
+            failed[c] = 1;
+            return;
+         }
+
+         // Same header, new chunk ID and size:
+         Eng::Serializer &chunk = converted[c];
+         chunk.serialize(static_cast<uint32_t>(to));
+         chunk.serialize(0u);
+         chunk.serialize(base + payload, reader.getPosition() - payload);
+
+         uint32_t nrOfLods;
+         reader.read(nrOfLods);
+         const uint64_t nrOfLodsPosition = chunk.getPosition();
+         chunk.serialize(nrOfLods);
+
+         // Writes one LOD in the target format, optimized for the GPU when enabled:
+         const Eng::MeshOptimizer &optimizer = Eng::MeshOptimizer::getInstance();
+         std::vector<Eng::Vbo::VertexData> optimizedVertices;
+         std::vector<Eng::Ebo::FaceData> optimizedFaces;
+         std::vector<uint8_t> vertexStream, faceStream;
+         auto writeLod = [&](const Eng::Vbo::VertexData *v, uint32_t nrOfVertices, const Eng::Ebo::FaceData *f, uint32_t nrOfFaces)
+            {
+               if (optimizer.isEnabled())
+               {
+                  Eng::MeshOptimizer::Stats stats;
+                  optimizedVertices.assign(v, v + nrOfVertices);
+                  optimizedFaces.assign(f, f + nrOfFaces);
+                  if (optimizer.optimize(optimizedVertices, optimizedFaces, &stats) == false)
+                     return false;
+                  ENG_LOG_INFO("Optimized LOD: v: %u -> %u, ACMR: %.3f -> %.3f, overdraw: %.3f -> %.3f", stats.nrOfVerticesBefore, stats.nrOfVerticesAfter,
+                               stats.acmrBefore, stats.acmrAfter, stats.overdrawBefore, stats.overdrawAfter);
+                  v = optimizedVertices.data();
+                  nrOfVertices = stats.nrOfVerticesAfter;
+                  f = optimizedFaces.data();
+               }
+
+               chunk.serialize(nrOfVertices);
+               chunk.serialize(nrOfFaces);
+               if (compressed == false)
+               {
+                  chunk.serialize(v, nrOfVertices * sizeof(Eng::Vbo::VertexData));
+                  chunk.serialize(f, nrOfFaces * sizeof(Eng::Ebo::FaceData));
+                  return true;
+               }
+
+               if (Eng::MeshCodec::encodeVertices(v, nrOfVertices, vertexStream) == false ||
+                   Eng::MeshCodec::encodeFaces(f, nrOfFaces, faceStream) == false)
+                  return false;
+               chunk.serialize(static_cast<uint32_t>(vertexStream.size()));
+               chunk.serialize(static_cast<uint32_t>(faceStream.size()));
+               chunk.serialize(vertexStream.data(), vertexStream.size());
+               chunk.serialize(faceStream.data(), faceStream.size());
+               return true;
+            };
+
+         std::vector<Eng::Vbo::VertexData> vertices;
+         std::vector<Eng::Ebo::FaceData> faces;
+         const Eng::Vbo::VertexData *v = nullptr;
+         const Eng::Ebo::FaceData *f = nullptr;
+         uint32_t nrOfVertices = 0, nrOfFaces = 0;
+         for (uint32_t l = 0; l < nrOfLods; l++)
+         {
+            reader.read(nrOfVertices);
+            reader.read(nrOfFaces);
+
+            if (compressed)
+            {
+               v = reader.readSpan<Eng::Vbo::VertexData>(nrOfVertices);
+               f = reader.readSpan<Eng::Ebo::FaceData>(nrOfFaces);
+               if (reader.hasOverflow())
+               {
+                  failed[c] = 1;
+                  return;
+               }
+            }
+            else
+            {
+               uint32_t vertexBytes, faceBytes;
+               reader.read(vertexBytes);
+               reader.read(faceBytes);
+               const uint8_t *vs = reader.readSpan<uint8_t>(vertexBytes);
+               const uint8_t *fs = reader.readSpan<uint8_t>(faceBytes);
+               if (reader.hasOverflow())
+               {
+                  failed[c] = 1;
+                  return;
+               }
+
+               vertices.resize(nrOfVertices);
+               faces.resize(nrOfFaces);
+               if (Eng::MeshCodec::decodeVertices(vs, vertexBytes, vertices.data(), nrOfVertices) == false ||
+                   Eng::MeshCodec::decodeFaces(fs, faceBytes, faces.data(), nrOfFaces) == false)
+               {
+                  failed[c] = 1;
+                  return;
+               }
+               v = vertices.data();
+               f = faces.data();
+            }
+
+            if (writeLod(v, nrOfVertices, f, nrOfFaces) == false)
+            {
+               failed[c] = 1;
+               return;
+            }
+         }
+         if (reader.hasOverflow())
+         {
+            failed[c] = 1;
+            return;
+         }
+
+         // Meshes with a single LOD get a generated chain:
+         const Eng::Simplifier &simplifier = Eng::Simplifier::getInstance();
+         if (nrOfLods == 1 && nrOfFaces && simplifier.getNrOfLods())
+         {
+            std::vector<Eng::Simplifier::Lod> lods;
+            if (simplifier.buildLods(v, nrOfVertices, f, nrOfFaces, lods) == false)
+            {
+               failed[c] = 1;
+               return;
+            }
+            for (const Eng::Simplifier::Lod &lod : lods)
+               if (writeLod(lod.vertices.data(), static_cast<uint32_t>(lod.vertices.size()),
+                            lod.faces.data(), static_cast<uint32_t>(lod.faces.size())) == false)
+               {
+                  failed[c] = 1;
+                  return;
+               }
+
+            chunk.setPosition(nrOfLodsPosition);
+            chunk.serialize(nrOfLods + static_cast<uint32_t>(lods.size()));
+         }
+
+         const uint32_t chunkSize = static_cast<uint32_t>(chunk.getNrOfBytes() - 2 * sizeof(uint32_t));
+         chunk.setPosition(sizeof(uint32_t));
+         chunk.serialize(chunkSize);
+      });
+
+   for (uint32_t c = 0; c < table.size(); c++)
+      if (failed[c])
+      {
+         ENG_LOG_ERROR("Corrupted mesh data at offset %llu in file '%s'", (unsigned long long) table[c].position, source.c_str());
+         return false;
+      }
+
+
+   /////////////////////////////////////////
+   // STEP 3: assemble and write
+   Eng::Serializer out;
+   out.serialize(base, versionSize);
+   for (uint32_t c = 0; c < table.size(); c++)
+      if (table[c].id == from)
+         out.serialize(converted[c].getData(), converted[c].getNrOfBytes());
+      else
+         out.serialize(base + table[c].position, 2 * sizeof(uint32_t) + table[c].size);
+
+   FILE *dat = fopen(filename.c_str(), "wb");
+   if (dat == nullptr)
+   {
+      ENG_LOG_ERROR("Unable to create file '%s'", filename.c_str());
+      return false;
+   }
+   const bool error = fwrite(out.getData(), sizeof(uint8_t), out.getNrOfBytes(), dat) != out.getNrOfBytes();
+   fclose(dat);
+   if (error)
+   {
+      ENG_LOG_ERROR("Unable to write file '%s'", filename.c_str());
+      remove(filename.c_str());
+      return false;
+   }
+
+   // Done:
+   ENG_LOG_PLAIN("Saved '%s': %llu -> %llu bytes", filename.c_str(), (unsigned long long) serial.getNrOfBytes(), (unsigned long long) out.getNrOfBytes());
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Parses all the chunks of an OVO file twice, first with per-field deserialize() calls copying every field out (as the
+ * loaders did before the span readers), then with read(), readSpan() and deserializeString() in place, and logs the
+ * throughput (MB/s) of the best of several runs. Geometry and compressed streams are parsed, not decoded.
+ * @param filename OVO file
+ * @param nrOfRuns number of runs per parser
+ * @return TF (false when a parser fails or both do not agree on the content)
+ */
+bool ENG_API Eng::Ovo::benchmark(const std::string &filename, uint32_t nrOfRuns)
+{
+   // Safety net:
+   if (filename.empty() || nrOfRuns == 0)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   Eng::Serializer serial;
+   if (serial.map(filename) == false)
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
+      return false;
+   }
+
+   // Per-field parser:
+   auto parseFields = [&serial](uint64_t &checksum) -> bool
+   {
+      serial.setPosition(0);
+      while (serial.getPosition() + 2 * sizeof(uint32_t) <= serial.getNrOfBytes())
+      {
+         uint32_t chunkId, chunkSize;
+         serial.deserialize(&chunkId, sizeof(uint32_t));
+         serial.deserialize(&chunkSize, sizeof(uint32_t));
+         const uint64_t next = serial.getPosition() + chunkSize;
+         if (next > serial.getNrOfBytes())
+            return false;
+
+         const Eng::Ovo::ChunkId id = static_cast<Eng::Ovo::ChunkId>(chunkId);
+         std::string name;
+         if (id == Eng::Ovo::ChunkId::version)
+         {
+            uint32_t version;
+            serial.deserialize(version);
+            checksum += version;
+         }
+         else if (id == Eng::Ovo::ChunkId::node || id == Eng::Ovo::ChunkId::light ||
+                  id == Eng::Ovo::ChunkId::mesh || id == Eng::Ovo::ChunkId::meshCompressed)
+         {
+            glm::mat4 matrix;
+            uint32_t nrOfChildren;
+            std::string target;
+            serial.deserialize(name);
+            serial.deserialize(matrix);
+            serial.deserialize(nrOfChildren);
+            serial.deserialize(target);
+            checksum += name.size() + nrOfChildren + target.size();
+
+            uint8_t subtype;
+            glm::vec3 color, direction, bboxMin, bboxMax;
+            float radius, cutoff, exponent;
+            uint8_t castShadows, isVolumetric, hasPhysics;
+            if (id == Eng::Ovo::ChunkId::light)
+            {
+               serial.deserialize(subtype);
+               serial.deserialize(color);
+               serial.deserialize(radius);
+               serial.deserialize(direction);
+               serial.deserialize(cutoff);
+               serial.deserialize(exponent);
+               serial.deserialize(castShadows);
+               serial.deserialize(isVolumetric);
+               checksum += subtype;
+            }
+            else if (id != Eng::Ovo::ChunkId::node)
+            {
+               serial.deserialize(subtype);
+               serial.deserialize(name);
+               serial.deserialize(radius);
+               serial.deserialize(bboxMin);
+               serial.deserialize(bboxMax);
+               serial.deserialize(hasPhysics);
+               checksum += name.size();
+               if (hasPhysics)
+                  return false;
+
+               uint32_t nrOfLods;
+               serial.deserialize(nrOfLods);
+               for (uint32_t curLod = 0; curLod < nrOfLods; curLod++)
+               {
+                  uint32_t nrOfVertices, nrOfFaces;
+                  serial.deserialize(nrOfVertices);
+                  serial.deserialize(nrOfFaces);
+                  checksum += nrOfVertices + nrOfFaces;
+                  if (id == Eng::Ovo::ChunkId::meshCompressed)
+                  {
+                     uint32_t vertexBytes, faceBytes;
+                     serial.deserialize(vertexBytes);
+                     serial.deserialize(faceBytes);
+                     if (serial.getPosition() + vertexBytes + faceBytes > next)
+                        return false;
+                     std::vector<uint8_t> vertexStream(vertexBytes), faceStream(faceBytes);
+                     serial.deserialize(vertexStream.data(), vertexBytes);
+                     serial.deserialize(faceStream.data(), faceBytes);
+                     checksum += vertexBytes + faceBytes;
+                     continue;
+                  }
+                  if (serial.getPosition() + static_cast<uint64_t>(nrOfVertices) * sizeof(Eng::Vbo::VertexData) +
+                      static_cast<uint64_t>(nrOfFaces) * sizeof(Eng::Ebo::FaceData) > next)
+                     return false;
+                  std::vector<Eng::Vbo::VertexData> allVertices(nrOfVertices);
+                  serial.deserialize(allVertices.data(), nrOfVertices * sizeof(Eng::Vbo::VertexData));
+                  std::vector<Eng::Ebo::FaceData> allFaces(nrOfFaces);
+                  serial.deserialize(allFaces.data(), nrOfFaces * sizeof(Eng::Ebo::FaceData));
+                  if (nrOfFaces)
+                     checksum += allFaces.back().c;
+               }
+            }
+         }
+         else if (id == Eng::Ovo::ChunkId::material)
+         {
+            glm::vec3 emission, albedo;
+            float roughness, metalness, opacity;
+            serial.deserialize(name);
+            serial.deserialize(emission);
+            serial.deserialize(albedo);
+            serial.deserialize(roughness);
+            serial.deserialize(metalness);
+            serial.deserialize(opacity);
+            checksum += name.size();
+            for (uint32_t c = 0; c < 5; c++)
+            {
+               serial.deserialize(name);
+               checksum += name.size();
+            }
+         }
+         else
+            serial.setPosition(next);
+
+         if (serial.getPosition() != next)
+            return false;
+      }
+      return serial.getPosition() == serial.getNrOfBytes();
+   };
+
+   // In-place parser:
+   auto parseSpans = [&serial](uint64_t &checksum) -> bool
+   {
+      serial.setPosition(0);
+      while (serial.getPosition() + 2 * sizeof(uint32_t) <= serial.getNrOfBytes())
+      {
+         uint32_t chunkId, chunkSize;
+         serial.read(chunkId);
+         serial.read(chunkSize);
+         const uint64_t next = serial.getPosition() + chunkSize;
+         if (next > serial.getNrOfBytes())
+            return false;
+
+         const Eng::Ovo::ChunkId id = static_cast<Eng::Ovo::ChunkId>(chunkId);
+         if (id == Eng::Ovo::ChunkId::version)
+         {
+            uint32_t version;
+            serial.read(version);
+            checksum += version;
+         }
+         else if (id == Eng::Ovo::ChunkId::node || id == Eng::Ovo::ChunkId::light ||
+                  id == Eng::Ovo::ChunkId::mesh || id == Eng::Ovo::ChunkId::meshCompressed)
+         {
+            uint32_t nrOfChildren;
+            const std::string_view name = serial.deserializeString();
+            serial.readSpan<glm::mat4>(1);
+            serial.read(nrOfChildren);
+            const std::string_view target = serial.deserializeString();
+            checksum += name.size() + nrOfChildren + target.size();
+
+            uint8_t subtype;
+            if (id == Eng::Ovo::ChunkId::light)
+            {
+               serial.read(subtype);
+               serial.readSpan<uint8_t>(sizeof(glm::vec3) + sizeof(float) + sizeof(glm::vec3) + 2 * sizeof(float) + 2 * sizeof(uint8_t));
+               checksum += subtype;
+            }
+            else if (id != Eng::Ovo::ChunkId::node)
+            {
+               uint8_t hasPhysics;
+               serial.read(subtype);
+               checksum += serial.deserializeString().size();
+               serial.readSpan<uint8_t>(sizeof(float) + 2 * sizeof(glm::vec3));
+               serial.read(hasPhysics);
+               if (hasPhysics)
+                  return false;
+
+               uint32_t nrOfLods;
+               serial.read(nrOfLods);
+               for (uint32_t curLod = 0; curLod < nrOfLods; curLod++)
+               {
+                  uint32_t nrOfVertices, nrOfFaces;
+                  serial.read(nrOfVertices);
+                  serial.read(nrOfFaces);
+                  checksum += nrOfVertices + nrOfFaces;
+                  if (id == Eng::Ovo::ChunkId::meshCompressed)
+                  {
+                     uint32_t vertexBytes, faceBytes;
+                     serial.read(vertexBytes);
+                     serial.read(faceBytes);
+                     serial.readSpan<uint8_t>(vertexBytes);
+                     serial.readSpan<uint8_t>(faceBytes);
+                     checksum += vertexBytes + faceBytes;
+                     continue;
+                  }
+                  serial.readSpan<Eng::Vbo::VertexData>(nrOfVertices);
+                  const Eng::Ebo::FaceData *allFaces = serial.readSpan<Eng::Ebo::FaceData>(nrOfFaces);
+                  if (nrOfFaces && allFaces)
+                     checksum += allFaces[nrOfFaces - 1].c;
+               }
+            }
+         }
+         else if (id == Eng::Ovo::ChunkId::material)
+         {
+            checksum += serial.deserializeString().size();
+            serial.readSpan<uint8_t>(2 * sizeof(glm::vec3) + 3 * sizeof(float));
+            for (uint32_t c = 0; c < 5; c++)
+               checksum += serial.deserializeString().size();
+         }
+         else
+            serial.setPosition(next);
+
+         if (serial.hasOverflow() || serial.getPosition() != next)
+            return false;
+      }
+      return serial.getPosition() == serial.getNrOfBytes();
+   };
+
+   struct Test
+   {
+      const char *name;
+      std::function<bool(uint64_t &)> parse;
+      double best;
+      uint64_t checksum;
+   };
+   Test tests[] = { { "deserialize", parseFields, 0.0, 0 },
+                    { "read/readSpan", parseSpans, 0.0, 0 } };
+
+   Eng::Timer &timer = Eng::Timer::getInstance();
+   const double size = static_cast<double>(serial.getNrOfBytes()) / (1024.0 * 1024.0);
+   for (Test &test : tests)
+   {
+      for (uint32_t run = 0; run < nrOfRuns; run++)
+      {
+         uint64_t checksum = 0;
+         const uint64_t start = timer.getCounter();
+         const bool done = test.parse(checksum);
+         const double elapsed = timer.getCounterDiff(start, timer.getCounter());
+         if (done == false)
+         {
+            ENG_LOG_ERROR("%s: unable to parse file '%s'", test.name, filename.c_str());
+            return false;
+         }
+         if (run == 0 || elapsed < test.best)
+            test.best = elapsed;
+         test.checksum = checksum;
+      }
+      ENG_LOG_PLAIN("%s: %.3f ms, %.1f MB/s", test.name, test.best, test.best > 0.0 ? size / (test.best / 1000.0) : 0.0);
+   }
+
+   // Done:
+   if (tests[0].checksum != tests[1].checksum)
+   {
+      ENG_LOG_ERROR("Parsers disagree on file '%s'", filename.c_str());
+      return false;
+   }
+   return true;
+}
@@ -18,7 +18,7 @@
 
 
 /**
-* @brief Base 3D OVO manager.
+* @brief Base 3D OVO manager. Besides the standard chunks, meshes can be stored in a compressed chunk (see save()).
 */
 class ENG_API Ovo 
 {
@@ -37,17 +37,55 @@ public: //
       light    = 16,
       mesh     = 18,      
 
+      // Engine extensions:
+      meshCompressed = 100,   ///< Same as mesh, with LODs encoded by MeshCodec
+
       // Terminator:
       last
    };
 
 
+   /**
+    * @brief Chunk table entry, built by a fast scan of the file.
+    */
+   struct ChunkInfo
+   {
+      ChunkId id;                               ///< Chunk type
+      uint64_t position;                        ///< Offset of the chunk header in the file
+      uint32_t size;                            ///< Size of the chunk payload
+      uint32_t nrOfChildren;                    ///< Number of children (nodes only)
+      int32_t parent;                           ///< Index of the parent entry, or -1 if top-level
+   };
+
+
+   /**
+    * @brief Options passed to loadChunk() through its generic data pointer.
+    */
+   struct LoadInfo
+   {
+      bool deferUpload;                         ///< When true, GPU resources are created later by an upload() call
+      bool lazy;                                ///< When true, geometry and textures are loaded on first use
+      bool keepBitmaps;                         ///< When true, textures keep their CPU-side image after upload
+      std::function<bool(const std::string &, Eng::Bitmap &)> loadBitmap;   ///< Optional image source (default: files)
+   };
+
+
    // Consts:
    static constexpr uint32_t version = 8;       ///< OVO format revision (divide by 10)   
 
    // Loading methods:
-   Eng::Node &load(const std::string &filename);
+   Eng::Node &load(const std::string &filename, bool lazy = false);
+   Eng::Node &loadParallel(const std::string &filename, bool lazy = false);
    virtual uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr);
    uint32_t ignoreChunk(Eng::Serializer &serial);
+   static bool buildChunkTable(Eng::Serializer &serial, std::vector<ChunkInfo> &table);
+   static bool getMaterialTextures(Eng::Serializer &serial, std::vector<std::string> &names);
+   static bool skipMeshHeader(Eng::Serializer &serial);
+
+   // Saving methods:
+   static bool save(const std::string &source, const std::string &filename, bool compressed = true);
+
+   // Benchmark:
+   static bool benchmark(const std::string &filename, uint32_t nrOfRuns = 10);
 };
 
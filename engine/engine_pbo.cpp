@@ -0,0 +1,314 @@
+/**
+ * @file		engine_pbo.cpp
+ * @brief	OpenGL Pixel Buffer Object (PBO) upload ring
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // OGL:      
+   #include <GL/glew.h>
+   #include <GLFW/glfw3.h>
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Special values:
+   Eng::Pbo Eng::Pbo::empty("[empty]");
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief Pbo reserved structure.
+ */
+struct Eng::Pbo::Reserved
+{  
+   GLuint oglId;                                ///< OpenGL buffer ID
+   uint64_t size;                               ///< Size in bytes
+   uint8_t *ptr;                                ///< Persistent mapping
+   uint32_t curSegment;                         ///< Segment currently being filled
+   uint64_t curOffset;                          ///< Next free byte in the current segment
+   GLsync fence[Eng::Pbo::nrOfSegments];        ///< Signaled when the GPU is done with a segment
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : oglId{ 0 }, size{ 0 }, ptr{ nullptr }, curSegment{ 0 }, curOffset{ 0 }, fence{}
+   {}
+
+
+   /**
+    * Releases all the fences.
+    */
+   void clearFences()
+   {
+      for (auto &f : fence)
+         if (f)
+         {
+            glDeleteSync(f);
+            f = nullptr;
+         }
+   }
+};
+
+
+
+///////////////////////
+// BODY OF CLASS Pbo //
+///////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::Pbo::Pbo() : reserved(std::make_unique<Eng::Pbo::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor with name.
+ * @param name node name
+ */
+ENG_API Eng::Pbo::Pbo(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Pbo::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Move constructor.
+ */
+ENG_API Eng::Pbo::Pbo(Pbo &&other) : Eng::Object(std::move(other)), reserved(std::move(other.reserved))
+{
+   ENG_LOG_DEBUG("[M]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::Pbo::~Pbo()
+{
+   ENG_LOG_DEBUG("[-]");
+   if (reserved)
+      this->free();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the GLuint buffer ID.
+ * @return buffer ID or 0 if not valid
+ */
+uint32_t ENG_API Eng::Pbo::getOglHandle() const
+{
+   return reserved->oglId;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the size in bytes of the buffer.
+ * @return size in bytes
+ */
+uint64_t ENG_API Eng::Pbo::getSize() const
+{
+   return reserved->size;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Initializes an OpenGL PBO.
+ * @return TF
+ */
+bool ENG_API Eng::Pbo::init()
+{
+   if (this->Eng::Managed::init() == false)
+      return false;
+
+   // Free buffer if already stored:
+   if (reserved->oglId)   
+   {   
+      reserved->clearFences();
+      glDeleteBuffers(1, &reserved->oglId);    
+      reserved->oglId = 0;   
+      reserved->size = 0;
+      reserved->ptr = nullptr;
+   }   
+
+	// Create it:		    
+   glCreateBuffers(1, &reserved->oglId);         
+
+   // Done:   
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases an OpenGL PBO.
+ * @return TF
+ */
+bool ENG_API Eng::Pbo::free()
+{
+   if (this->Eng::Managed::free() == false)
+      return false;
+
+   // Free PBO if stored (unmapped implicitly):
+   if (reserved->oglId)
+   {
+      reserved->clearFences();
+      glDeleteBuffers(1, &reserved->oglId);
+      reserved->oglId = 0;
+      reserved->size = 0;
+      reserved->ptr = nullptr;
+   }
+
+   // Done:   
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Create the ring by allocating immutable storage and mapping it persistently.
+ * @param size size in bytes
+ * @return TF
+ */
+bool ENG_API Eng::Pbo::create(uint64_t size)
+{	
+   // Safety net:
+   if (size < nrOfSegments * alignment)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Release, if already used:
+   if (this->isInitialized())
+      this->free();
+   
+   // Init buffer:
+   if (!this->isInitialized())
+      this->init();   
+
+	// Allocate and map it:		
+   const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+   glNamedBufferStorage(reserved->oglId, size, nullptr, flags);
+   reserved->ptr = static_cast<uint8_t *>(glMapNamedBufferRange(reserved->oglId, 0, size, flags));
+   if (reserved->ptr == nullptr)
+   {
+      ENG_LOG_ERROR("Unable to map PBO");
+      this->free();
+      return false;
+   }
+
+   // Done:
+   reserved->size = size;
+   reserved->curSegment = 0;
+   reserved->curOffset = 0;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reserves staging memory in the ring. When the current segment is full, it is fenced and filling continues in the
+ * next one, waiting for the GPU to release it first (as long as needed). The returned memory must be consumed by GL
+ * commands issued with this PBO bound before the next allocation that switches segment.
+ * @param nrOfBytes number of bytes required
+ * @param offset offset of the reserved memory within the buffer (to be passed to GL as pointer)
+ * @return pointer to the reserved memory, or nullptr if the request does not fit into a segment or the wait failed
+ */
+void ENG_API *Eng::Pbo::allocate(uint64_t nrOfBytes, uint64_t &offset)
+{
+   // Safety net:
+   const uint64_t segmentSize = (reserved->size / nrOfSegments) & ~(alignment - 1);
+   if (reserved->ptr == nullptr || nrOfBytes == 0 || nrOfBytes > segmentSize)
+      return nullptr;
+
+   // Move to the next segment?
+   uint64_t start = (reserved->curOffset + alignment - 1) & ~(alignment - 1);
+   if (start + nrOfBytes > segmentSize)
+   {
+      // The GPU must be done with the next segment before it is overwritten:
+      const uint32_t nextSegment = (reserved->curSegment + 1) % nrOfSegments;
+      GLsync &next = reserved->fence[nextSegment];
+      if (next)
+      {
+         GLenum result;
+         do
+            result = glClientWaitSync(next, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+         while (result == GL_TIMEOUT_EXPIRED);
+         if (result == GL_WAIT_FAILED)
+         {
+            ENG_LOG_WARN("Waiting for PBO segment %u failed", nextSegment);
+            return nullptr; // Segment not released: the caller uploads from client memory
+         }
+         glDeleteSync(next);
+         next = nullptr;
+      }
+
+      reserved->fence[reserved->curSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      reserved->curSegment = nextSegment;
+      reserved->curOffset = 0;
+      start = 0;
+   }
+
+   // Done:
+   offset = reserved->curSegment * segmentSize + start;
+   reserved->curOffset = start + nrOfBytes;
+   return reserved->ptr + offset;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Rendering method. Binds the buffer as pixel unpack source.
+ * @param value generic value
+ * @param data generic pointer to any kind of data
+ * @return TF
+ */
+bool ENG_API Eng::Pbo::render(uint32_t value, void *data) const
+{	
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, reserved->oglId);	  
+   
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the ring shared by the texture uploads, creating it on first use (requires a valid context).
+ * @return reference to the shared ring
+ */
+Eng::Pbo ENG_API &Eng::Pbo::getDefault()
+{
+   static Eng::Pbo ring("[upload ring]");
+   if (ring.getOglHandle() == 0 && glfwGetCurrentContext())
+      ring.create();
+   return ring;
+}
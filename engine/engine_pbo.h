@@ -0,0 +1,64 @@
+/**
+ * @file		engine_pbo.h
+ * @brief	OpenGL Pixel Buffer Object (PBO) upload ring
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Class for modeling a persistently mapped pixel unpack buffer, used as a ring of staging memory for texture
+ *        uploads. The ring is split into segments, each protected by a fence once the GPU starts consuming it.
+ */
+class ENG_API Pbo final : public Eng::Object, public Eng::Managed
+{
+//////////
+public: //
+//////////
+
+   // Special values:
+   static Pbo empty;
+
+   // Consts:
+   static constexpr uint64_t dfltSize = 128 * 1024 * 1024;   ///< Default ring size (bytes)
+   static constexpr uint32_t nrOfSegments = 4;               ///< Number of fenced segments in the ring
+   static constexpr uint64_t alignment = 16;                 ///< Alignment of allocations
+
+   // Const/dest:
+   Pbo();
+   Pbo(Pbo &&other);
+   Pbo(Pbo const &) = delete;
+   ~Pbo();
+
+   // Get/set:
+   uint64_t getSize() const;
+   uint32_t getOglHandle() const;
+
+   // Data:
+   bool create(uint64_t size = dfltSize);
+   void *allocate(uint64_t nrOfBytes, uint64_t &offset);
+
+   // Rendering methods:
+   bool render(uint32_t value = 0, void *data = nullptr) const;
+
+   // Managed:
+   bool init() override;
+   bool free() override;
+
+   // Shared ring:
+   static Pbo &getDefault();
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   Pbo(const std::string &name);
+};
@@ -356,7 +356,12 @@ bool ENG_API Eng::PipelineDefault::render(const Eng::Camera &camera, const Eng::
 
    // Render one light at time:
    const Eng::List::RenderableElem& lightRe = list.getRenderableElem(0);
-   const Eng::Light& light = dynamic_cast<const Eng::Light&>(lightRe.reference.get());
+   const Eng::Light* lightPtr = dynamic_cast<const Eng::Light*>(&Eng::Node::resolve(lightRe.reference));
+   if (lightPtr == nullptr) {
+      ENG_LOG_ERROR("Light destroyed");
+      return false;
+   }
+   const Eng::Light& light = *lightPtr;
    // Render shadow map:
    reserved->shadowMapping.render(list);
 
@@ -486,12 +486,13 @@ bool ENG_API Eng::PipelineFullscreenLighting::render(const Eng::PipelineGeometry
    for (int i = 0; i < list.getNrOfLights(); i++) {
       const Eng::List::RenderableElem& lightRe = list.getRenderableElem(i);
 
-      if (dynamic_cast<const Eng::Light&>(lightRe.reference.get()) == Eng::Light::empty) {
+      const Eng::Light* lightPtr = dynamic_cast<const Eng::Light*>(&Eng::Node::resolve(lightRe.reference));
+      if (lightPtr == nullptr || *lightPtr == Eng::Light::empty) {
          ENG_LOG_ERROR("Invalid params");
          return false;
       }
 
-      const Eng::Light& light = dynamic_cast<const Eng::Light&>(lightRe.reference.get());
+      const Eng::Light& light = *lightPtr;
 
       glm::mat4 lightMatrix = lightRe.matrix;
       x = lightMatrix[3][0];
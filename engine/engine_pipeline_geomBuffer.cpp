@@ -80,8 +80,19 @@ static const std::string pipeline_fs = R"(
 // Uniform (textures):
 layout (bindless_sampler) uniform sampler2D texture0; // Albedo
 layout (bindless_sampler) uniform sampler2D texture1; // Normal
-layout (bindless_sampler) uniform sampler2D texture2; // Roughness
+layout (bindless_sampler) uniform sampler2D texture2; // Roughness (and metalness in green, when packed)
 layout (bindless_sampler) uniform sampler2D texture3; // Metalness
+uniform bool ormPacked = false;                       // Metalness is in texture2 (no texture3)
+
+// Texture arrays of the TextureAtlas, used instead of textureN when atlasN is set:
+#define ATLAS_NONE 0xFFFFFFFFu
+
+layout (binding = 8) uniform sampler2DArray atlasArray[8];
+
+uniform uint atlas0 = ATLAS_NONE; // Array (high 16 bits) and layer (low 16 bits) of texture0
+uniform uint atlas1 = ATLAS_NONE;
+uniform uint atlas2 = ATLAS_NONE;
+uniform uint atlas3 = ATLAS_NONE;
 
 uniform vec3 camPos;
 uniform float roughnessThreshold;
@@ -127,6 +138,29 @@ layout(shared, binding=2) buffer DispatchIndirectCommandData
    DispatchIndirectCommand cmd;
 };
 
+// Mip-usage feedback for the TextureStreamer:
+#define FEEDBACK_NONE 0xFFFFFFFFu
+
+struct FeedbackSlot
+{
+   uint minLevel;
+   uint baseLevel;
+};
+
+layout(std430, binding=7) buffer FeedbackData
+{
+   uint feedbackFrame;
+   uint feedbackRate;
+   uint _pad0;
+   uint _pad1;
+   FeedbackSlot feedbackSlot[];
+};
+
+uniform uint feedback0 = FEEDBACK_NONE; // Feedback slot of texture0
+uniform uint feedback1 = FEEDBACK_NONE;
+uniform uint feedback2 = FEEDBACK_NONE;
+uniform uint feedback3 = FEEDBACK_NONE;
+
 /**
  * Uncompresses the normal and brings it into [-1, 1]^3
  * @param texNormal  normal read from texture
@@ -140,12 +174,81 @@ vec3 getNormal(vec4 texNorm)
 }
 
 
+/**
+ * Samples an image of the TextureAtlas.
+ * @param ref array and layer
+ * @param uv texture coordinates
+ * @return texel
+ */
+vec4 sampleAtlas(uint ref, vec2 uv)
+{
+   vec3 uvw = vec3(uv, float(ref & 0xFFFFu));
+   switch (ref >> 16)
+   {
+      case 0u: return texture(atlasArray[0], uvw);
+      case 1u: return texture(atlasArray[1], uvw);
+      case 2u: return texture(atlasArray[2], uvw);
+      case 3u: return texture(atlasArray[3], uvw);
+      case 4u: return texture(atlasArray[4], uvw);
+      case 5u: return texture(atlasArray[5], uvw);
+      case 6u: return texture(atlasArray[6], uvw);
+      case 7u: return texture(atlasArray[7], uvw);
+   }
+   return vec4(1.0f);
+}
+
+
+/**
+ * Integer hash (for the stochastic subsampling of the feedback).
+ * @param x input value
+ * @return hashed value
+ */
+uint hash(uint x)
+{
+   x ^= x >> 16;
+   x *= 0x7feb352du;
+   x ^= x >> 15;
+   x *= 0x846ca68bu;
+   x ^= x >> 16;
+   return x;
+}
+
+
+/**
+ * Stores the finest mip level required by this fragment.
+ * @param slot feedback slot of the texture
+ * @param lod level of detail computed relative to the resident base level
+ */
+void writeFeedback(uint slot, float lod)
+{
+   if (slot == FEEDBACK_NONE)
+      return;
+   uint level = uint(max(lod + float(feedbackSlot[slot].baseLevel), 0.0f));
+   atomicMin(feedbackSlot[slot].minLevel, level);
+}
+
+
 void main()
 {
-   vec4 albedo_texel    = texture(texture0, uv);
-   vec4 normal_texel    = texture(texture1, uv);
-   vec4 roughness_texel = texture(texture2, uv);
-   vec4 metalness_texel = texture(texture3, uv);
+   // Mip feedback (LODs are computed here, in uniform control flow):
+   if ((feedback0 & feedback1 & feedback2 & feedback3) != FEEDBACK_NONE)
+   {
+      vec4 lod = vec4(textureQueryLod(texture0, uv).y, textureQueryLod(texture1, uv).y,
+                      textureQueryLod(texture2, uv).y, textureQueryLod(texture3, uv).y);
+      uint pixel = uint(gl_FragCoord.y) * 65536u + uint(gl_FragCoord.x);
+      if (hash(pixel ^ hash(feedbackFrame)) % feedbackRate == 0u)
+      {
+         writeFeedback(feedback0, lod.x);
+         writeFeedback(feedback1, lod.y);
+         writeFeedback(feedback2, lod.z);
+         writeFeedback(feedback3, lod.w);
+      }
+   }
+
+   vec4 albedo_texel    = atlas0 != ATLAS_NONE ? sampleAtlas(atlas0, uv) : texture(texture0, uv);
+   vec4 normal_texel    = atlas1 != ATLAS_NONE ? sampleAtlas(atlas1, uv) : texture(texture1, uv);
+   vec4 roughness_texel = atlas2 != ATLAS_NONE ? sampleAtlas(atlas2, uv) : texture(texture2, uv);
+   vec4 metalness_texel = ormPacked ? roughness_texel.yyyy : (atlas3 != ATLAS_NONE ? sampleAtlas(atlas3, uv) : texture(texture3, uv));
 
    normal_texel.xyz = tangentSpace * getNormal(normal_texel);
 
@@ -499,8 +602,13 @@ bool ENG_API Eng::PipelineGeometry::render(glm::mat4& viewMatrix, const Eng::Lis
    static const int data = -1;
    glClearTexImage(reserved->rayBufferIndexTex.getOglHandle(), 0, GL_RED_INTEGER, GL_INT, &data);
 
-   // Render meshes:   
-   list.render(viewMatrix, Eng::List::Pass::meshes);         
+   // Render meshes (LOD from the projected size on screen):   
+   Eng::TextureAtlas::getInstance().render();
+   Eng::List::LodParams lodParams;
+   lodParams.projMatrix = Eng::Camera::getCached().getProjMatrix();
+   lodParams.viewportHeight = static_cast<float>(Eng::Base::getInstance().getWindowSize().y);
+   lodParams.bias = 0.0f;
+   list.render(viewMatrix, Eng::List::Pass::meshes, &lodParams);         
 
    reserved->rayBufferCounter.wait();
 
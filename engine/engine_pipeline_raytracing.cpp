@@ -14,6 +14,9 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <algorithm>
+
    // OGL:      
    #include <GL/glew.h>
    #include <GLFW/glfw3.h>
@@ -98,6 +101,16 @@ struct MaterialStruct
    uint64_t albedoTexHandle;
    uint64_t metalnessTexHandle;
    uint64_t roughnessTexHandle;
+
+   uint albedoSlot;        // Feedback slots of the textures
+   uint metalnessSlot;
+   uint roughnessSlot;
+   uint ormPacked;         // Metalness in the green channel of the roughness texture
+
+   uint albedoAtlas;       // TextureAtlas references (used instead of the handles when set)
+   uint metalnessAtlas;
+   uint roughnessAtlas;
+   uint _pad;
 };
 
 layout(std430, binding=2) buffer MaterialData
@@ -106,6 +119,65 @@ layout(std430, binding=2) buffer MaterialData
 };  
 
 
+///////////
+// ATLAS //
+///////////
+
+#define ATLAS_NONE 0xFFFFFFFFu
+
+layout (binding = 8) uniform sampler2DArray atlasArray[8];
+
+/**
+ * Samples a material texture, either from the TextureAtlas or through its bindless handle.
+ * @param ref array (high 16 bits) and layer (low 16 bits), or ATLAS_NONE
+ * @param handle bindless texture handle
+ * @param uv texture coordinates
+ * @return texel
+ */
+vec4 sampleMaterial(uint ref, uint64_t handle, vec2 uv)
+{
+   if (ref == ATLAS_NONE)
+      return texture(sampler2D(handle), uv);
+
+   // Constant indices, since the array varies per ray:
+   vec3 uvw = vec3(uv, float(ref & 0xFFFFu));
+   switch (ref >> 16)
+   {
+      case 0u: return texture(atlasArray[0], uvw);
+      case 1u: return texture(atlasArray[1], uvw);
+      case 2u: return texture(atlasArray[2], uvw);
+      case 3u: return texture(atlasArray[3], uvw);
+      case 4u: return texture(atlasArray[4], uvw);
+      case 5u: return texture(atlasArray[5], uvw);
+      case 6u: return texture(atlasArray[6], uvw);
+      case 7u: return texture(atlasArray[7], uvw);
+   }
+   return vec4(1.0f);
+}
+
+
+//////////////
+// FEEDBACK //
+//////////////
+
+#define FEEDBACK_NONE 0xFFFFFFFFu
+
+struct FeedbackSlot
+{
+   uint minLevel;
+   uint baseLevel;
+};
+
+layout(std430, binding=7) buffer FeedbackData
+{
+   uint feedbackFrame;
+   uint feedbackRate;
+   uint _pad0;
+   uint _pad1;
+   FeedbackSlot feedbackSlot[];
+};
+
+
 //////////////
 // RAY DATA //
 //////////////
@@ -168,6 +240,9 @@ struct HitInfo
 // Uniforms:
 uniform uint nrOfBSpheres;
 uniform uint nrOfBounces;
+uniform uint feedbackActive;  // Mip feedback enabled when not 0
+uniform vec3 camPos;          // Camera position in world coords
+uniform float pixelSpread;    // Angle covered by a pixel (for ray cones)
 
 ///////////////
 // FUNCTIONS //
@@ -288,9 +363,14 @@ bool intersect(const Ray ray, out HitInfo info)
                   info.u = u;
                   info.v = v;
                   vec2 uv = triangle[i].u[1] * u + triangle[i].u[2] * v + (1.0f - u - v) * triangle[i].u[0];
-                  info.albedo = texture(sampler2D(materials[triangle[i].matId].albedoTexHandle), uv).rgb;
-                  info.metalness = texture(sampler2D(materials[triangle[i].matId].metalnessTexHandle), uv).r;
-                  info.roughness = texture(sampler2D(materials[triangle[i].matId].roughnessTexHandle), uv).r;
+                  const uint m = triangle[i].matId;
+                  info.albedo = sampleMaterial(materials[m].albedoAtlas, materials[m].albedoTexHandle, uv).rgb;
+                  vec4 roughnessTexel = sampleMaterial(materials[m].roughnessAtlas, materials[m].roughnessTexHandle, uv);
+                  info.roughness = roughnessTexel.r;
+                  if (materials[m].ormPacked != 0)
+                     info.metalness = roughnessTexel.g;
+                  else
+                     info.metalness = sampleMaterial(materials[m].metalnessAtlas, materials[m].metalnessTexHandle, uv).r;
          }
       }
 
@@ -313,6 +393,61 @@ bool intersect(const Ray ray, out HitInfo info)
 }
 
 
+/**
+ * Integer hash (for the stochastic subsampling of the feedback).
+ * param x input value
+ * return hashed value
+ */
+uint hash(uint x)
+{
+   x ^= x >> 16;
+   x *= 0x7feb352du;
+   x ^= x >> 15;
+   x *= 0x846ca68bu;
+   x ^= x >> 16;
+   return x;
+}
+
+
+/**
+ * Stores the finest mip level required by a texture lookup.
+ * param slot feedback slot of the texture
+ * param handle bindless texture handle
+ * param footprint ray cone width in UV units
+ */
+void writeSlotFeedback(uint slot, uint64_t handle, float footprint)
+{
+   if (slot == FEEDBACK_NONE)
+      return;
+   vec2 size = vec2(textureSize(sampler2D(handle), 0));
+   float lod = log2(max(footprint * max(size.x, size.y), 1e-8f)) + float(feedbackSlot[slot].baseLevel);
+   atomicMin(feedbackSlot[slot].minLevel, uint(max(lod, 0.0f)));
+}
+
+
+/**
+ * Writes the mip feedback of a hit, using a ray cone to estimate the texture footprint.
+ * param hit hit information
+ * param distance distance travelled by the ray from the camera
+ */
+void writeFeedback(const HitInfo hit, float distance)
+{
+   uint i = hit.triangle;
+   vec2 uvA = triangle[i].u[1] - triangle[i].u[0];
+   vec2 uvB = triangle[i].u[2] - triangle[i].u[0];
+   float uvArea = abs(uvA.x * uvB.y - uvA.y * uvB.x);
+   float worldArea = length(cross(triangle[i].v[1].xyz - triangle[i].v[0].xyz, triangle[i].v[2].xyz - triangle[i].v[0].xyz));
+   if (uvArea <= 0.0f || worldArea <= 0.0f)
+      return;
+
+   float footprint = pixelSpread * distance * sqrt(uvArea / worldArea);
+   uint matId = triangle[i].matId;
+   writeSlotFeedback(materials[matId].albedoSlot, materials[matId].albedoTexHandle, footprint);
+   writeSlotFeedback(materials[matId].metalnessSlot, materials[matId].metalnessTexHandle, footprint);
+   writeSlotFeedback(materials[matId].roughnessSlot, materials[matId].roughnessTexHandle, footprint);
+}
+
+
 /**
  * Ray casting function for tracing a (recursive) ray within the scene.
  * param ray primary ray
@@ -326,9 +461,17 @@ void rayCasting(Ray ray, uint index)
 
    vec3 oldHitNormal = vec3(0.0f);
 
+   // Mip feedback (subsampled):
+   bool feedback = feedbackActive != 0u && hash(index ^ hash(feedbackFrame)) % feedbackRate == 0u;
+   float distance = length(ray.origin - camPos);
+
    for (unsigned int c = 0; c < nrOfBounces; c++)
       if (intersect(ray, hit))
       {
+         distance += hit.t;
+         if (feedback)
+            writeFeedback(hit, distance);
+
          // get and increase counter
          uint newIndex = atomicCounterIncrement(counter);
          rayData[index].next = int(newIndex);
@@ -400,11 +543,22 @@ struct Eng::PipelineRayTracing::Reserved
    uint32_t nrOfMeshes;
    uint32_t nrOfMaterials;
 
+   // Level of detail of the migrated geometry:
+   float lodBias;                ///< Added to the LOD selected from the camera
+   uint32_t minLod;              ///< Finest LOD ever migrated (global RT detail)
+
+   // Materials, to refresh their bindless handles when changed by the TextureStreamer:
+   std::vector<Eng::PipelineRayTracing::MaterialStruct> allMaterials;
+   std::vector<const Eng::Material *> materialRefs;
+   uint64_t nrOfTextureChanges;
+
 
    /**
     * Constructor. 
     */
-   Reserved() : nrOfTriangles{ 0 }, nrOfMeshes{ 0 }, nrOfMaterials{ 0 }
+   Reserved() : nrOfTriangles{ 0 }, nrOfMeshes{ 0 }, nrOfMaterials{ 0 },
+                lodBias{ Eng::PipelineRayTracing::dfltLodBias }, minLod{ 0 },
+                nrOfTextureChanges{ 0 }
    {}
 };
 
@@ -511,7 +665,50 @@ bool ENG_API Eng::PipelineRayTracing::free()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Migrates the data from a standard list into RT-specific structures. 
+ * Sets the bias added to the level of detail of the migrated meshes (see List::selectLod()). Reflections, glossy
+ * ones in particular, rarely need the silhouette accuracy of the G-buffer, so the default selects the next coarser LOD.
+ * @param bias LOD bias (0 = same LODs as the G-buffer)
+ */
+void ENG_API Eng::PipelineRayTracing::setLodBias(float bias)
+{
+   reserved->lodBias = bias;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the bias added to the level of detail of the migrated meshes.
+ * @return LOD bias
+ */
+float ENG_API Eng::PipelineRayTracing::getLodBias() const
+{
+   return reserved->lodBias;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the finest level of detail ever migrated, regardless of the distance from the camera (global RT detail).
+ * Meshes clamp it to their coarsest LOD.
+ * @param lod finest LOD (0 = full detail)
+ */
+void ENG_API Eng::PipelineRayTracing::setMinLod(uint32_t lod)
+{
+   reserved->minLod = lod;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the finest level of detail ever migrated.
+ * @return finest LOD
+ */
+uint32_t ENG_API Eng::PipelineRayTracing::getMinLod() const
+{
+   return reserved->minLod;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Migrates the data from a standard list into RT-specific structures. Each mesh contributes the triangles of the
+ * LOD selected from its projected size with the cached camera (plus the LOD bias), never finer than the min LOD.
  * @param list list of renderables
  * @return TF
  */
@@ -533,15 +730,31 @@ bool ENG_API Eng::PipelineRayTracing::migrate(const Eng::List &list)
    uint32_t nrOfRenderables = list.getNrOfRenderableElems();
    uint32_t nrOfMeshes = nrOfRenderables - nrOfLights;
    uint32_t nrOfMaterials = nrOfRenderables;
-   
+
+   const Eng::Camera &camera = Eng::Camera::getCached();
+   const glm::mat4 viewMatrix = glm::inverse(camera.getWorldMatrix());
+   Eng::List::LodParams lodParams;
+   lodParams.projMatrix = camera.getProjMatrix();
+   lodParams.viewportHeight = static_cast<float>(Eng::Base::getInstance().getWindowSize().y);
+   lodParams.bias = reserved->lodBias;
+
+   std::vector<uint32_t> lods(nrOfMeshes);
+   std::vector<const Eng::Mesh *> meshes(nrOfMeshes);
    for (uint32_t c = nrOfLights; c < nrOfRenderables; c++)
    {
       const Eng::List::RenderableElem &re = list.getRenderableElem(c);
-      const Eng::Mesh &mesh = dynamic_cast<const Eng::Mesh &>(re.reference.get());
-      const Eng::Vbo &vbo = mesh.getVbo();
-      const Eng::Ebo &ebo = mesh.getEbo();
-      nrOfVertices += vbo.getNrOfVertices();
-      nrOfFaces += ebo.getNrOfFaces();
+      meshes[c - nrOfLights] = dynamic_cast<const Eng::Mesh *>(&Eng::Node::resolve(re.reference));
+      if (meshes[c - nrOfLights] == nullptr)
+      {
+         ENG_LOG_ERROR("Mesh destroyed since the list was built");
+         return false;
+      }
+      const Eng::Mesh &mesh = *meshes[c - nrOfLights];
+      mesh.getVbo(); // Loads lazy meshes
+      const uint32_t lod = std::max(Eng::List::selectLod(viewMatrix, re, lodParams), reserved->minLod);
+      lods[c - nrOfLights] = lod;
+      nrOfVertices += mesh.getLod(lod).nrOfVertices;
+      nrOfFaces += mesh.getLod(lod).nrOfFaces;
    }
 
    // ENG_LOG_DEBUG("Tot. nr. of faces . . :  %u", nrOfFaces);
@@ -553,7 +766,9 @@ bool ENG_API Eng::PipelineRayTracing::migrate(const Eng::List &list)
    std::vector<Eng::PipelineRayTracing::TriangleStruct> allTriangles(nrOfFaces);
    std::vector<Eng::PipelineRayTracing::BSphereStruct> allBSpheres(nrOfMeshes);
    std::vector<Eng::PipelineRayTracing::MaterialStruct> allMaterials(nrOfMaterials);
+   std::vector<const Eng::Material *> materialRefs(nrOfMaterials, nullptr);
    nrOfFaces = 0; // Reset counter
+   const Eng::TextureStreamer &streamer = Eng::TextureStreamer::getInstance();
 
    for (uint32_t c = 0; c < nrOfRenderables; c++)
    {
@@ -572,30 +787,46 @@ bool ENG_API Eng::PipelineRayTracing::migrate(const Eng::List &list)
       // Meshes (and bounding spheres):
       else
       {
-         const Eng::Mesh &mesh = dynamic_cast<const Eng::Mesh &>(re.reference.get());
+         const Eng::Mesh &mesh = *meshes[c - nrOfLights];
          
-         // Read VBO back:
+         // Read VBO back (selected LOD only):
+         const Eng::Mesh::Lod &lod = mesh.getLod(lods[c - nrOfLights]);
          const Eng::Vbo &vbo = mesh.getVbo();
-         std::vector<Eng::Vbo::VertexData> vData(vbo.getNrOfVertices());
+         std::vector<Eng::Vbo::VertexData> vData(lod.nrOfVertices);
 
          glBindBuffer(GL_ARRAY_BUFFER, vbo.getOglHandle());
-         glGetBufferSubData(GL_ARRAY_BUFFER, 0, vbo.getNrOfVertices() * sizeof(Eng::Vbo::VertexData), vData.data());         
+         glGetBufferSubData(GL_ARRAY_BUFFER, lod.firstVertex * sizeof(Eng::Vbo::VertexData), lod.nrOfVertices * sizeof(Eng::Vbo::VertexData), vData.data());         
 
-         // Read EBO back:
+         // Read EBO back (16-bit indices are widened):
          const Eng::Ebo &ebo = mesh.getEbo();
-         std::vector<Eng::Ebo::FaceData> fData(ebo.getNrOfFaces());
+         const uint32_t indexSize = ebo.getIndexSize();
+         std::vector<Eng::Ebo::FaceData> fData(lod.nrOfFaces);
 
          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.getOglHandle());
-         glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, ebo.getNrOfFaces() * sizeof(Eng::Ebo::FaceData), fData.data());
+         if (indexSize == sizeof(uint16_t))
+         {
+            std::vector<uint16_t> shortIndices(3 * static_cast<size_t>(lod.nrOfFaces));
+            glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, lod.firstFace * 3 * indexSize, lod.nrOfFaces * 3 * indexSize, shortIndices.data());
+            for (uint32_t f = 0; f < lod.nrOfFaces; f++)
+            {
+               fData[f].a = shortIndices[3 * f + 0];
+               fData[f].b = shortIndices[3 * f + 1];
+               fData[f].c = shortIndices[3 * f + 2];
+            }
+         }
+         else
+            glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, lod.firstFace * 3 * indexSize, lod.nrOfFaces * 3 * indexSize, fData.data());
          
          // ENG_LOG_DEBUG("Object: %s, data: %s, face: %u, %u, %u", mesh.getName().c_str(), glm::to_string(vData[0].vertex).c_str(), fData[0].a, fData[0].b, fData[0].c);
 
-         // Bounding sphere:
+         // Bounding sphere (world coordinates, around the bounds center, enclosing the migrated LOD):
          Eng::PipelineRayTracing::BSphereStruct s;
          s.firstTriangle = nrOfFaces;
-         s.nrOfTriangles = ebo.getNrOfFaces();
-         s.radius = mesh.getRadius();
-         s.position = modelMat[3];
+         s.nrOfTriangles = lod.nrOfFaces;
+         s.position = glm::vec4(re.center, 1.0f);
+         s.radius = 0.0f;
+         for (const Eng::Vbo::VertexData &v : vData)
+            s.radius = std::max(s.radius, glm::distance(re.center, glm::vec3(modelMat * glm::vec4(v.vertex, 1.0f))));
          allBSpheres[c - nrOfLights] = s;
 
          const Eng::Material& material = mesh.getMaterial();
@@ -609,10 +840,18 @@ bool ENG_API Eng::PipelineRayTracing::migrate(const Eng::List &list)
          m.albedoTexHandle = material.getTexture(Eng::Texture::Type::albedo).getOglBindlessHandle();
          m.metalnessTexHandle = material.getTexture(Eng::Texture::Type::metalness).getOglBindlessHandle();
          m.roughnessTexHandle = material.getTexture(Eng::Texture::Type::roughness).getOglBindlessHandle();
+         m.albedoSlot = streamer.getSlot(material.getTexture(Eng::Texture::Type::albedo));
+         m.metalnessSlot = streamer.getSlot(material.getTexture(Eng::Texture::Type::metalness));
+         m.roughnessSlot = streamer.getSlot(material.getTexture(Eng::Texture::Type::roughness));
+         m.ormPacked = material.isOrmPacked();
+         m.albedoAtlas = material.getAtlasRef(Eng::Texture::Type::albedo);
+         m.metalnessAtlas = material.getAtlasRef(Eng::Texture::Type::metalness);
+         m.roughnessAtlas = material.getAtlasRef(Eng::Texture::Type::roughness);
          allMaterials[c - nrOfLights] = m;
+         materialRefs[c - nrOfLights] = &material;
 
          // Copy faces and vertices into the std::vector:
-         for (uint32_t f = 0; f < ebo.getNrOfFaces(); f++)
+         for (uint32_t f = 0; f < lod.nrOfFaces; f++)
          {
             Eng::PipelineRayTracing::TriangleStruct t;
             t.matId = c - nrOfLights;
@@ -649,6 +888,9 @@ bool ENG_API Eng::PipelineRayTracing::migrate(const Eng::List &list)
    reserved->nrOfTriangles = nrOfFaces;
    reserved->nrOfMeshes = nrOfMeshes;
    reserved->nrOfMaterials = nrOfMaterials;
+   reserved->allMaterials = std::move(allMaterials);
+   reserved->materialRefs = std::move(materialRefs);
+   reserved->nrOfTextureChanges = Eng::TextureStreamer::getInstance().getNrOfChanges();
    return true;
 }
 
@@ -692,16 +934,36 @@ bool ENG_API Eng::PipelineRayTracing::render(const Eng::Camera &camera, const En
    }   
    program.render();     
 
+   // Streamed textures have new bindless handles:
+   const uint64_t nrOfTextureChanges = Eng::TextureStreamer::getInstance().getNrOfChanges();
+   if (nrOfTextureChanges != reserved->nrOfTextureChanges)
+   {
+      for (uint32_t c = 0; c < reserved->materialRefs.size(); c++)
+         if (reserved->materialRefs[c])
+         {
+            const Eng::Material &material = *reserved->materialRefs[c];
+            reserved->allMaterials[c].albedoTexHandle = material.getTexture(Eng::Texture::Type::albedo).getOglBindlessHandle();
+            reserved->allMaterials[c].metalnessTexHandle = material.getTexture(Eng::Texture::Type::metalness).getOglBindlessHandle();
+            reserved->allMaterials[c].roughnessTexHandle = material.getTexture(Eng::Texture::Type::roughness).getOglBindlessHandle();
+         }
+      reserved->materials.create(reserved->allMaterials.size() * sizeof(Eng::PipelineRayTracing::MaterialStruct), reserved->allMaterials.data());
+      reserved->nrOfTextureChanges = nrOfTextureChanges;
+   }
+
    // Bindings:
    reserved->triangles.render(0);
    reserved->bspheres.render(1);
    reserved->materials.render(2);
    geometryPipe.getRayBuffer().render(3);
+   Eng::TextureAtlas::getInstance().render();
    geometryPipe.getRayBufferCounter().render(4);
 
    // Uniforms:
    program.setUInt("nrOfBSpheres", reserved->nrOfMeshes);
    program.setUInt("nrOfBounces", nrOfBounces);
+   program.setUInt("feedbackActive", Eng::TextureStreamer::getInstance().isFeedbackActive());
+   program.setVec3("camPos", glm::vec3(camera.getWorldMatrix()[3]));
+   program.setFloat("pixelSpread", 2.0f / (camera.getProjMatrix()[1][1] * Eng::Base::getInstance().getWindowSize().y));
 
    // Execute:
    program.computeIndirect(geometryPipe.getWorkgroupCount().getOglHandle());
@@ -54,6 +54,16 @@ public: //
       uint64_t albedoTexHandle;
       uint64_t metalnessTexHandle;
       uint64_t roughnessTexHandle;
+
+      uint32_t albedoSlot;       // TextureStreamer feedback slots
+      uint32_t metalnessSlot;
+      uint32_t roughnessSlot;
+      uint32_t ormPacked;        // Metalness in the green channel of the roughness texture
+
+      uint32_t albedoAtlas;      // TextureAtlas references (used instead of the handles when set)
+      uint32_t metalnessAtlas;
+      uint32_t roughnessAtlas;
+      uint32_t _pad;
    };
 
 
@@ -83,12 +93,22 @@ public: //
    };
    
 
+   // Special values:
+   constexpr static float dfltLodBias = 1.0f;             ///< Default LOD bias (reflections use coarser LODs)
+
+
    // Const/dest:
    PipelineRayTracing();      
    PipelineRayTracing(PipelineRayTracing &&other);
    PipelineRayTracing(PipelineRayTracing const&) = delete;   
    virtual ~PipelineRayTracing(); 
 
+   // Get/set:
+   void setLodBias(float bias);
+   float getLodBias() const;
+   void setMinLod(uint32_t lod);
+   uint32_t getMinLod() const;
+
    // Data preparation:
    bool migrate(const Eng::List &list);
 
@@ -81,12 +81,13 @@ struct Eng::PipelineShadowMapping::Reserved
    Eng::Fbo fbo;
 
    uint32_t shadowMapCount;
+   float lodBias;                ///< Added to the LOD selected for shadow casters
 
 
    /**
     * Constructor. 
     */
-   Reserved() : shadowMapCount{ 0 }
+   Reserved() : shadowMapCount{ 0 }, lodBias{ Eng::PipelineShadowMapping::dfltLodBias }
    {}
 };
 
@@ -160,6 +161,27 @@ const Eng::Texture ENG_API *Eng::PipelineShadowMapping::getShadowMaps() const
    return reserved->depthMaps;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the bias added to the level of detail of shadow casters (see List::selectLod()). Depth maps rarely need
+ * the silhouette accuracy of the G-buffer, so the default selects the next coarser LOD.
+ * @param bias LOD bias (0 = same LODs as the camera at the same distance)
+ */
+void ENG_API Eng::PipelineShadowMapping::setLodBias(float bias)
+{
+   reserved->lodBias = bias;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the bias added to the level of detail of shadow casters.
+ * @return LOD bias
+ */
+float ENG_API Eng::PipelineShadowMapping::getLodBias() const
+{
+   return reserved->lodBias;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Initializes this pipeline with 1 shadowmap.
@@ -282,12 +304,13 @@ bool ENG_API Eng::PipelineShadowMapping::render(const Eng::List &list)
       
       const Eng::List::RenderableElem& lightRe = list.getRenderableElem(i);
       
-      if (dynamic_cast<const Eng::Light&>(lightRe.reference.get()) == Eng::Light::empty) {
+      const Eng::Light* lightPtr = dynamic_cast<const Eng::Light*>(&Eng::Node::resolve(lightRe.reference));
+      if (lightPtr == nullptr || *lightPtr == Eng::Light::empty) {
          ENG_LOG_ERROR("Invalid params");
          return false;
       }
 
-      const Eng::Light& light = dynamic_cast<const Eng::Light&>(lightRe.reference.get());
+      const Eng::Light& light = *lightPtr;
 
       program.render();
       program.setMat4("projectionMat", light.getProjMatrix());
@@ -307,8 +330,12 @@ bool ENG_API Eng::PipelineShadowMapping::render(const Eng::List &list)
       // Light source is the camera:
       glm::mat4 viewMatrix = glm::inverse(lightRe.matrix);
 
-      // Render meshes:   
-      list.render(viewMatrix, Eng::List::Pass::meshes);
+      // Render meshes (LOD from the projected size in the depth map):   
+      Eng::List::LodParams lodParams;
+      lodParams.projMatrix = light.getProjMatrix();
+      lodParams.viewportHeight = static_cast<float>(depthTextureSize);
+      lodParams.bias = reserved->lodBias;
+      list.render(viewMatrix, Eng::List::Pass::meshes, &lodParams);
 
       // Redo OpenGL settings:
       glCullFace(GL_BACK);
@@ -19,6 +19,7 @@ public: //
 
    // Special values:
    constexpr static uint32_t depthTextureSize = 2048;     ///< Size of the depth map
+   constexpr static float dfltLodBias = 1.0f;             ///< Default LOD bias (shadow casters use coarser LODs)
 
    
    // Const/dest:
@@ -30,6 +31,8 @@ public: //
    // Get/set:
    const uint32_t getShadowMapCount() const;
    const Eng::Texture* getShadowMaps() const;
+   void setLodBias(float bias);
+   float getLodBias() const;
 
    // Rendering methods:
    // bool render(uint32_t value = 0, void *data = nullptr) const = delete;
@@ -0,0 +1,310 @@
+/**
+ * @file		engine_pool.h
+ * @brief	Chunked storage with stable addresses and generational handles
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Weak reference to an object stored in a Pool (or to a Node, see Node::resolve()): the slot of the object plus the generation of that slot, which
+ *        changes whenever the slot is reused. A handle outliving its object resolves to nothing instead of
+ *        dangling. Trivially copyable (can be stored and serialized as is); the default value references nothing.
+ */
+template <typename T> struct Handle
+{
+   uint32_t index;                              ///< Slot in the pool
+   uint32_t generation;                         ///< Generation of the slot (0 = null handle)
+
+
+   /**
+    * Constructor.
+    */
+   Handle() noexcept : index{ 0 }, generation{ 0 }
+   {}
+
+
+   /**
+    * Constructor.
+    * @param index slot in the pool
+    * @param generation generation of the slot
+    */
+   Handle(uint32_t index, uint32_t generation) noexcept : index{ index }, generation{ generation }
+   {}
+
+
+   /**
+    * Tells whether this handle references nothing.
+    * @return TF
+    */
+   bool isNull() const
+   {
+      return generation == 0;
+   }
+
+
+   bool operator==(const Handle &other) const { return index == other.index && generation == other.generation; }
+   bool operator!=(const Handle &other) const { return !(*this == other); }
+};
+
+
+
+/**
+ * @brief Storage for objects of one type. Objects are moved into fixed-size chunks allocated on demand, so that they
+ *        are contiguous in memory and never move: references stay valid until the object is removed. Slots freed by
+ *        remove() are reused by the next add(), each add() with a new generation (see Handle). Iteration visits the
+ *        live objects in slot order. T derives from Eng::Object, which keeps its slot to map addresses to handles
+ *        in O(1).
+ */
+template <typename T, uint32_t chunkSize = 256> class Pool
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief Forward iterator over the live objects.
+    */
+   class Iterator
+   {
+   public:
+
+      /**
+       * Constructor.
+       * @param pool iterated pool
+       * @param slot first slot to consider
+       */
+      Iterator(const Pool *pool, uint32_t slot) : pool{ pool }, slot{ slot }
+      {
+         skip();
+      }
+
+      T &operator*() const { return *pool->at(slot); }
+      T *operator->() const { return pool->at(slot); }
+      bool operator==(const Iterator &other) const { return slot == other.slot; }
+      bool operator!=(const Iterator &other) const { return slot != other.slot; }
+
+      Iterator &operator++()
+      {
+         slot++;
+         skip();
+         return *this;
+      }
+
+   private:
+
+      /**
+       * Moves to the next live slot.
+       */
+      void skip()
+      {
+         while (slot < pool->nrOfSlots && pool->isLive(slot) == false)
+            slot++;
+      }
+
+      const Pool *pool;
+      uint32_t slot;
+   };
+
+
+   // Special values:
+   static constexpr uint32_t none = 0xFFFFFFFF;
+
+   // Const/dest:
+   Pool() : nrOfSlots{ 0 }, nrOfObjects{ 0 }, last{ none }, nextGeneration{ 1 }
+   {}
+   Pool(Pool const &) = delete;
+   ~Pool()
+   {
+      clear();
+   }
+
+   // Operators:
+   void operator=(Pool const &) = delete;
+
+
+   /**
+    * Moves an object into the pool.
+    * @param obj object to move
+    * @return reference to the stored object (valid until removed)
+    */
+   T &add(T &&obj)
+   {
+      uint32_t slot;
+      if (freeSlots.empty() == false)
+      {
+         slot = freeSlots.back();
+         freeSlots.pop_back();
+      }
+      else
+      {
+         if (nrOfSlots == chunks.size() * chunkSize)
+            chunks.push_back(std::make_unique<Chunk>());
+         slot = nrOfSlots++;
+      }
+
+      T *stored = new (at(slot)) T(std::move(obj));
+      stored->setPoolSlot(slot);
+      chunks[slot / chunkSize]->live[slot % chunkSize] = true;
+      chunks[slot / chunkSize]->generation[slot % chunkSize] = nextGeneration;
+      if (++nextGeneration == 0) // 0 is reserved to null handles
+         nextGeneration = 1;
+      nrOfObjects++;
+      last = slot;
+      return *stored;
+   }
+
+
+   /**
+    * Destroys an object of the pool and frees its slot.
+    * @param obj object stored in this pool
+    * @return TF (false when the object is not in the pool)
+    */
+   bool remove(const T &obj)
+   {
+      const uint32_t slot = find(&obj);
+      if (slot == none)
+         return false;
+
+      at(slot)->~T();
+      chunks[slot / chunkSize]->live[slot % chunkSize] = false;
+      freeSlots.push_back(slot);
+      nrOfObjects--;
+      if (last == slot)
+         last = none;
+      return true;
+   }
+
+
+   /**
+    * Destroys all the objects (in slot order) and releases the chunks. Generations keep increasing, so handles to
+    * the destroyed objects stay invalid.
+    */
+   void clear()
+   {
+      for (uint32_t slot = 0; slot < nrOfSlots; slot++)
+         if (isLive(slot))
+         {
+            at(slot)->~T();
+            chunks[slot / chunkSize]->live[slot % chunkSize] = false;
+         }
+      chunks.clear();
+      freeSlots.clear();
+      nrOfSlots = 0;
+      nrOfObjects = 0;
+      last = none;
+   }
+
+
+   /**
+    * Gets the handle of an object of the pool.
+    * @param obj object stored in this pool
+    * @return handle (null when the object is not in the pool)
+    */
+   Handle<T> getHandle(const T &obj) const
+   {
+      const uint32_t slot = find(&obj);
+      if (slot == none)
+         return Handle<T>();
+      return Handle<T>(slot, chunks[slot / chunkSize]->generation[slot % chunkSize]);
+   }
+
+
+   /**
+    * Resolves a handle.
+    * @param handle handle returned by getHandle()
+    * @return pointer to the object, or nullptr when null or removed since
+    */
+   T *get(const Handle<T> &handle) const
+   {
+      if (handle.isNull() || handle.index >= nrOfSlots || isLive(handle.index) == false ||
+          chunks[handle.index / chunkSize]->generation[handle.index % chunkSize] != handle.generation)
+         return nullptr;
+      return at(handle.index);
+   }
+
+
+   /**
+    * Gets the last added object.
+    * @return pointer to the object, or nullptr when empty or removed since
+    */
+   T *getLast() const
+   {
+      return (last == none) ? nullptr : at(last);
+   }
+
+
+   /**
+    * Gets the number of live objects.
+    * @return number of objects
+    */
+   uint32_t getNrOfObjects() const
+   {
+      return nrOfObjects;
+   }
+
+
+   // Iteration:
+   Iterator begin() const { return Iterator(this, 0); }
+   Iterator end() const { return Iterator(this, nrOfSlots); }
+
+
+///////////
+private: //
+///////////
+
+   /**
+    * @brief Block of chunkSize slots.
+    */
+   struct Chunk
+   {
+      alignas(T) uint8_t storage[chunkSize * sizeof(T)];
+      bool live[chunkSize] = {};
+      uint32_t generation[chunkSize];            ///< Assigned by add(), unique within the pool
+   };
+
+
+   /**
+    * Gets the storage of a slot.
+    * @param slot slot index
+    * @return pointer to the (possibly unconstructed) object
+    */
+   T *at(uint32_t slot) const
+   {
+      return reinterpret_cast<T *>(chunks[slot / chunkSize]->storage) + slot % chunkSize;
+   }
+
+
+   /**
+    * Tells whether a slot holds an object.
+    * @param slot slot index
+    * @return TF
+    */
+   bool isLive(uint32_t slot) const
+   {
+      return chunks[slot / chunkSize]->live[slot % chunkSize];
+   }
+
+
+   /**
+    * Gets the slot of an object.
+    * @param obj object address
+    * @return slot index, or none when not a live object of this pool
+    */
+   uint32_t find(const T *obj) const
+   {
+      // The slot kept by the object may come from another pool:
+      const uint32_t slot = obj->getPoolSlot();
+      return (slot < nrOfSlots && isLive(slot) && at(slot) == obj) ? slot : none;
+   }
+
+
+   std::vector<std::unique_ptr<Chunk>> chunks;   ///< Storage
+   std::vector<uint32_t> freeSlots;              ///< Slots released by remove()
+   uint32_t nrOfSlots;                           ///< Slots used so far (live or free)
+   uint32_t nrOfObjects;                         ///< Live objects
+   uint32_t last;                                ///< Slot of the last added object
+   uint32_t nextGeneration;                      ///< Generation of the next added object
+};
@@ -15,6 +15,7 @@
    #include "engine.h"
 
    // C/C++:
+   #include <algorithm>
    #include <iterator>
 
 
@@ -40,13 +41,42 @@ struct Eng::Serializer::Reserved
    uint64_t position;
    uint64_t nrOfBytes;
    std::vector<uint8_t> data;
+   std::shared_ptr<Eng::MappedFile> file;    ///< Read-only file view (replaces data when used)
+   bool overflow;                            ///< A read went past the end
 
 
    /**
     * Constructor.
     */
-   Reserved() : position{ 0 }, nrOfBytes{ 0 }
+   Reserved() : position{ 0 }, nrOfBytes{ 0 }, overflow{ false }
    {}
+
+   /**
+    * Pointer to the first serialized byte, either owned or mapped.
+    * @return pointer to serialized data
+    */
+   inline const uint8_t *getView() const
+   {
+      return file ? file->getData() : data.data();
+   }
+
+   /**
+    * Checks that a number of bytes is available at the current position. Otherwise, raises the overflow flag
+    * (logging only the first time) and moves to the end, so that all the following reads fail too.
+    * @param size number of bytes to read
+    * @return TF
+    */
+   inline bool fits(uint64_t size)
+   {
+      if (size <= nrOfBytes - position)
+         return true;
+
+      if (!overflow)
+         ENG_LOG_ERROR("Buffer overflow at offset %llu (%llu bytes requested)", (unsigned long long) position, (unsigned long long) size);
+      overflow = true;
+      position = nrOfBytes;
+      return false;
+   }
 };
 
 
@@ -118,13 +148,12 @@ void ENG_API Eng::Serializer::operator=(const Serializer &other)
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Pointer to serialized data.
+ * Pointer to serialized data. Mapped serializers are read-only: don't write through this pointer.
  * @return pointer to serialized data
  */
 void ENG_API *Eng::Serializer::getData() const
 {
-   reserved->data.shrink_to_fit();
-   return static_cast<void *>(reserved->data.data());   
+   return const_cast<uint8_t *>(reserved->getView());
 }
 
 
@@ -137,9 +166,41 @@ void ENG_API *Eng::Serializer::getDataAtCurPos() const
 {
    if (reserved->position >= reserved->nrOfBytes)
       return nullptr;
+   return const_cast<uint8_t *>(reserved->getView() + reserved->position);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns true when the serializer reads from a memory-mapped file.
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::isMapped() const
+{
+   return reserved->file != nullptr;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Maps a file read-only and uses it as serialized data, without copying it into memory.
+ * @param filename file name
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::map(const std::string &filename)
+{
+   std::shared_ptr<Eng::MappedFile> file = std::make_shared<Eng::MappedFile>();
+   if (file->open(filename) == false)
+      return false;
 
-   reserved->data.shrink_to_fit();
-   return static_cast<void *>(reserved->data.data() + reserved->position);
+   // Replace content:
+   clear();
+   std::vector<uint8_t>().swap(reserved->data);
+   reserved->file = file;
+   reserved->nrOfBytes = file->getNrOfBytes();
+
+   // Done:
+   return true;
 }
 
 
@@ -154,6 +215,60 @@ uint64_t ENG_API Eng::Serializer::getNrOfBytes() const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the current deserializing position.
+ * @return offset in bytes from the beginning of the serialized data
+ */
+uint64_t ENG_API Eng::Serializer::getPosition() const
+{
+   return reserved->position;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Moves the deserializing position.
+ * @param position offset in bytes from the beginning of the serialized data
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::setPosition(uint64_t position)
+{
+   // Safety net:
+   if (position > reserved->nrOfBytes)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Done:
+   reserved->position = position;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether a read went past the end of the data since the last reset(), clear() or map().
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::hasOverflow() const
+{
+   return reserved->overflow;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the mapped file used as serialized data. Holding the returned pointer keeps the mapping alive.
+ * @return mapped file, or nullptr if the serializer owns its data
+ */
+std::shared_ptr<const Eng::MappedFile> ENG_API Eng::Serializer::getMappedFile() const
+{
+   return reserved->file;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Resets the internal data. 
@@ -161,6 +276,7 @@ uint64_t ENG_API Eng::Serializer::getNrOfBytes() const
 void ENG_API Eng::Serializer::reset()
 {  
    reserved->position = 0;
+   reserved->overflow = false;
 }
 
 
@@ -171,8 +287,141 @@ void ENG_API Eng::Serializer::reset()
 void ENG_API Eng::Serializer::clear()
 {
    reserved->data.clear();
+   reserved->file.reset();
    reserved->position = 0;
    reserved->nrOfBytes = 0;
+   reserved->overflow = false;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a string (zero-terminated).
+ * @param text string to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const std::string &text)
+{
+   return serialize(text.c_str(), text.size() + 1);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a byte.
+ * @param byte byte to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(uint8_t byte)
+{
+   return serialize(&byte, sizeof(uint8_t));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a boolean.
+ * @param _bool boolean to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(bool _bool)
+{
+   return serialize(&_bool, sizeof(bool));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a uint.
+ * @param uint unsigned int to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(uint32_t uint)
+{
+   return serialize(&uint, sizeof(uint32_t));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a float.
+ * @param _float float to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(float _float)
+{
+   return serialize(&_float, sizeof(float));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a vec3.
+ * @param vec vec3 to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const glm::vec3 &vec)
+{
+   return serialize(&vec, sizeof(glm::vec3));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a vec4.
+ * @param vec vec4 to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const glm::vec4 &vec)
+{
+   return serialize(&vec, sizeof(glm::vec4));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a mat4.
+ * @param mat mat4 to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const glm::mat4 &mat)
+{
+   return serialize(&mat, sizeof(glm::mat4));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a series of raw bytes at the current position, growing the data if needed.
+ * @param rawData pointer to data
+ * @param nrOfBytes number of bytes
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const void *rawData, uint64_t nrOfBytes)
+{
+   // Safety net:
+   if (rawData == nullptr && nrOfBytes)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (isMapped())
+   {
+      ENG_LOG_ERROR("Mapped serializers are read-only");
+      return false;
+   }
+
+   // Grow and store:
+   const uint64_t end = reserved->position + nrOfBytes;
+   if (end > reserved->data.size())
+      reserved->data.resize(end);
+   if (nrOfBytes)
+      memcpy(reserved->data.data() + reserved->position, rawData, nrOfBytes);
+   reserved->position = end;
+   reserved->nrOfBytes = std::max(reserved->nrOfBytes, end);
+
+   // Done:
+   return true;
 }
 
 
@@ -184,15 +433,14 @@ void ENG_API Eng::Serializer::clear()
  */
 bool ENG_API Eng::Serializer::deserialize(std::string &text)
 { 
-   uint32_t size = (uint32_t) strlen((char *)(&reserved->data[reserved->position]));   
-   if (reserved->position + size > reserved->nrOfBytes)
+   const uint64_t start = reserved->position;
+   const std::string_view view = deserializeString();
+   if (reserved->position == start)
    {
-      ENG_LOG_ERROR("Corrupted serialization");
+      text.clear();
       return false;
    }
-   text.resize(size);
-   deserialize(text.data(), size);
-   reserved->position++;
+   text.assign(view.data(), view.size());
 
    // Done:
    return true;
@@ -319,16 +567,60 @@ bool ENG_API Eng::Serializer::deserialize(void *rawData, uint64_t nrOfBytes)
       ENG_LOG_ERROR("Invalid params");
       return false;
    }
-   if (reserved->position + nrOfBytes > reserved->nrOfBytes)
-   {
-      ENG_LOG_ERROR("Buffer overflow");
+   if (reserved->fits(nrOfBytes) == false)
       return false;
-   }
 
    // Increase and store:   
-   memcpy(rawData, &reserved->data[reserved->position], nrOfBytes);
+   memcpy(rawData, reserved->getView() + reserved->position, nrOfBytes);
    reserved->position += nrOfBytes;
 
    // Done:
    return true;
 }
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns a pointer to the next series of raw bytes and moves past them, without copying. 
+ * The pointer is valid as long as the serializer (or a copy sharing the same mapping) is alive and unmodified.
+ * @param nrOfBytes number of bytes
+ * @return pointer to the bytes, or nullptr on overflow
+ */
+const void ENG_API *Eng::Serializer::deserializeSpan(uint64_t nrOfBytes)
+{
+   // Safety net:
+   if (reserved->fits(nrOfBytes) == false)
+      return nullptr;
+
+   // Move on:
+   const uint8_t *ptr = reserved->getView() + reserved->position;
+   reserved->position += nrOfBytes;
+
+   // Done:
+   return ptr;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns a view on the next zero-terminated string and moves past it, without copying. The terminator is only
+ * searched within the data, so unterminated strings raise the overflow flag. Same lifetime as deserializeSpan().
+ * @return string (without terminator), empty on overflow
+ */
+std::string_view ENG_API Eng::Serializer::deserializeString()
+{
+   const char *str = reinterpret_cast<const char *>(reserved->getView() + reserved->position);
+   const void *end = reserved->position < reserved->nrOfBytes ? memchr(str, 0, reserved->nrOfBytes - reserved->position) : nullptr;
+   if (end == nullptr)
+   {
+      reserved->fits(reserved->nrOfBytes - reserved->position + 1);
+      return std::string_view();
+   }
+
+   // Move past the terminator:
+   const uint64_t length = static_cast<const char *>(end) - str;
+   reserved->position += length + 1;
+
+   // Done:
+   return std::string_view(str, length);
+}
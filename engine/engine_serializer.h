@@ -9,7 +9,10 @@
 
 
  /**
-  * @brief Class for (de)serializing data (from)to memory.
+  * @brief Class for (de)serializing data (from)to memory. Writes overwrite the data at the current position and grow
+  *        it as needed (mapped serializers are read-only). Reads past the end fail, move the position to the end and
+  *        raise an overflow flag, so that loaders can check hasOverflow() once at the end of a chunk instead of
+  *        testing every field.
   */
 class ENG_API Serializer
 {
@@ -31,12 +34,29 @@ public: //
 
    // Get/set:
    void *getData() const;
+   bool isMapped() const;
    void *getDataAtCurPos() const;
    uint64_t getNrOfBytes() const;
+   uint64_t getPosition() const;
+   bool setPosition(uint64_t position);
+   bool hasOverflow() const;
+   std::shared_ptr<const Eng::MappedFile> getMappedFile() const;
+
+   // Mapping:
+   bool map(const std::string &filename);
 
    // Serialization:
    void clear();
    void reset();  
+   bool serialize(const std::string &text);
+   bool serialize(uint8_t byte);
+   bool serialize(bool _bool);
+   bool serialize(uint32_t uint);
+   bool serialize(float _float);
+   bool serialize(const glm::vec3 &vec);
+   bool serialize(const glm::vec4 &vec);
+   bool serialize(const glm::mat4 &mat);
+   bool serialize(const void *rawData, uint64_t nrOfBytes);
    bool deserialize(std::string &text);
    bool deserialize(uint8_t &byte);
    bool deserialize(bool &_bool);
@@ -46,6 +66,55 @@ public: //
    bool deserialize(glm::vec4 &vec);
    bool deserialize(glm::mat4 &mat);
    bool deserialize(void *rawData, uint64_t nrOfBytes);   
+   const void *deserializeSpan(uint64_t nrOfBytes);
+   std::string_view deserializeString();
+
+
+   /**
+    * Returns a pointer to the next count elements of type T and moves past them, without copying. Same lifetime as
+    * deserializeSpan(). Elements are not aligned within the file: only use types with an alignment of 1, or
+    * targets tolerating unaligned loads (x86/x64).
+    * @param count number of elements
+    * @return pointer to the elements, or nullptr on overflow
+    */
+   template <typename T> const T *readSpan(uint64_t count)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "Trivially copyable types only");
+      if (count > UINT64_MAX / sizeof(T))
+         return static_cast<const T *>(deserializeSpan(UINT64_MAX));
+      return static_cast<const T *>(deserializeSpan(count * sizeof(T)));
+   }
+
+
+   /**
+    * Reads a value of type T.
+    * @param value value to deserialize (zeroed on overflow)
+    * @return TF
+    */
+   template <typename T> bool read(T &value)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "Trivially copyable types only");
+      const void *ptr = deserializeSpan(sizeof(T));
+      if (ptr == nullptr)
+      {
+         memset(&value, 0, sizeof(T));
+         return false;
+      }
+      memcpy(&value, ptr, sizeof(T));
+      return true;
+   }
+
+
+   /**
+    * Writes a value of type T.
+    * @param value value to serialize
+    * @return TF
+    */
+   template <typename T> bool write(const T &value)
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "Trivially copyable types only");
+      return serialize(&value, sizeof(T));
+   }
 
 
 /////////////
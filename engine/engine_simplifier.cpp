@@ -0,0 +1,589 @@
+/**
+ * @file		engine_simplifier.cpp
+ * @brief	Automatic LOD generation
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <cmath>
+   #include <unordered_map>
+
+   // GLM:
+   #include <glm/gtc/packing.hpp>
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Special values:
+   static constexpr uint32_t none = 0xFFFFFFFF;
+
+
+/**
+ * Symmetric 4x4 quadric (sum of squared distances from a set of planes, weighted by face area).
+ */
+struct Quadric
+{
+   double a00, a01, a02, a11, a12, a22;         ///< Upper 3x3 block
+   double b0, b1, b2;                           ///< Linear term
+   double c;                                    ///< Constant term
+   double area;                                 ///< Sum of the weights
+
+
+   /**
+    * Adds a plane.
+    * @param n unit normal
+    * @param d plane offset (n.p + d = 0)
+    * @param w weight
+    */
+   inline void addPlane(const glm::dvec3 &n, double d, double w)
+   {
+      a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+      a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+      b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+      c += w * d * d;
+      area += w;
+   }
+
+
+   /**
+    * Adds another quadric.
+    * @param q quadric
+    */
+   inline void add(const Quadric &q)
+   {
+      a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+      b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c; area += q.area;
+   }
+
+
+   /**
+    * Evaluates the quadric at a point.
+    * @param p point
+    * @return weighted sum of squared distances
+    */
+   inline double evaluate(const glm::vec3 &p) const
+   {
+      const double x = p.x, y = p.y, z = p.z;
+      const double e = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + a11 * y * y + 2.0 * a12 * y * z + a22 * z * z +
+                       2.0 * (b0 * x + b1 * y + b2 * z) + c;
+      return std::max(e, 0.0);
+   }
+};
+
+
+/**
+ * Unpacked vertex attributes, compared by the collapse cost.
+ */
+struct Attributes
+{
+   glm::vec3 normal;
+   glm::vec2 uv;
+   glm::vec3 tangent;
+};
+
+
+/**
+ * Position used to weld vertices split by attribute seams (bitwise comparison).
+ */
+struct PositionKey
+{
+   uint32_t x, y, z;
+
+   inline bool operator==(const PositionKey &other) const
+   {
+      return x == other.x && y == other.y && z == other.z;
+   }
+};
+
+
+/**
+ * Hash of a PositionKey.
+ */
+struct PositionHash
+{
+   inline size_t operator()(const PositionKey &key) const
+   {
+      return (key.x * 73856093u) ^ (key.y * 19349663u) ^ (key.z * 83492791u);
+   }
+};
+
+
+/**
+ * Candidate edge collapse.
+ */
+struct Collapse
+{
+   float cost;                                  ///< Quadric error plus attribute penalty
+   uint32_t from;                               ///< Vertex removed
+   uint32_t to;                                 ///< Vertex kept
+};
+
+
+/**
+ * Tells whether a face has two corners at the same position.
+ * @param face face
+ * @param pos canonical vertex of each vertex
+ * @return TF
+ */
+static inline bool isDegenerate(const Eng::Ebo::FaceData &face, const std::vector<uint32_t> &pos)
+{
+   return pos[face.a] == pos[face.b] || pos[face.b] == pos[face.c] || pos[face.c] == pos[face.a];
+}
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief Simplifier reserved structure.
+ */
+struct Eng::Simplifier::Reserved
+{
+   uint32_t nrOfLods;                           ///< LODs generated per mesh (0 = disabled)
+   float ratio;                                 ///< Face reduction from one LOD to the next
+   float maxError;                              ///< Max error per LOD (fraction of the bounding radius)
+   float attributeWeight;                       ///< Attribute penalty scale (fraction of the bounding radius)
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : nrOfLods{ 0 }, ratio{ Eng::Simplifier::dfltRatio }, maxError{ Eng::Simplifier::dfltMaxError },
+                attributeWeight{ Eng::Simplifier::dfltAttributeWeight }
+   {}
+};
+
+
+
+//////////////////////////////
+// BODY OF CLASS Simplifier //
+//////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::Simplifier::Simplifier() : reserved(std::make_unique<Eng::Simplifier::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::Simplifier::~Simplifier()
+{
+   ENG_LOG_DEBUG("[-]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::Simplifier ENG_API &Eng::Simplifier::getInstance()
+{
+   static Simplifier instance;
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the number of LODs generated for meshes providing only one. Set before loading.
+ * @param nrOfLods number of coarser LODs (0 disables the generation, clamped to maxNrOfLods)
+ */
+void ENG_API Eng::Simplifier::setNrOfLods(uint32_t nrOfLods)
+{
+   reserved->nrOfLods = std::min(nrOfLods, maxNrOfLods);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of LODs generated for meshes providing only one.
+ * @return number of LODs (0 when disabled)
+ */
+uint32_t ENG_API Eng::Simplifier::getNrOfLods() const
+{
+   return reserved->nrOfLods;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the face reduction from one LOD to the next.
+ * @param ratio target number of faces, as a fraction of the previous LOD (clamped to [0.05, 0.95])
+ */
+void ENG_API Eng::Simplifier::setRatio(float ratio)
+{
+   reserved->ratio = std::clamp(ratio, 0.05f, 0.95f);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the face reduction from one LOD to the next.
+ * @return ratio
+ */
+float ENG_API Eng::Simplifier::getRatio() const
+{
+   return reserved->ratio;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the max error of a single simplification step. Collapses exceeding it are skipped, so LODs may keep more
+ * faces than requested by the ratio.
+ * @param maxError max error, as a fraction of the bounding radius of the mesh
+ */
+void ENG_API Eng::Simplifier::setMaxError(float maxError)
+{
+   reserved->maxError = std::max(maxError, 0.0f);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the max error of a single simplification step.
+ * @return max error (fraction of the bounding radius)
+ */
+float ENG_API Eng::Simplifier::getMaxError() const
+{
+   return reserved->maxError;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the weight of attribute changes in the collapse cost: merging vertices whose normals, texture coordinates
+ * or tangents differ by 1 costs as much as moving them by this distance.
+ * @param weight attribute weight, as a fraction of the bounding radius of the mesh (0 = geometry only)
+ */
+void ENG_API Eng::Simplifier::setAttributeWeight(float weight)
+{
+   reserved->attributeWeight = std::max(weight, 0.0f);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the weight of attribute changes in the collapse cost.
+ * @return attribute weight (fraction of the bounding radius)
+ */
+float ENG_API Eng::Simplifier::getAttributeWeight() const
+{
+   return reserved->attributeWeight;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reduces the number of faces of a mesh. The result references the same vertices. Collapses are applied in passes:
+ * each pass sorts the candidates by cost and applies the cheapest ones not touching the same neighborhood.
+ * @param vertices vertices
+ * @param nrOfVertices number of vertices
+ * @param faces faces
+ * @param nrOfFaces number of faces
+ * @param targetNrOfFaces number of faces to reach (not reached when the error limit or locked vertices prevent it)
+ * @param out simplified faces (replaced)
+ * @param error max geometric error of the applied collapses (mesh units)
+ * @return TF
+ */
+bool ENG_API Eng::Simplifier::simplify(const Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices, const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces,
+                                       uint32_t targetNrOfFaces, std::vector<Eng::Ebo::FaceData> &out, float &error) const
+{
+   // Safety net:
+   if (vertices == nullptr || faces == nullptr)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   error = 0.0f;
+
+   // Weld positions:
+   std::vector<uint32_t> pos(nrOfVertices);
+   std::unordered_map<PositionKey, uint32_t, PositionHash> welded;
+   welded.reserve(nrOfVertices);
+   glm::vec3 bboxMin(0.0f), bboxMax(0.0f);
+   for (uint32_t v = 0; v < nrOfVertices; v++)
+   {
+      const glm::vec3 p = vertices[v].vertex + glm::vec3(0.0f); // -0 == 0
+      PositionKey key;
+      memcpy(&key, &p, sizeof(PositionKey));
+      pos[v] = welded.emplace(key, v).first->second;
+      bboxMin = v ? glm::min(bboxMin, p) : p;
+      bboxMax = v ? glm::max(bboxMax, p) : p;
+   }
+   const float radius = glm::length(bboxMax - bboxMin) * 0.5f;
+   const double maxErrorSq = static_cast<double>(reserved->maxError * radius) * (reserved->maxError * radius);
+   const double attributeWeight = static_cast<double>(reserved->attributeWeight * radius) * (reserved->attributeWeight * radius);
+
+   // Valid faces only:
+   out.clear();
+   out.reserve(nrOfFaces);
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+   {
+      if (faces[f].a >= nrOfVertices || faces[f].b >= nrOfVertices || faces[f].c >= nrOfVertices)
+      {
+         ENG_LOG_ERROR("Invalid index in face %u", f);
+         return false;
+      }
+      if (!isDegenerate(faces[f], pos))
+         out.push_back(faces[f]);
+   }
+
+   // Locked vertices (seams, borders and non-manifold edges), quadrics and attributes:
+   std::vector<uint8_t> locked(nrOfVertices, 0);
+   std::vector<uint32_t> wedge(nrOfVertices, none);
+   std::unordered_map<uint64_t, uint32_t> edges;
+   edges.reserve(out.size() * 2);
+   std::vector<Quadric> quadric(nrOfVertices, Quadric{});
+   for (const Eng::Ebo::FaceData &face : out)
+   {
+      const uint32_t index[3] = { face.a, face.b, face.c };
+      for (uint32_t k = 0; k < 3; k++)
+      {
+         const uint32_t p = pos[index[k]];
+         if (wedge[p] == none)
+            wedge[p] = index[k];
+         else if (wedge[p] != index[k])
+            locked[p] = 1;
+
+         const uint32_t q = pos[index[(k + 1) % 3]];
+         edges[(static_cast<uint64_t>(std::min(p, q)) << 32) | std::max(p, q)]++;
+      }
+
+      const glm::dvec3 p0 = vertices[face.a].vertex, p1 = vertices[face.b].vertex, p2 = vertices[face.c].vertex;
+      glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+      const double length = glm::length(n);
+      if (length <= 0.0)
+         continue;
+      n /= length;
+      for (uint32_t k = 0; k < 3; k++)
+         quadric[pos[index[k]]].addPlane(n, -glm::dot(n, p0), length * 0.5);
+   }
+   for (auto &edge : edges)
+      if (edge.second != 2)
+      {
+         locked[edge.first >> 32] = 1;
+         locked[edge.first & 0xFFFFFFFF] = 1;
+      }
+
+   std::vector<Attributes> attributes(nrOfVertices);
+   for (uint32_t v = 0; v < nrOfVertices; v++)
+   {
+      attributes[v].normal = glm::vec3(glm::unpackSnorm3x10_1x2(vertices[v].normal));
+      attributes[v].uv = glm::unpackHalf2x16(vertices[v].uv);
+      attributes[v].tangent = glm::vec3(glm::unpackSnorm3x10_1x2(vertices[v].tangent));
+   }
+
+   // Collapse passes:
+   std::vector<uint32_t> offset(nrOfVertices + 1);
+   std::vector<uint32_t> adjacency;
+   std::vector<Collapse> candidates;
+   std::vector<uint8_t> touched(nrOfVertices);
+   uint32_t nrOfLeft = static_cast<uint32_t>(out.size());
+   double maxApplied = 0.0;
+   while (nrOfLeft > targetNrOfFaces)
+   {
+      // Faces around each vertex:
+      std::fill(offset.begin(), offset.end(), 0);
+      for (const Eng::Ebo::FaceData &face : out)
+      {
+         offset[face.a + 1]++;
+         offset[face.b + 1]++;
+         offset[face.c + 1]++;
+      }
+      for (uint32_t v = 0; v < nrOfVertices; v++)
+         offset[v + 1] += offset[v];
+      adjacency.resize(out.size() * 3);
+      std::vector<uint32_t> fill(offset.begin(), offset.end() - 1);
+      for (uint32_t f = 0; f < out.size(); f++)
+      {
+         adjacency[fill[out[f].a]++] = f;
+         adjacency[fill[out[f].b]++] = f;
+         adjacency[fill[out[f].c]++] = f;
+      }
+
+      // Candidates (the two faces sharing an edge see it in opposite directions, which covers both collapses):
+      candidates.clear();
+      for (const Eng::Ebo::FaceData &face : out)
+      {
+         const uint32_t index[3] = { face.a, face.b, face.c };
+         for (uint32_t k = 0; k < 3; k++)
+         {
+            const uint32_t from = index[k];
+            const uint32_t to = index[(k + 1) % 3];
+            if (locked[pos[from]])
+               continue;
+
+            const Attributes &a = attributes[from];
+            const Attributes &b = attributes[to];
+            const double penalty = glm::dot(a.normal - b.normal, a.normal - b.normal) + glm::dot(a.uv - b.uv, a.uv - b.uv) +
+                                   glm::dot(a.tangent - b.tangent, a.tangent - b.tangent);
+            const Quadric &q = quadric[pos[from]];
+            candidates.push_back({ static_cast<float>(q.evaluate(vertices[to].vertex) + attributeWeight * q.area * penalty), from, to });
+         }
+      }
+      std::sort(candidates.begin(), candidates.end(), [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+      // Apply the cheapest independent collapses:
+      std::fill(touched.begin(), touched.end(), 0);
+      uint32_t nrOfCollapses = 0;
+      for (const Collapse &collapse : candidates)
+      {
+         if (nrOfLeft <= targetNrOfFaces)
+            break;
+         const uint32_t from = collapse.from;
+         const uint32_t to = collapse.to;
+         if (touched[pos[from]] || touched[pos[to]])
+            continue;
+
+         const Quadric &q = quadric[pos[from]];
+         const double errorSq = q.area > 0.0 ? collapse.cost / q.area : 0.0;
+         if (errorSq > maxErrorSq)
+            continue;
+
+         // Reject collapses flipping faces or merging into another wedge of the target:
+         bool valid = true;
+         uint32_t nrOfRemoved = 0;
+         for (uint32_t i = offset[from]; i < offset[from + 1] && valid; i++)
+         {
+            const Eng::Ebo::FaceData &face = out[adjacency[i]];
+            const uint32_t index[3] = { face.a, face.b, face.c };
+            bool shared = false;
+            for (uint32_t k = 0; k < 3; k++)
+               if (pos[index[k]] == pos[to])
+               {
+                  shared = true;
+                  valid &= index[k] == to;
+               }
+            if (shared)
+            {
+               nrOfRemoved++;
+               continue;
+            }
+
+            glm::vec3 p[3], moved[3];
+            for (uint32_t k = 0; k < 3; k++)
+            {
+               p[k] = vertices[index[k]].vertex;
+               moved[k] = index[k] == from ? vertices[to].vertex : p[k];
+            }
+            const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+            valid &= glm::dot(before, after) > 0.0f;
+         }
+         if (!valid)
+            continue;
+
+         // Collapse, and freeze the neighborhood until the next pass:
+         for (uint32_t i = offset[from]; i < offset[from + 1]; i++)
+         {
+            Eng::Ebo::FaceData &face = out[adjacency[i]];
+            if (face.a == from) face.a = to;
+            if (face.b == from) face.b = to;
+            if (face.c == from) face.c = to;
+            touched[pos[face.a]] = touched[pos[face.b]] = touched[pos[face.c]] = 1;
+         }
+         touched[pos[from]] = 1;
+         quadric[pos[to]].add(q);
+         nrOfLeft -= nrOfRemoved;
+         maxApplied = std::max(maxApplied, errorSq);
+         nrOfCollapses++;
+      }
+
+      // Remove collapsed faces:
+      out.erase(std::remove_if(out.begin(), out.end(), [&pos](const Eng::Ebo::FaceData &face) { return isDegenerate(face, pos); }), out.end());
+      if (nrOfCollapses == 0)
+         break;
+   }
+
+   // Done:
+   error = static_cast<float>(std::sqrt(maxApplied));
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Builds a chain of getNrOfLods() coarser LODs, each one simplified from the previous one. The chain stops early
+ * when a step removes less than 10% of the faces.
+ * @param vertices vertices of the source LOD
+ * @param nrOfVertices number of vertices
+ * @param faces faces of the source LOD
+ * @param nrOfFaces number of faces
+ * @param lods generated LODs, from the finest to the coarsest (replaced)
+ * @return TF
+ */
+bool ENG_API Eng::Simplifier::buildLods(const Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices, const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces,
+                                        std::vector<Lod> &lods) const
+{
+   // Safety net:
+   if (vertices == nullptr || faces == nullptr)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   lods.clear();
+   std::vector<Eng::Ebo::FaceData> current(faces, faces + nrOfFaces);
+   std::vector<Eng::Ebo::FaceData> next;
+   std::vector<uint32_t> remap(nrOfVertices);
+   float error = 0.0f;
+   for (uint32_t l = 0; l < reserved->nrOfLods; l++)
+   {
+      const uint32_t target = static_cast<uint32_t>(current.size() * reserved->ratio);
+      float stepError;
+      if (target == 0 || simplify(vertices, nrOfVertices, current.data(), static_cast<uint32_t>(current.size()), target, next, stepError) == false)
+         break;
+      if (next.empty() || next.size() * 10 > current.size() * 9)
+         break;
+      error += stepError;
+
+      // Keep only the vertices used by this LOD:
+      Lod lod;
+      lod.error = error;
+      std::fill(remap.begin(), remap.end(), none);
+      lod.faces.resize(next.size());
+      for (size_t f = 0; f < next.size(); f++)
+      {
+         uint32_t *dst = &lod.faces[f].a;
+         const uint32_t src[3] = { next[f].a, next[f].b, next[f].c };
+         for (uint32_t k = 0; k < 3; k++)
+         {
+            if (remap[src[k]] == none)
+            {
+               remap[src[k]] = static_cast<uint32_t>(lod.vertices.size());
+               lod.vertices.push_back(vertices[src[k]]);
+            }
+            dst[k] = remap[src[k]];
+         }
+      }
+      lods.push_back(std::move(lod));
+      current.swap(next);
+   }
+
+   // Done:
+   return true;
+}
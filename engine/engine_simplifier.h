@@ -0,0 +1,79 @@
+/**
+ * @file		engine_simplifier.h
+ * @brief	Automatic LOD generation
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Mesh simplifier based on quadric error metrics. Edges are collapsed onto one of their vertices (no new
+ *        vertices are created), in order of increasing cost: the distance from the planes of the original faces,
+ *        plus a penalty for the difference of normals, texture coordinates and tangents. Vertices on borders,
+ *        non-manifold edges and attribute seams never move, and collapses flipping faces are rejected.
+ *        When enabled, meshes providing a single LOD get a chain of coarser ones when loaded (Mesh) or saved
+ *        (Ovo::save()), both running on the ThreadPool workers. This class is a singleton.
+ */
+class ENG_API Simplifier
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief Generated level of detail.
+    */
+   struct Lod
+   {
+      std::vector<Eng::Vbo::VertexData> vertices;  ///< Vertices used by this LOD
+      std::vector<Eng::Ebo::FaceData> faces;       ///< Faces (indices relative to vertices)
+      float error;                                 ///< Max geometric error w.r.t. the source mesh (mesh units)
+   };
+
+
+   // Consts:
+   static constexpr uint32_t maxNrOfLods = 8;               ///< Max number of generated LODs
+   static constexpr float dfltRatio = 0.5f;                 ///< Default face reduction from one LOD to the next
+   static constexpr float dfltMaxError = 0.05f;             ///< Default max error (fraction of the bounding radius)
+   static constexpr float dfltAttributeWeight = 0.01f;      ///< Default attribute weight (fraction of the bounding radius)
+
+   // Const/dest:
+   Simplifier(Simplifier const &) = delete;
+   ~Simplifier();
+
+   // Operators:
+   void operator=(Simplifier const &) = delete;
+
+   // Singleton:
+   static Simplifier &getInstance();
+
+   // Get/set:
+   void setNrOfLods(uint32_t nrOfLods);
+   uint32_t getNrOfLods() const;
+   void setRatio(float ratio);
+   float getRatio() const;
+   void setMaxError(float maxError);
+   float getMaxError() const;
+   void setAttributeWeight(float weight);
+   float getAttributeWeight() const;
+
+   // Simplification:
+   bool simplify(const Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices, const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces,
+                 uint32_t targetNrOfFaces, std::vector<Eng::Ebo::FaceData> &out, float &error) const;
+   bool buildLods(const Eng::Vbo::VertexData *vertices, uint32_t nrOfVertices, const Eng::Ebo::FaceData *faces, uint32_t nrOfFaces,
+                  std::vector<Lod> &lods) const;
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   Simplifier();
+};
@@ -0,0 +1,249 @@
+/**
+ * @file		engine_slab_allocator.cpp
+ * @brief	Fixed-size block allocator for the reserved structures
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <mutex>
+   #include <new>
+
+
+
+////////////
+// STATIC //
+////////////
+
+/**
+ * Allocators alive, for report().
+ */
+struct Registry
+{
+   std::vector<const Eng::SlabAllocator *> allocators;
+   std::mutex mutex;
+};
+
+
+/**
+ * Gets the registry (created before the first allocator, hence destroyed after the last one).
+ * @return registry
+ */
+static Registry &getRegistry()
+{
+   static Registry registry;
+   return registry;
+}
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief SlabAllocator reserved structure.
+ */
+struct Eng::SlabAllocator::Reserved
+{
+   /**
+    * @brief Released block, linked in place.
+    */
+   struct FreeBlock
+   {
+      FreeBlock *next;
+   };
+
+   const char *name;                            ///< Type name
+   size_t blockSize;                            ///< Bytes per block (rounded up to the alignment)
+   size_t alignment;                            ///< Block alignment
+   std::vector<uint8_t *> slabs;                ///< Allocated slabs
+   uint32_t nrOfUnused;                         ///< Never used blocks left in the last slab
+   FreeBlock *freeList;                         ///< Released blocks
+   uint64_t nrOfAllocations;                    ///< Allocations since creation
+   uint32_t nrOfLiveBlocks;                     ///< Blocks in use
+   mutable std::mutex mutex;                    ///< Protects the above
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : name{ nullptr }, blockSize{ 0 }, alignment{ 0 }, nrOfUnused{ 0 }, freeList{ nullptr },
+                nrOfAllocations{ 0 }, nrOfLiveBlocks{ 0 }
+   {}
+};
+
+
+
+/////////////////////////////////
+// BODY OF CLASS SlabAllocator //
+/////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ * @param blockSize size of the allocated objects
+ * @param alignment alignment of the allocated objects
+ * @param name type name (static string), used by report()
+ */
+ENG_API Eng::SlabAllocator::SlabAllocator(size_t blockSize, size_t alignment, const char *name) : reserved(std::make_unique<Eng::SlabAllocator::Reserved>())
+{
+   reserved->name = name;
+   reserved->alignment = std::max(alignment, alignof(Reserved::FreeBlock));
+   blockSize = std::max(blockSize, sizeof(Reserved::FreeBlock));
+   reserved->blockSize = (blockSize + reserved->alignment - 1) / reserved->alignment * reserved->alignment;
+
+   Registry &registry = getRegistry();
+   std::lock_guard<std::mutex> lock(registry.mutex);
+   registry.allocators.push_back(this);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor. Releases the slabs.
+ */
+ENG_API Eng::SlabAllocator::~SlabAllocator()
+{
+   {
+      Registry &registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.allocators.erase(std::remove(registry.allocators.begin(), registry.allocators.end(), this), registry.allocators.end());
+   }
+
+   for (uint8_t *slab : reserved->slabs)
+      ::operator delete(slab, std::align_val_t(reserved->alignment));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the name of the allocated type.
+ * @return type name
+ */
+const char ENG_API *Eng::SlabAllocator::getName() const
+{
+   return reserved->name;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the size of the blocks (object size rounded up to the alignment).
+ * @return bytes per block
+ */
+size_t ENG_API Eng::SlabAllocator::getBlockSize() const
+{
+   return reserved->blockSize;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of allocations since creation.
+ * @return number of allocations
+ */
+uint64_t ENG_API Eng::SlabAllocator::getNrOfAllocations() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return reserved->nrOfAllocations;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of blocks currently in use.
+ * @return number of blocks
+ */
+uint32_t ENG_API Eng::SlabAllocator::getNrOfLiveBlocks() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return reserved->nrOfLiveBlocks;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of slabs allocated so far.
+ * @return number of slabs
+ */
+uint32_t ENG_API Eng::SlabAllocator::getNrOfSlabs() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return static_cast<uint32_t>(reserved->slabs.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Allocates a block: the last released one if any, otherwise the next unused one of the current slab.
+ * @return memory block (throws std::bad_alloc when out of memory, as operator new)
+ */
+void ENG_API *Eng::SlabAllocator::allocate()
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+
+   void *block;
+   if (reserved->freeList)
+   {
+      block = reserved->freeList;
+      reserved->freeList = reserved->freeList->next;
+   }
+   else
+   {
+      if (reserved->nrOfUnused == 0)
+      {
+         reserved->slabs.push_back(static_cast<uint8_t *>(::operator new(slabSize * reserved->blockSize, std::align_val_t(reserved->alignment))));
+         reserved->nrOfUnused = slabSize;
+      }
+      block = reserved->slabs.back() + (slabSize - reserved->nrOfUnused) * reserved->blockSize;
+      reserved->nrOfUnused--;
+   }
+
+   // Done:
+   reserved->nrOfAllocations++;
+   reserved->nrOfLiveBlocks++;
+   return block;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases a block returned by allocate().
+ * @param block memory block (nullptr is ignored)
+ */
+void ENG_API Eng::SlabAllocator::release(void *block)
+{
+   if (block == nullptr)
+      return;
+
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   Reserved::FreeBlock *freed = static_cast<Reserved::FreeBlock *>(block);
+   freed->next = reserved->freeList;
+   reserved->freeList = freed;
+   reserved->nrOfLiveBlocks--;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Logs the counters of all the allocators.
+ */
+void ENG_API Eng::SlabAllocator::report()
+{
+   Registry &registry = getRegistry();
+   std::lock_guard<std::mutex> lock(registry.mutex);
+   for (const Eng::SlabAllocator *allocator : registry.allocators)
+      ENG_LOG_INFO("%s: %zu bytes, %u live, %llu allocations, %u slabs", allocator->getName(), allocator->getBlockSize(),
+                   allocator->getNrOfLiveBlocks(), (unsigned long long) allocator->getNrOfAllocations(), allocator->getNrOfSlabs());
+}
@@ -0,0 +1,104 @@
+/**
+ * @file		engine_slab_allocator.h
+ * @brief	Fixed-size block allocator for the reserved structures
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Allocator of fixed-size blocks, carved out of slabs of slabSize blocks. Released blocks go to a free list
+ *        and are reused first, so that blocks of the same type stay packed together. Slabs are only released with
+ *        the allocator. Thread-safe. Each allocator keeps its own counters, see report().
+ */
+class ENG_API SlabAllocator
+{
+//////////
+public: //
+//////////
+
+   // Consts:
+   static constexpr uint32_t slabSize = 64;                 ///< Number of blocks per slab
+
+
+   // Const/dest:
+   SlabAllocator(size_t blockSize, size_t alignment, const char *name);
+   SlabAllocator(SlabAllocator const &) = delete;
+   ~SlabAllocator();
+
+   // Operators:
+   void operator=(SlabAllocator const &) = delete;
+
+   // Get/set:
+   const char *getName() const;
+   size_t getBlockSize() const;
+   uint64_t getNrOfAllocations() const;
+   uint32_t getNrOfLiveBlocks() const;
+   uint32_t getNrOfSlabs() const;
+
+   // Allocation:
+   void *allocate();
+   void release(void *block);
+
+   // Statistics:
+   static void report();
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+};
+
+
+
+/**
+ * @brief Base class (CRTP) routing the new/delete of a type to its own SlabAllocator. Meant for the reserved
+ *        structures (e.g., struct Eng::Mesh::Reserved : public Eng::Pooled<Eng::Mesh::Reserved>), so that the pimpl
+ *        blocks of each class are packed together instead of being spread across the heap.
+ */
+template <typename T> struct Pooled
+{
+   /**
+    * Gets the allocator of T (created on first use, never destroyed: blocks owned by other statics, e.g. the
+    * Container, may still be released at exit).
+    * @return allocator
+    */
+   static Eng::SlabAllocator &getAllocator()
+   {
+      static Eng::SlabAllocator *allocator = new Eng::SlabAllocator(sizeof(T), alignof(T), typeid(T).name());
+      return *allocator;
+   }
+
+
+   /**
+    * Allocates a T (derived types, if any, fall back to the global heap).
+    * @param size size of the object
+    * @return memory block
+    */
+   static void *operator new(size_t size)
+   {
+      if (size != sizeof(T))
+         return ::operator new(size);
+      return getAllocator().allocate();
+   }
+
+
+   /**
+    * Releases a T.
+    * @param ptr memory block
+    * @param size size of the object
+    */
+   static void operator delete(void *ptr, size_t size)
+   {
+      if (size != sizeof(T))
+         ::operator delete(ptr);
+      else
+         getAllocator().release(ptr);
+   }
+};
@@ -28,6 +28,117 @@
    Eng::Texture Eng::Texture::empty("[empty]");   
 
 
+/**
+ * Copies an image level into the shared upload ring and binds the ring as unpack buffer.
+ * @param data image data
+ * @param nrOfBytes size of the image data
+ * @return pointer to pass to the OpenGL upload call: offset within the ring, or the data itself if the ring can't be used
+ */
+static const void *stageLevel(const void *data, uint64_t nrOfBytes)
+{
+   Eng::Pbo &ring = Eng::Pbo::getDefault();
+   uint64_t offset = 0;
+   void *staged = ring.allocate(nrOfBytes, offset);
+   if (staged == nullptr)
+   {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      return data;
+   }
+
+   // Done:
+   memcpy(staged, data, nrOfBytes);
+   ring.render();
+   return reinterpret_cast<const void *>(static_cast<uintptr_t>(offset));
+}
+
+/**
+ * Gets the OpenGL formats matching a bitmap format.
+ * @param bitmapFormat bitmap format
+ * @param intFormat OpenGL internal format
+ * @param extFormat OpenGL external format (uncompressed only)
+ * @param extType OpenGL external type (uncompressed only)
+ * @param format texture format
+ * @return TF
+ */
+static bool getOglFormat(Eng::Bitmap::Format bitmapFormat, GLuint &intFormat, GLuint &extFormat, GLuint &extType, Eng::Texture::Format &format)
+{
+	switch (bitmapFormat)
+	{
+      //////////////////////////////////////
+      case Eng::Bitmap::Format::r8g8b8a8: //		   
+		   intFormat      = GL_RGBA8;
+		   extFormat      = GL_RGBA;
+		   extType        = GL_UNSIGNED_BYTE;
+         format         = Eng::Texture::Format::r8g8b8a8;
+		   break;	      
+
+      ////////////////////////////////////
+      case Eng::Bitmap::Format::r8g8b8: //         
+         intFormat      = GL_RGB8;
+         extFormat      = GL_RGB;
+         extType        = GL_UNSIGNED_BYTE;
+         format         = Eng::Texture::Format::r8g8b8;
+         break;      				
+
+      ////////////////////////////////////
+      case Eng::Bitmap::Format::rgb_float: //         
+         intFormat = GL_RGB16;
+         extFormat = GL_RGB;
+         extType = GL_FLOAT;
+         format = Eng::Texture::Format::rgb_float;
+         break;
+
+         //////////////////////////////////////
+      case Eng::Bitmap::Format::rgba_float: //		   
+         intFormat = GL_RGBA16;
+         extFormat = GL_RGBA;
+         extType = GL_FLOAT;
+         format = Eng::Texture::Format::rgba_float;
+         break;
+
+      /////////////////////////////////////////////////
+      case Eng::Bitmap::Format::r8g8b8a8_compressed: //		   
+		   intFormat      = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		   extFormat      = GL_RGBA;
+		   extType        = GL_UNSIGNED_BYTE;
+         format         = Eng::Texture::Format::r8g8b8a8_compressed;
+		   break;	      
+
+      ///////////////////////////////////////////////
+      case Eng::Bitmap::Format::r8g8b8_compressed: //		   
+         intFormat      = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;		   
+		   extFormat      = GL_RGB;
+		   extType        = GL_UNSIGNED_BYTE;
+         format         = Eng::Texture::Format::r8g8b8_compressed;
+		   break;	      
+
+      /////////////////////////////////////////////
+      case Eng::Bitmap::Format::r8g8_compressed: //		   
+         intFormat      = GL_COMPRESSED_RG_RGTC2;		   
+		   extFormat      = GL_RG;
+		   extType        = GL_UNSIGNED_BYTE;
+         format         = Eng::Texture::Format::r8g8_compressed;
+		   break;	      
+
+      ///////////////////////////////////////////
+      case Eng::Bitmap::Format::r8_compressed: //		   
+         intFormat      = GL_COMPRESSED_RED_RGTC1;		   
+		   extFormat      = GL_R;
+		   extType        = GL_UNSIGNED_BYTE;
+         format         = Eng::Texture::Format::r8_compressed;
+		   break;	      
+
+		///////////
+      default: //
+         ENG_LOG_ERROR("Unexpected bitmap type");
+			return false;			
+	}
+
+   // Done:
+   return true;
+}
+
+
 
 /////////////////////////
 // RESERVED STRUCTURES //
@@ -36,22 +147,30 @@
 /**
  * @brief Texture reserved structure.
  */
-struct Eng::Texture::Reserved
+struct Eng::Texture::Reserved : public Eng::Pooled<Eng::Texture::Reserved>
 { 
    std::reference_wrapper<const Eng::Bitmap> bitmap;
+   std::shared_ptr<const Eng::Bitmap> owned;   ///< Bitmap kept alive by the texture (see load())
    Eng::Texture::Format format;
    glm::u32vec3 size;
    
    GLuint oglId;                    ///< OpenGL texture ID   
    GLuint64 oglBindlessHandle;      ///< GL_ARB_bindless_texture special handle
    GLuint oglInternalFormat;        ///< OpenGL internal format enum
+   GLuint oglExtFormat;             ///< OpenGL external format enum (uncompressed only)
+   GLuint oglExtType;               ///< OpenGL external type enum (uncompressed only)
+
+   uint32_t nrOfLevels;             ///< Number of mip levels of the source bitmap
+   uint32_t baseLevel;              ///< Finest level stored in VRAM (level 0 of the OpenGL texture)
+   bool layered;                    ///< 2D texture array (see createArray())
 
 
    /**
     * Constructor. 
     */
    Reserved() : bitmap{ Eng::Bitmap::empty }, format{ Eng::Texture::Format::none }, size{ 0, 0, 1 },
-                oglId{ 0 }, oglBindlessHandle{ 0 }, oglInternalFormat { 0 }
+                oglId{ 0 }, oglBindlessHandle{ 0 }, oglInternalFormat { 0 }, oglExtFormat{ 0 }, oglExtType{ 0 },
+                nrOfLevels{ 1 }, baseLevel{ 0 }, layered{ false }
    {}
 };
 
@@ -135,6 +254,8 @@ const Eng::Bitmap ENG_API &Eng::Texture::getBitmap() const
 void ENG_API Eng::Texture::setBitmap(const Eng::Bitmap &bitmap)
 {	
    reserved->bitmap = bitmap;
+   if (reserved->owned.get() != &bitmap)
+      reserved->owned.reset();
 }
 
 
@@ -248,6 +369,28 @@ uint64_t ENG_API Eng::Texture::getOglBindlessHandle() const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get the number of mip levels of the source bitmap (resident or not).
+ * @return number of levels
+ */
+uint32_t ENG_API Eng::Texture::getNrOfLevels() const
+{
+   return reserved->nrOfLevels;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get the finest mip level currently stored in VRAM.
+ * @return base level (0 = full resolution)
+ */
+uint32_t ENG_API Eng::Texture::getBaseLevel() const
+{
+   return reserved->baseLevel;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Create an OpenGL instance of the texture. 
@@ -357,12 +500,13 @@ const Eng::Texture ENG_API &Eng::Texture::getDefault(bool white)
 /**
  * Load the content of the texture from the given bitmap.
  * @param bitmap bitmap
+ * @param baseLevel finest mip level to upload (finer levels can be added later with stream())
  * @return TF
  */
-bool ENG_API Eng::Texture::load(const Eng::Bitmap &bitmap) 
+bool ENG_API Eng::Texture::load(const Eng::Bitmap &bitmap, uint32_t baseLevel) 
 {	
    // Safety net:
-   if (bitmap == Eng::Bitmap::empty)
+   if (bitmap == Eng::Bitmap::empty || baseLevel >= bitmap.getNrOfLevels())
    {
       ENG_LOG_ERROR("Invalid params");
       return false;
@@ -372,87 +516,9 @@ bool ENG_API Eng::Texture::load(const Eng::Bitmap &bitmap)
 	GLuint intFormat;
 	GLuint extFormat;
 	GLuint extType;
-   GLuint nrOfComponents;
    Format _format = Format::none;
-	switch (bitmap.getFormat())
-	{
-      //////////////////////////////////////
-      case Eng::Bitmap::Format::r8g8b8a8: //		   
-		   intFormat      = GL_RGBA8;
-		   extFormat      = GL_RGBA;
-		   extType        = GL_UNSIGNED_BYTE;
-         nrOfComponents = 4;
-         _format        = Format::r8g8b8a8;
-		   break;	      
-
-      ////////////////////////////////////
-      case Eng::Bitmap::Format::r8g8b8: //         
-         intFormat      = GL_RGB8;
-         extFormat      = GL_RGB;
-         extType        = GL_UNSIGNED_BYTE;
-         nrOfComponents = 3;
-         _format        = Format::r8g8b8;
-         break;      				
-
-      ////////////////////////////////////
-      case Eng::Bitmap::Format::rgb_float: //         
-         intFormat = GL_RGB16;
-         extFormat = GL_RGB;
-         extType = GL_FLOAT;
-         nrOfComponents = 3;
-         _format = Format::rgb_float;
-         break;
-
-         //////////////////////////////////////
-      case Eng::Bitmap::Format::rgba_float: //		   
-         intFormat = GL_RGBA16;
-         extFormat = GL_RGBA;
-         extType = GL_FLOAT;
-         nrOfComponents = 4;
-         _format = Format::rgba_float;
-         break;
-
-      /////////////////////////////////////////////////
-      case Eng::Bitmap::Format::r8g8b8a8_compressed: //		   
-		   intFormat      = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-		   extFormat      = GL_RGBA;
-		   extType        = GL_UNSIGNED_BYTE;
-         nrOfComponents = 4;
-         _format        = Format::r8g8b8a8_compressed;
-		   break;	      
-
-      ///////////////////////////////////////////////
-      case Eng::Bitmap::Format::r8g8b8_compressed: //		   
-         intFormat      = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;		   
-		   extFormat      = GL_RGB;
-		   extType        = GL_UNSIGNED_BYTE;
-         nrOfComponents = 3;
-         _format        = Format::r8g8b8_compressed;
-		   break;	      
-
-      /////////////////////////////////////////////
-      case Eng::Bitmap::Format::r8g8_compressed: //		   
-         intFormat      = GL_COMPRESSED_RG_RGTC2;		   
-		   extFormat      = GL_RG;
-		   extType        = GL_UNSIGNED_BYTE;
-         nrOfComponents = 2;
-         _format        = Format::r8g8_compressed;
-		   break;	      
-
-      ///////////////////////////////////////////
-      case Eng::Bitmap::Format::r8_compressed: //		   
-         intFormat      = GL_COMPRESSED_RED_RGTC1;		   
-		   extFormat      = GL_R;
-		   extType        = GL_UNSIGNED_BYTE;
-         nrOfComponents = 1;
-         _format        = Format::r8_compressed;
-		   break;	      
-
-		///////////
-      default: //
-         ENG_LOG_ERROR("Unexpected bitmap type");
-			return false;			
-	}
+   if (getOglFormat(bitmap.getFormat(), intFormat, extFormat, extType, _format) == false)
+      return false;
 
    // Init texture:
    this->Eng::Texture::init();
@@ -461,7 +527,7 @@ bool ENG_API Eng::Texture::load(const Eng::Bitmap &bitmap)
    const GLuint oglId = this->getOglHandle();
    glBindTexture(GL_TEXTURE_2D, oglId);   
    if (bitmap.getNrOfLevels() > 1)
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, bitmap.getNrOfLevels());   
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, bitmap.getNrOfLevels() - baseLevel);   
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); 
@@ -470,7 +536,7 @@ bool ENG_API Eng::Texture::load(const Eng::Bitmap &bitmap)
    
    // Load data:   
    for (uint32_t side = 0; side < bitmap.getNrOfSides(); side++)
-      for (uint32_t c = 0; c < bitmap.getNrOfLevels(); c++)
+      for (uint32_t c = baseLevel; c < bitmap.getNrOfLevels(); c++)
       {
          ENG_LOG_DEBUG("Type: 2D, Level: %d/%d, IntFormat: 0x%x, x: %u, y: %u", c + 1, bitmap.getNrOfLevels(), intFormat, bitmap.getSizeX(c), bitmap.getSizeY(c)); 
          switch (_format)
@@ -480,14 +546,15 @@ bool ENG_API Eng::Texture::load(const Eng::Bitmap &bitmap)
             case Format::r8g8b8_compressed:
             case Format::r8g8_compressed:
             case Format::r8_compressed:
-               glCompressedTexImage2D(GL_TEXTURE_2D, c, intFormat, bitmap.getSizeX(c), bitmap.getSizeY(c), 0, bitmap.getNrOfBytes(c), bitmap.getData(c));  
+               glCompressedTexImage2D(GL_TEXTURE_2D, c - baseLevel, intFormat, bitmap.getSizeX(c), bitmap.getSizeY(c), 0, bitmap.getNrOfBytes(c), stageLevel(bitmap.getData(c), bitmap.getNrOfBytes(c)));  
                break;
 
             // Uncompressed:
             default:
-               glTexImage2D(GL_TEXTURE_2D, c, intFormat, bitmap.getSizeX(c), bitmap.getSizeY(c), 0, extFormat, extType, bitmap.getData(c));  
+               glTexImage2D(GL_TEXTURE_2D, c - baseLevel, intFormat, bitmap.getSizeX(c), bitmap.getSizeY(c), 0, extFormat, extType, stageLevel(bitmap.getData(c), bitmap.getNrOfBytes(c)));  
          }         
       }
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
    if (bitmap.getNrOfLevels() <= 1)
       glGenerateMipmap(GL_TEXTURE_2D); 
@@ -500,6 +567,224 @@ bool ENG_API Eng::Texture::load(const Eng::Bitmap &bitmap)
    this->setFormat(_format);
    this->setSizeX(bitmap.getSizeX(0));
    this->setSizeY(bitmap.getSizeY(0));
+   reserved->oglInternalFormat = intFormat;
+   reserved->oglExtFormat = extFormat;
+   reserved->oglExtType = extType;
+   reserved->nrOfLevels = bitmap.getNrOfLevels();
+   reserved->baseLevel = baseLevel;
+   reserved->layered = false;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Load the content of the texture from the given bitmap and, unless asked to keep it, drop the texture's reference
+ * to it afterwards, so that its memory (or file mapping) is released together with the last owner.
+ * @param bitmap bitmap
+ * @param baseLevel finest mip level to upload (finer levels can be added later with stream())
+ * @param keep when true, the texture keeps the bitmap alive and returns it through getBitmap()
+ * @return TF
+ */
+bool ENG_API Eng::Texture::load(const std::shared_ptr<const Eng::Bitmap> &bitmap, uint32_t baseLevel, bool keep)
+{
+   // Safety net:
+   if (bitmap == nullptr)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   if (this->load(*bitmap, baseLevel) == false)
+      return false;
+   if (keep)
+      reserved->owned = bitmap;
+   else
+      this->setBitmap(Eng::Bitmap::empty);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Changes the finest mip level stored in VRAM of a texture created with load(). The texture is reallocated with the
+ * new mip chain: levels already in VRAM are copied on the GPU, finer ones are uploaded from the bitmap.
+ * Since a resident bindless texture can't be modified, this changes the bindless handle.
+ * @param baseLevel new finest level (0 = full resolution)
+ * @param bitmap source image, required only when adding finer levels (must have all the levels)
+ * @return TF
+ */
+bool ENG_API Eng::Texture::stream(uint32_t baseLevel, const Eng::Bitmap *bitmap)
+{
+   // Safety net:
+   if (reserved->oglId == 0 || baseLevel >= reserved->nrOfLevels || reserved->size.z != 1 ||
+       (baseLevel < reserved->baseLevel && (bitmap == nullptr || bitmap->getNrOfLevels() != reserved->nrOfLevels)))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (baseLevel == reserved->baseLevel)
+      return true;
+
+   bool compressed = false;
+   switch (reserved->format)
+   {
+      case Format::r8g8b8a8_compressed:
+      case Format::r8g8b8_compressed:
+      case Format::r8g8_compressed:
+      case Format::r8_compressed:
+         compressed = true;
+         break;
+
+      default:
+         break;
+   }
+
+   // New mip chain:
+   const uint32_t nrOfLevels = reserved->nrOfLevels - baseLevel;
+   GLuint oglId;
+   glGenTextures(1, &oglId);
+   glBindTexture(GL_TEXTURE_2D, oglId);
+   glTexStorage2D(GL_TEXTURE_2D, nrOfLevels, reserved->oglInternalFormat, std::max(reserved->size.x >> baseLevel, 1u), std::max(reserved->size.y >> baseLevel, 1u));
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, 16);
+
+   for (uint32_t c = baseLevel; c < reserved->nrOfLevels; c++)
+   {
+      const GLsizei sizeX = std::max(reserved->size.x >> c, 1u);
+      const GLsizei sizeY = std::max(reserved->size.y >> c, 1u);
+
+      // Already in VRAM:
+      if (c >= reserved->baseLevel)
+         glCopyImageSubData(reserved->oglId, GL_TEXTURE_2D, c - reserved->baseLevel, 0, 0, 0,
+                            oglId, GL_TEXTURE_2D, c - baseLevel, 0, 0, 0, sizeX, sizeY, 1);
+      else
+         if (compressed)
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, c - baseLevel, 0, 0, sizeX, sizeY, reserved->oglInternalFormat, bitmap->getNrOfBytes(c), stageLevel(bitmap->getData(c), bitmap->getNrOfBytes(c)));
+         else
+            glTexSubImage2D(GL_TEXTURE_2D, c - baseLevel, 0, 0, sizeX, sizeY, reserved->oglExtFormat, reserved->oglExtType, stageLevel(bitmap->getData(c), bitmap->getNrOfBytes(c)));
+   }
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   // Replace the old one:
+   if (reserved->oglBindlessHandle)
+      glMakeTextureHandleNonResidentARB(reserved->oglBindlessHandle);
+   glDeleteTextures(1, &reserved->oglId);
+   reserved->oglId = oglId;
+   reserved->oglBindlessHandle = 0;
+   this->Eng::Texture::makeResident();
+
+   // Done:
+   ENG_LOG_DEBUG("Texture '%s' streamed to level %u", getName().c_str(), baseLevel);
+   reserved->baseLevel = baseLevel;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Allocates a 2D texture array of images with the same size, format and number of mip levels as the given bitmap.
+ * Layers are filled with loadLayer(). Arrays are bound to texture units and never made resident.
+ * @param bitmap model image (its content is not uploaded)
+ * @param nrOfLayers number of layers
+ * @return TF
+ */
+bool ENG_API Eng::Texture::createArray(const Eng::Bitmap &bitmap, uint32_t nrOfLayers)
+{
+   // Safety net:
+   if (bitmap == Eng::Bitmap::empty || bitmap.getNrOfSides() != 1 || nrOfLayers == 0)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   GLuint intFormat;
+   GLuint extFormat;
+   GLuint extType;
+   Format _format = Format::none;
+   if (getOglFormat(bitmap.getFormat(), intFormat, extFormat, extType, _format) == false)
+      return false;
+
+   // Init texture:
+   this->Eng::Texture::init();
+
+   // Create it:
+   const GLuint oglId = this->getOglHandle();
+   glBindTexture(GL_TEXTURE_2D_ARRAY, oglId);
+   glTexStorage3D(GL_TEXTURE_2D_ARRAY, bitmap.getNrOfLevels(), intFormat, bitmap.getSizeX(0), bitmap.getSizeY(0), nrOfLayers);
+   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY, 16);
+
+   // Done:
+   this->setBitmap(Eng::Bitmap::empty);
+   this->setFormat(_format);
+   this->setSizeX(bitmap.getSizeX(0));
+   this->setSizeY(bitmap.getSizeY(0));
+   this->setSizeZ(nrOfLayers);
+   reserved->oglInternalFormat = intFormat;
+   reserved->oglExtFormat = extFormat;
+   reserved->oglExtType = extType;
+   reserved->nrOfLevels = bitmap.getNrOfLevels();
+   reserved->baseLevel = 0;
+   reserved->layered = true;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Uploads all the mip levels of a bitmap into a layer of a texture created with createArray().
+ * @param layer layer index
+ * @param bitmap image (same size, format and number of levels as the array)
+ * @return TF
+ */
+bool ENG_API Eng::Texture::loadLayer(uint32_t layer, const Eng::Bitmap &bitmap)
+{
+   // Safety net:
+   GLuint intFormat = 0;
+   GLuint extFormat;
+   GLuint extType;
+   Format _format = Format::none;
+   if (reserved->layered == false || layer >= reserved->size.z || bitmap.getNrOfSides() != 1 ||
+       bitmap.getSizeX(0) != reserved->size.x || bitmap.getSizeY(0) != reserved->size.y || bitmap.getNrOfLevels() != reserved->nrOfLevels ||
+       getOglFormat(bitmap.getFormat(), intFormat, extFormat, extType, _format) == false || intFormat != reserved->oglInternalFormat)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   bool compressed = false;
+   switch (reserved->format)
+   {
+      case Format::r8g8b8a8_compressed:
+      case Format::r8g8b8_compressed:
+      case Format::r8g8_compressed:
+      case Format::r8_compressed:
+         compressed = true;
+         break;
+
+      default:
+         break;
+   }
+
+   // Load data:
+   glBindTexture(GL_TEXTURE_2D_ARRAY, reserved->oglId);
+   for (uint32_t c = 0; c < reserved->nrOfLevels; c++)
+      if (compressed)
+         glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, c, 0, 0, layer, bitmap.getSizeX(c), bitmap.getSizeY(c), 1, intFormat, bitmap.getNrOfBytes(c), stageLevel(bitmap.getData(c), bitmap.getNrOfBytes(c)));
+      else
+         glTexSubImage3D(GL_TEXTURE_2D_ARRAY, c, 0, 0, layer, bitmap.getSizeX(c), bitmap.getSizeY(c), 1, extFormat, extType, stageLevel(bitmap.getData(c), bitmap.getNrOfBytes(c)));
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+   // Done:
    return true;
 }
 
@@ -85,10 +85,18 @@ public: //
    uint32_t getSizeZ() const;   
    uint32_t getOglHandle() const;
    uint64_t getOglBindlessHandle() const;
+   uint32_t getNrOfLevels() const;
+   uint32_t getBaseLevel() const;
 
    // Bitmap:
-   bool load(const Eng::Bitmap &bitmap);
+   bool load(const Eng::Bitmap &bitmap, uint32_t baseLevel = 0);
+   bool load(const std::shared_ptr<const Eng::Bitmap> &bitmap, uint32_t baseLevel = 0, bool keep = false);
    bool create(uint32_t sizeX, uint32_t sizeY, Format format);
+   bool stream(uint32_t baseLevel, const Eng::Bitmap *bitmap = nullptr);
+
+   // Texture arrays:
+   bool createArray(const Eng::Bitmap &bitmap, uint32_t nrOfLayers);
+   bool loadLayer(uint32_t layer, const Eng::Bitmap &bitmap);
 
    // Rendering methods:
    bool render(uint32_t value = 0, void *data = nullptr) const;
@@ -0,0 +1,409 @@
+/**
+ * @file		engine_texture_atlas.cpp
+ * @brief	Material textures grouped into 2D texture arrays
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <mutex>
+   #include <unordered_map>
+
+   // OGL:
+   #include <GL/glew.h>
+   #include <GLFW/glfw3.h>
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief TextureAtlas reserved structure.
+ */
+struct Eng::TextureAtlas::Reserved
+{
+   /**
+    * @brief Layout and occupancy of an array.
+    */
+   struct Layout
+   {
+      Eng::Bitmap::Format format;               ///< Format of the images
+      uint32_t sizeX;                           ///< Width of the images
+      uint32_t sizeY;                           ///< Height of the images
+      uint32_t nrOfLevels;                      ///< Number of mip levels of the images
+      uint32_t nrOfLayers;                      ///< Number of layers allocated
+      uint32_t nextLayer;                       ///< First never used layer
+      std::vector<uint32_t> freeLayers;         ///< Layers released by release()
+
+
+      /**
+       * Tells whether an image fits into this array.
+       * @param bitmap image
+       * @return TF
+       */
+      bool accepts(const Eng::Bitmap &bitmap) const
+      {
+         return bitmap.getFormat() == format && bitmap.getSizeX(0) == sizeX && bitmap.getSizeY(0) == sizeY &&
+                bitmap.getNrOfLevels() == nrOfLevels && (nextLayer < nrOfLayers || !freeLayers.empty());
+      }
+   };
+
+
+   /**
+    * @brief Stored image.
+    */
+   struct Entry
+   {
+      std::string name;                         ///< Cache key (empty when not cached)
+      uint32_t nrOfRefs;                        ///< Number of users
+   };
+
+   Eng::Texture arrays[Eng::TextureAtlas::maxNrOfArrays];
+   Layout layouts[Eng::TextureAtlas::maxNrOfArrays];
+   uint32_t nrOfArrays;                         ///< Arrays in use
+
+   std::unordered_map<uint32_t, Entry> entries;          ///< Entries by reference
+   std::unordered_map<std::string, uint32_t> names;      ///< References by name
+   mutable std::mutex mutex;                    ///< Protects the entries (materials are loaded on worker threads)
+
+   bool enabled;                                ///< Textures are added by Material::upload()
+   uint32_t nrOfLayers;                         ///< Number of layers of new arrays
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : nrOfArrays{ 0 }, enabled{ false }, nrOfLayers{ Eng::TextureAtlas::dfltNrOfLayers }
+   {}
+};
+
+
+
+////////////////////////////////
+// BODY OF CLASS TextureAtlas //
+////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::TextureAtlas::TextureAtlas() : reserved(std::make_unique<Eng::TextureAtlas::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::TextureAtlas::~TextureAtlas()
+{
+   ENG_LOG_DEBUG("[-]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::TextureAtlas ENG_API &Eng::TextureAtlas::getInstance()
+{
+   static TextureAtlas instance;
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Enables/disables the atlas. Only affects materials uploaded afterwards.
+ * @param enabled atlas flag
+ */
+void ENG_API Eng::TextureAtlas::setEnabled(bool enabled)
+{
+   reserved->enabled = enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the atlas status.
+ * @return atlas flag
+ */
+bool ENG_API Eng::TextureAtlas::isEnabled() const
+{
+   return reserved->enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the number of layers of arrays created from now on. Arrays are allocated in full when created, so large
+ * values waste VRAM on images whose size is seldom used.
+ * @param nrOfLayers number of layers (clamped to [1, maxNrOfLayers])
+ */
+void ENG_API Eng::TextureAtlas::setNrOfLayers(uint32_t nrOfLayers)
+{
+   reserved->nrOfLayers = std::clamp(nrOfLayers, 1u, maxNrOfLayers);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of layers of new arrays.
+ * @return number of layers
+ */
+uint32_t ENG_API Eng::TextureAtlas::getNrOfLayers() const
+{
+   return reserved->nrOfLayers;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of arrays in use.
+ * @return number of arrays
+ */
+uint32_t ENG_API Eng::TextureAtlas::getNrOfArrays() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return reserved->nrOfArrays;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of images stored.
+ * @return number of entries
+ */
+uint32_t ENG_API Eng::TextureAtlas::getNrOfEntries() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return static_cast<uint32_t>(reserved->entries.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets an array.
+ * @param index array index
+ * @return texture array, or empty texture when not in use
+ */
+const Eng::Texture ENG_API &Eng::TextureAtlas::getArray(uint32_t index) const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   if (index >= reserved->nrOfArrays)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return Eng::Texture::empty;
+   }
+   return reserved->arrays[index];
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the array index of a reference.
+ * @param ref reference
+ * @return array index
+ */
+uint32_t ENG_API Eng::TextureAtlas::getArrayIndex(uint32_t ref)
+{
+   return ref >> 16;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the layer of a reference.
+ * @param ref reference
+ * @return layer
+ */
+uint32_t ENG_API Eng::TextureAtlas::getLayer(uint32_t ref)
+{
+   return ref & 0xFFFF;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Looks up an image by name. On success, the caller becomes one more user of it and must call release() when done.
+ * @param name name given to add()
+ * @return reference, or none if not found
+ */
+uint32_t ENG_API Eng::TextureAtlas::acquire(const std::string &name)
+{
+   // Safety net:
+   if (name.empty())
+      return none;
+
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   auto it = reserved->names.find(name);
+   if (it == reserved->names.end())
+      return none;
+
+   // Done:
+   reserved->entries[it->second].nrOfRefs++;
+   return it->second;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Uploads an image into a free layer of an array with its size, format and number of levels, creating the array
+ * if needed. The caller is the first user of the new entry. Requires an OpenGL context.
+ * @param bitmap image (cubemaps are not supported)
+ * @param name cache key for acquire() (optional)
+ * @return reference, or none if the image can't be stored (all arrays in use with other layouts, etc.)
+ */
+uint32_t ENG_API Eng::TextureAtlas::add(const Eng::Bitmap &bitmap, const std::string &name)
+{
+   // Safety net:
+   if (bitmap == Eng::Bitmap::empty || bitmap.getNrOfSides() != 1)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return none;
+   }
+
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   if (!name.empty())
+   {
+      auto it = reserved->names.find(name);
+      if (it != reserved->names.end())
+      {
+         reserved->entries[it->second].nrOfRefs++;
+         return it->second;
+      }
+   }
+
+   // Find an array with a free layer, or create a new one:
+   uint32_t index = 0;
+   while (index < reserved->nrOfArrays && reserved->layouts[index].accepts(bitmap) == false)
+      index++;
+   if (index == reserved->nrOfArrays)
+   {
+      if (index == maxNrOfArrays)
+      {
+         ENG_LOG_WARN("Texture atlas full, '%s' not added", name.c_str());
+         return none;
+      }
+      if (reserved->arrays[index].createArray(bitmap, reserved->nrOfLayers) == false)
+         return none;
+
+      Reserved::Layout &layout = reserved->layouts[index];
+      layout.format = bitmap.getFormat();
+      layout.sizeX = bitmap.getSizeX(0);
+      layout.sizeY = bitmap.getSizeY(0);
+      layout.nrOfLevels = bitmap.getNrOfLevels();
+      layout.nrOfLayers = reserved->nrOfLayers;
+      layout.nextLayer = 0;
+      layout.freeLayers.clear();
+      reserved->nrOfArrays++;
+      ENG_LOG_DEBUG("Texture array %u created (%ux%u, %u levels, %u layers)", index, layout.sizeX, layout.sizeY, layout.nrOfLevels, layout.nrOfLayers);
+   }
+
+   // Upload:
+   Reserved::Layout &layout = reserved->layouts[index];
+   uint32_t layer;
+   if (!layout.freeLayers.empty())
+   {
+      layer = layout.freeLayers.back();
+      layout.freeLayers.pop_back();
+   }
+   else
+      layer = layout.nextLayer++;
+   if (reserved->arrays[index].loadLayer(layer, bitmap) == false)
+   {
+      layout.freeLayers.push_back(layer);
+      return none;
+   }
+
+   // Done:
+   const uint32_t ref = (index << 16) | layer;
+   reserved->entries[ref] = { name, 1 };
+   if (!name.empty())
+      reserved->names[name] = ref;
+   return ref;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases a reference obtained through acquire() or add(). The layer is reused once its last user is gone.
+ * @param ref reference
+ * @return TF
+ */
+bool ENG_API Eng::TextureAtlas::release(uint32_t ref)
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   auto it = reserved->entries.find(ref);
+   if (it == reserved->entries.end())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Last user:
+   if (--it->second.nrOfRefs == 0)
+   {
+      if (!it->second.name.empty())
+         reserved->names.erase(it->second.name);
+      reserved->layouts[getArrayIndex(ref)].freeLayers.push_back(getLayer(ref));
+      reserved->entries.erase(it);
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases all the entries and arrays.
+ * @return TF
+ */
+bool ENG_API Eng::TextureAtlas::reset()
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   reserved->entries.clear();
+   reserved->names.clear();
+   for (uint32_t c = 0; c < reserved->nrOfArrays; c++)
+   {
+      reserved->arrays[c].free();
+      reserved->layouts[c].freeLayers.clear();
+   }
+   reserved->nrOfArrays = 0;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Binds the arrays to consecutive texture units, starting from firstUnit.
+ * @param value generic value
+ * @param data generic pointer to any kind of data
+ * @return TF
+ */
+bool ENG_API Eng::TextureAtlas::render(uint32_t value, void *data) const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   for (uint32_t c = 0; c < reserved->nrOfArrays; c++)
+      glBindTextureUnit(firstUnit + c, reserved->arrays[c].getOglHandle());
+
+   // Done:
+   return true;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file		engine_texture_atlas.h
+ * @brief	Material textures grouped into 2D texture arrays
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Alternative to bindless material textures. Images with the same size, format and number of mip levels share
+ *        a 2D texture array, one layer each. Materials refer to them by (array, layer), packed into a 32 bit
+ *        reference, and shaders sample the arrays bound to consecutive texture units starting from firstUnit.
+ *        Entries are cached by name and reference counted. This class is a singleton.
+ */
+class ENG_API TextureAtlas
+{
+//////////
+public: //
+//////////
+
+   // Consts:
+   static constexpr uint32_t none = 0xFFFFFFFF;                ///< Special value for "no entry"
+   static constexpr uint32_t maxNrOfArrays = 8;                ///< Max number of arrays (size of the sampler array in shaders)
+   static constexpr uint32_t firstUnit = 8;                    ///< Texture unit of the first array
+   static constexpr uint32_t dfltNrOfLayers = 16;              ///< Default number of layers per array
+   static constexpr uint32_t maxNrOfLayers = 2048;             ///< Max number of layers per array
+
+   // Const/dest:
+   TextureAtlas(TextureAtlas const &) = delete;
+   ~TextureAtlas();
+
+   // Operators:
+   void operator=(TextureAtlas const &) = delete;
+
+   // Singleton:
+   static TextureAtlas &getInstance();
+
+   // Get/set:
+   void setEnabled(bool enabled);
+   bool isEnabled() const;
+   void setNrOfLayers(uint32_t nrOfLayers);
+   uint32_t getNrOfLayers() const;
+   uint32_t getNrOfArrays() const;
+   uint32_t getNrOfEntries() const;
+   const Eng::Texture &getArray(uint32_t index) const;
+
+   // References:
+   static uint32_t getArrayIndex(uint32_t ref);
+   static uint32_t getLayer(uint32_t ref);
+
+   // Management:
+   uint32_t acquire(const std::string &name);
+   uint32_t add(const Eng::Bitmap &bitmap, const std::string &name = "");
+   bool release(uint32_t ref);
+   bool reset();
+
+   // Rendering methods:
+   bool render(uint32_t value = 0, void *data = nullptr) const;
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   TextureAtlas();
+};
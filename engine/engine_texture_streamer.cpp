@@ -0,0 +1,701 @@
+/**
+ * @file		engine_texture_streamer.cpp
+ * @brief	Texture streaming with a VRAM budget
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <mutex>
+   #include <unordered_map>
+
+   // OGL:      
+   #include <GL/glew.h>
+   #include <GLFW/glfw3.h>
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief TextureStreamer reserved structure.
+ */
+struct Eng::TextureStreamer::Reserved
+{
+   /**
+    * @brief Streamed texture.
+    */
+   struct Entry
+   {
+      Eng::Texture *texture;                    ///< Managed texture
+      std::string filename;                     ///< Source file
+      std::vector<uint64_t> levelBytes;         ///< VRAM size of each mip level
+      uint32_t tailLevel;                       ///< Finest always-resident level
+      uint32_t slot;                            ///< Feedback slot (or noSlot)
+      uint32_t wantedLevel;                     ///< Finest level requested during the last frame of use
+      float priority;                           ///< Priority requested during the last frame of use
+      uint64_t lastFrame;                       ///< Last frame the texture was requested
+      bool reading;                             ///< Source file being read
+      bool failed;                              ///< Source file can't be read, don't retry
+      bool srgb;                                ///< Missing mips of the source are generated gamma-correct
+      std::unique_ptr<Eng::Bitmap> staged;      ///< Decoded source waiting for upload
+
+
+      /**
+       * Gets the VRAM size of a range of levels.
+       * @param first first level
+       * @param last level after the last one
+       * @return size in bytes
+       */
+      uint64_t getNrOfBytes(uint32_t first, uint32_t last) const
+      {
+         uint64_t nrOfBytes = 0;
+         for (uint32_t c = first; c < last && c < levelBytes.size(); c++)
+            nrOfBytes += levelBytes[c];
+         return nrOfBytes;
+      }
+   };
+
+   std::unordered_map<const Eng::Texture *, Entry> entries;
+   mutable std::mutex mutex;                    ///< Protects the entries (reads complete on worker threads)
+
+   bool enabled;                                ///< Textures are registered by Material::upload()
+   uint64_t budget;                             ///< VRAM budget in bytes
+   uint32_t tailSize;                           ///< Size of the finest always-resident level
+   uint64_t nrOfResidentBytes;                  ///< VRAM used by the managed textures
+   uint64_t nrOfChanges;                        ///< Number of reallocations (bindless handles changed)
+   uint64_t frame;                              ///< Current frame (one update() per frame)
+   uint32_t nrOfReads;                          ///< Textures being read
+
+   // GPU feedback:
+   std::vector<Eng::Texture *> slots;           ///< Texture of each feedback slot (nullptr when free)
+   std::vector<uint32_t> freeSlots;             ///< Slots released by remove()
+   Eng::Ssbo feedback[Eng::TextureStreamer::nrOfFeedbackBuffers];
+   GLsync fence[Eng::TextureStreamer::nrOfFeedbackBuffers];   ///< Signaled when the feedback can be read
+   uint32_t nrOfFeedbackSlots[Eng::TextureStreamer::nrOfFeedbackBuffers];   ///< Slots used when recorded
+   uint32_t currentFeedback;                    ///< Buffer used by the current frame
+   uint32_t feedbackRate;                       ///< Subsampling rate
+   bool feedbackActive;                         ///< Between beginFeedback() and endFeedback()
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : enabled{ false }, budget{ Eng::TextureStreamer::dfltBudget }, tailSize{ Eng::TextureStreamer::dfltTailSize },
+                nrOfResidentBytes{ 0 }, nrOfChanges{ 0 }, frame{ 0 }, nrOfReads{ 0 },
+                fence{ nullptr }, nrOfFeedbackSlots{ 0 }, currentFeedback{ 0 }, feedbackRate{ Eng::TextureStreamer::dfltFeedbackRate },
+                feedbackActive{ false }
+   {}
+};
+
+
+
+///////////////////////////////////
+// BODY OF CLASS TextureStreamer //
+///////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::TextureStreamer::TextureStreamer() : reserved(std::make_unique<Eng::TextureStreamer::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+
+   // Make sure the reading service outlives this one:
+   Eng::AsyncIo::getInstance();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::TextureStreamer::~TextureStreamer()
+{
+   ENG_LOG_DEBUG("[-]");
+
+   // Pending reads refer to this object:
+   Eng::AsyncIo::getInstance().wait();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::TextureStreamer ENG_API &Eng::TextureStreamer::getInstance()
+{
+   static TextureStreamer instance;
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Enables/disables streaming for the textures created from now on.
+ * @param enabled streaming flag
+ */
+void ENG_API Eng::TextureStreamer::setEnabled(bool enabled)
+{
+   reserved->enabled = enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the streaming status.
+ * @return streaming flag
+ */
+bool ENG_API Eng::TextureStreamer::isEnabled() const
+{
+   return reserved->enabled;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the VRAM budget. Mip tails are always resident, even when exceeding it.
+ * @param nrOfBytes budget in bytes
+ */
+void ENG_API Eng::TextureStreamer::setBudget(uint64_t nrOfBytes)
+{
+   reserved->budget = nrOfBytes;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the VRAM budget.
+ * @return budget in bytes
+ */
+uint64_t ENG_API Eng::TextureStreamer::getBudget() const
+{
+   return reserved->budget;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the size of the finest mip level uploaded at load time.
+ * @param size max width/height of the tail
+ */
+void ENG_API Eng::TextureStreamer::setTailSize(uint32_t size)
+{
+   reserved->tailSize = size;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the size of the finest mip level uploaded at load time.
+ * @return max width/height of the tail
+ */
+uint32_t ENG_API Eng::TextureStreamer::getTailSize() const
+{
+   return reserved->tailSize;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the finest mip level of the tail of a given bitmap.
+ * @param bitmap bitmap
+ * @return tail level
+ */
+uint32_t ENG_API Eng::TextureStreamer::getTailLevel(const Eng::Bitmap &bitmap) const
+{
+   for (uint32_t c = 0; c < bitmap.getNrOfLevels(); c++)
+      if (std::max(bitmap.getSizeX(c), bitmap.getSizeY(c)) <= reserved->tailSize)
+         return c;
+   return bitmap.getNrOfLevels() ? bitmap.getNrOfLevels() - 1 : 0;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the VRAM used by the managed textures.
+ * @return size in bytes
+ */
+uint64_t ENG_API Eng::TextureStreamer::getNrOfResidentBytes() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return reserved->nrOfResidentBytes;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of managed textures.
+ * @return number of textures
+ */
+uint32_t ENG_API Eng::TextureStreamer::getNrOfTextures() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return static_cast<uint32_t>(reserved->entries.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of texture reallocations so far. Since each one changes a bindless handle, users caching
+ * handles must refresh them when this value changes.
+ * @return number of reallocations
+ */
+uint64_t ENG_API Eng::TextureStreamer::getNrOfChanges() const
+{
+   return reserved->nrOfChanges;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the feedback slot of a texture, to pass to the shaders writing feedback.
+ * @param tex texture
+ * @return slot index or noSlot if the texture is not streamed (or no more slots were available)
+ */
+uint32_t ENG_API Eng::TextureStreamer::getSlot(const Eng::Texture &tex) const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   auto it = reserved->entries.find(&tex);
+   if (it == reserved->entries.end())
+      return Eng::TextureStreamer::noSlot;
+   return it->second.slot;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the feedback subsampling rate: on average, one pixel (or ray) out of this many writes feedback per frame.
+ * The pattern changes every frame, so all the pixels are covered over time.
+ * @param rate subsampling rate (1 = all pixels)
+ */
+void ENG_API Eng::TextureStreamer::setFeedbackRate(uint32_t rate)
+{
+   reserved->feedbackRate = std::max(rate, 1u);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the feedback subsampling rate.
+ * @return subsampling rate
+ */
+uint32_t ENG_API Eng::TextureStreamer::getFeedbackRate() const
+{
+   return reserved->feedbackRate;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether a feedback buffer is currently bound (i.e., between beginFeedback() and endFeedback()).
+ * @return TF
+ */
+bool ENG_API Eng::TextureStreamer::isFeedbackActive() const
+{
+   return reserved->feedbackActive;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Registers a texture loaded with only its mip tail (see Texture::load() and getTailLevel()).
+ * @param tex texture
+ * @param bitmap source bitmap, used to get the size of all the levels
+ * @param filename source file, read again when finer levels are requested
+ * @param srgb when the source file has no mips, they are generated (as for the bitmap) with this color space
+ * @return TF
+ */
+bool ENG_API Eng::TextureStreamer::add(Eng::Texture &tex, const Eng::Bitmap &bitmap, const std::string &filename, bool srgb)
+{
+   // Safety net:
+   if (tex == Eng::Texture::empty || filename.empty() || bitmap.getNrOfSides() != 1 || bitmap.getNrOfLevels() != tex.getNrOfLevels())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   Reserved::Entry entry;
+   entry.texture = &tex;
+   entry.filename = filename;
+   for (uint32_t c = 0; c < bitmap.getNrOfLevels(); c++)
+      entry.levelBytes.push_back(bitmap.getNrOfBytes(c));
+   entry.tailLevel = tex.getBaseLevel();
+   entry.wantedLevel = tex.getBaseLevel();
+   entry.priority = 0.0f;
+   entry.reading = false;
+   entry.failed = false;
+   entry.srgb = srgb;
+
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   entry.lastFrame = reserved->frame;
+   entry.slot = Eng::TextureStreamer::noSlot;
+   if (!reserved->freeSlots.empty())
+   {
+      entry.slot = reserved->freeSlots.back();
+      reserved->freeSlots.pop_back();
+      reserved->slots[entry.slot] = &tex;
+   }
+   else
+      if (reserved->slots.size() < Eng::TextureStreamer::maxNrOfSlots)
+      {
+         entry.slot = static_cast<uint32_t>(reserved->slots.size());
+         reserved->slots.push_back(&tex);
+      }
+   reserved->nrOfResidentBytes += entry.getNrOfBytes(tex.getBaseLevel(), tex.getNrOfLevels());
+   reserved->entries[&tex] = std::move(entry);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Unregisters a texture (e.g., before releasing it).
+ * @param tex texture
+ * @return TF (false if not registered)
+ */
+bool ENG_API Eng::TextureStreamer::remove(const Eng::Texture &tex)
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   auto it = reserved->entries.find(&tex);
+   if (it == reserved->entries.end())
+      return false;
+
+   reserved->nrOfResidentBytes -= it->second.getNrOfBytes(tex.getBaseLevel(), tex.getNrOfLevels());
+   if (it->second.slot != Eng::TextureStreamer::noSlot)
+   {
+      reserved->slots[it->second.slot] = nullptr;
+      reserved->freeSlots.push_back(it->second.slot);
+   }
+   reserved->entries.erase(it);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Unregisters all the textures.
+ * @return TF
+ */
+bool ENG_API Eng::TextureStreamer::reset()
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   reserved->entries.clear();
+   reserved->slots.clear();
+   reserved->freeSlots.clear();
+   reserved->nrOfResidentBytes = 0;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Requests a mip level for the current frame. Multiple requests within the same frame keep the finest level and
+ * the highest priority. Unregistered textures are ignored.
+ * @param tex texture
+ * @param level finest level required (0 = full resolution)
+ * @param priority loading priority (higher first)
+ * @return TF (false if not registered)
+ */
+bool ENG_API Eng::TextureStreamer::request(const Eng::Texture &tex, uint32_t level, float priority)
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   auto it = reserved->entries.find(&tex);
+   if (it == reserved->entries.end())
+      return false;
+
+   Reserved::Entry &entry = it->second;
+   if (entry.lastFrame != reserved->frame)
+   {
+      entry.wantedLevel = level;
+      entry.priority = priority;
+      entry.lastFrame = reserved->frame;
+   }
+   else
+   {
+      entry.wantedLevel = std::min(entry.wantedLevel, level);
+      entry.priority = std::max(entry.priority, priority);
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reduces the least recently used textures to their mip tail. Textures requested in the current frame are kept.
+ * @param nrOfBytes amount of VRAM to free
+ * @return true when enough memory was freed
+ */
+bool ENG_API Eng::TextureStreamer::evict(uint64_t nrOfBytes)
+{
+   std::vector<Reserved::Entry *> candidates;
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      for (auto &e : reserved->entries)
+         if (e.second.texture->getBaseLevel() < e.second.tailLevel && e.second.lastFrame != reserved->frame)
+            candidates.push_back(&e.second);
+   }
+   std::sort(candidates.begin(), candidates.end(), [](const Reserved::Entry *a, const Reserved::Entry *b) { return a->lastFrame < b->lastFrame; });
+
+   uint64_t freed = 0;
+   for (auto e : candidates)
+   {
+      if (freed >= nrOfBytes)
+         break;
+
+      const uint64_t size = e->getNrOfBytes(e->texture->getBaseLevel(), e->tailLevel);
+      if (e->texture->stream(e->tailLevel) == false)
+         continue;
+
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      reserved->nrOfResidentBytes -= size;
+      reserved->nrOfChanges++;
+      freed += size;
+   }
+
+   // Done:
+   return freed >= nrOfBytes;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Uploads the finer levels read so far (by priority, evicting as required by the budget) and starts reading the
+ * ones requested during this frame. Must be called by the thread owning the OpenGL context, once per frame.
+ * At least one upload is executed per call.
+ * @param budget time budget in milliseconds
+ * @return TF
+ */
+bool ENG_API Eng::TextureStreamer::update(double budget)
+{
+   Eng::Timer &timer = Eng::Timer::getInstance();
+   const uint64_t start = timer.getCounter();
+
+   // Requests from the GPU of previous frames:
+   readFeedback();
+
+   /////////////////////////////////////////
+   // STEP 1: upload finished reads
+   std::vector<Reserved::Entry *> ready;
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      for (auto &e : reserved->entries)
+         if (e.second.staged && !e.second.reading)
+            ready.push_back(&e.second);
+   }
+   std::sort(ready.begin(), ready.end(), [](const Reserved::Entry *a, const Reserved::Entry *b) { return a->priority > b->priority; });
+
+   for (uint32_t c = 0; c < ready.size(); c++)
+   {
+      if (c && timer.getCounterDiff(start, timer.getCounter()) >= budget)
+         break;
+
+      Reserved::Entry &e = *ready[c];
+      const uint32_t baseLevel = e.texture->getBaseLevel();
+      uint32_t level = e.wantedLevel;
+
+      // Make room, then drop the levels still not fitting:
+      if (level < baseLevel && reserved->nrOfResidentBytes + e.getNrOfBytes(level, baseLevel) > reserved->budget)
+         evict(reserved->nrOfResidentBytes + e.getNrOfBytes(level, baseLevel) - reserved->budget);
+      while (level < baseLevel && reserved->nrOfResidentBytes + e.getNrOfBytes(level, baseLevel) > reserved->budget)
+         level++;
+
+      if (level < baseLevel && e.texture->stream(level, e.staged.get()))
+      {
+         std::lock_guard<std::mutex> lock(reserved->mutex);
+         reserved->nrOfResidentBytes += e.getNrOfBytes(level, baseLevel);
+         reserved->nrOfChanges++;
+      }
+
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      e.staged.reset();
+   }
+
+
+   /////////////////////////////////////////
+   // STEP 2: read the levels requested in this frame
+   std::vector<Reserved::Entry *> wanted;
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      for (auto &e : reserved->entries)
+         if (e.second.lastFrame == reserved->frame && e.second.wantedLevel < e.second.texture->getBaseLevel() &&
+             !e.second.reading && !e.second.staged && !e.second.failed)
+            wanted.push_back(&e.second);
+   }
+   std::sort(wanted.begin(), wanted.end(), [](const Reserved::Entry *a, const Reserved::Entry *b) { return a->priority > b->priority; });
+
+   std::vector<Eng::AsyncIo::Request> batch;
+   for (auto e : wanted)
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      if (reserved->nrOfReads >= Eng::TextureStreamer::maxNrOfReads)
+         break;
+      e->reading = true;
+      reserved->nrOfReads++;
+
+      const Eng::Texture *tex = e->texture;
+      const std::string filename = e->filename;
+      const bool srgb = e->srgb;
+      const size_t nrOfLevels = e->levelBytes.size();
+      batch.emplace_back(filename, [this, tex, filename, srgb, nrOfLevels](bool success, const uint8_t *data, uint64_t nrOfBytes)
+         {
+            // Decode on the worker thread (mips included, when the file has none):
+            std::unique_ptr<Eng::Bitmap> bitmap = std::make_unique<Eng::Bitmap>();
+            const bool loaded = success && bitmap->load(data, nrOfBytes, filename);
+            if (loaded && bitmap->getNrOfLevels() == 1 && nrOfLevels > 1)
+               bitmap->generateMipmaps(Eng::Bitmap::Filter::kaiser, srgb);
+
+            std::lock_guard<std::mutex> lock(reserved->mutex);
+            reserved->nrOfReads--;
+            auto it = reserved->entries.find(tex);
+            if (it == reserved->entries.end()) // Removed meanwhile
+               return;
+
+            it->second.reading = false;
+            if (loaded && bitmap->getNrOfLevels() == it->second.levelBytes.size())
+               it->second.staged = std::move(bitmap);
+            else
+            {
+               ENG_LOG_ERROR("Unable to stream texture '%s'", filename.c_str());
+               it->second.failed = true;
+            }
+         });
+   }
+   if (!batch.empty())
+      Eng::AsyncIo::getInstance().submit(batch);
+
+   // Done:
+   reserved->frame++;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Turns the feedback buffers recorded by the GPU into requests. The priority of a request is the number of
+ * missing levels.
+ * @param wait when true, waits for the oldest pending buffer instead of skipping it
+ * @return TF
+ */
+bool ENG_API Eng::TextureStreamer::readFeedback(bool wait)
+{
+   for (uint32_t c = 0; c < Eng::TextureStreamer::nrOfFeedbackBuffers; c++)
+   {
+      // From the oldest one:
+      const uint32_t index = (reserved->currentFeedback + c) % Eng::TextureStreamer::nrOfFeedbackBuffers;
+      if (reserved->fence[index] == nullptr)
+         continue;
+
+      const GLenum status = glClientWaitSync(reserved->fence[index], GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000 : 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+         break; // Newer ones are not ready either
+      glDeleteSync(reserved->fence[index]);
+      reserved->fence[index] = nullptr;
+
+      std::vector<Eng::TextureStreamer::FeedbackSlot> slot(reserved->nrOfFeedbackSlots[index]);
+      glGetNamedBufferSubData(reserved->feedback[index].getOglHandle(), sizeof(Eng::TextureStreamer::FeedbackHeader),
+                              slot.size() * sizeof(Eng::TextureStreamer::FeedbackSlot), slot.data());
+
+      for (uint32_t s = 0; s < slot.size(); s++)
+      {
+         if (slot[s].minLevel == Eng::TextureStreamer::noSlot)
+            continue;
+
+         Eng::Texture *tex;
+         {
+            std::lock_guard<std::mutex> lock(reserved->mutex);
+            tex = s < reserved->slots.size() ? reserved->slots[s] : nullptr;
+         }
+         if (tex)
+            request(*tex, slot[s].minLevel, static_cast<float>(tex->getBaseLevel()) - static_cast<float>(slot[s].minLevel));
+      }
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Clears and binds the next feedback buffer. Shaders rendered until endFeedback() can write into it.
+ * Requires an OpenGL context.
+ * @return TF
+ */
+bool ENG_API Eng::TextureStreamer::beginFeedback()
+{
+   // Safety net:
+   if (!reserved->enabled || reserved->feedbackActive)
+      return false;
+
+   // Still used by the GPU (more than nrOfFeedbackBuffers frames of latency):
+   const uint32_t index = reserved->currentFeedback;
+   if (reserved->fence[index])
+      readFeedback(true);
+
+   Eng::Ssbo &buffer = reserved->feedback[index];
+   if (buffer.getSize() == 0)
+      buffer.create(sizeof(Eng::TextureStreamer::FeedbackHeader) + Eng::TextureStreamer::maxNrOfSlots * sizeof(Eng::TextureStreamer::FeedbackSlot));
+
+   // Reset:
+   Eng::TextureStreamer::FeedbackHeader header = { static_cast<uint32_t>(reserved->frame), reserved->feedbackRate, { 0, 0 } };
+   std::vector<Eng::TextureStreamer::FeedbackSlot> slot;
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      slot.resize(reserved->slots.size(), { Eng::TextureStreamer::noSlot, 0 });
+      for (uint32_t c = 0; c < slot.size(); c++)
+         if (reserved->slots[c])
+            slot[c].baseLevel = reserved->slots[c]->getBaseLevel();
+   }
+   glNamedBufferSubData(buffer.getOglHandle(), 0, sizeof(Eng::TextureStreamer::FeedbackHeader), &header);
+   if (!slot.empty())
+      glNamedBufferSubData(buffer.getOglHandle(), sizeof(Eng::TextureStreamer::FeedbackHeader), slot.size() * sizeof(Eng::TextureStreamer::FeedbackSlot), slot.data());
+   reserved->nrOfFeedbackSlots[index] = static_cast<uint32_t>(slot.size());
+
+   // Done:
+   buffer.render(Eng::TextureStreamer::feedbackBinding);
+   reserved->feedbackActive = true;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Ends the recording started with beginFeedback(). The buffer is read back by update() once the GPU is done with it.
+ * @return TF
+ */
+bool ENG_API Eng::TextureStreamer::endFeedback()
+{
+   // Safety net:
+   if (!reserved->feedbackActive)
+      return false;
+
+   glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+   reserved->fence[reserved->currentFeedback] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+   reserved->currentFeedback = (reserved->currentFeedback + 1) % Eng::TextureStreamer::nrOfFeedbackBuffers;
+
+   // Done:
+   reserved->feedbackActive = false;
+   return true;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file		engine_texture_streamer.h
+ * @brief	Texture streaming with a VRAM budget
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Texture residency manager. Registered textures keep only their coarse mip tail in VRAM; finer levels are
+ *        read (through AsyncIo) and uploaded on request, in priority order. When the VRAM budget is exceeded, the
+ *        least recently used textures are reduced to their tail again. Requests can come from the GPU: between
+ *        beginFeedback() and endFeedback(), shaders write the finest mip level they sample into a feedback buffer,
+ *        which is read back a few frames later without stalling. This class is a singleton.
+ */
+class ENG_API TextureStreamer
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief Feedback buffer entry, one per streamed texture. This struct must be aligned for OpenGL std430.
+    */
+   struct FeedbackSlot
+   {
+      uint32_t minLevel;                        ///< Finest level sampled during the frame (written by the GPU)
+      uint32_t baseLevel;                       ///< Finest level in VRAM when the frame started
+   };
+
+
+   /**
+    * @brief Feedback buffer header. This struct must be aligned for OpenGL std430.
+    */
+   struct FeedbackHeader
+   {
+      uint32_t frame;                           ///< Frame counter, to rotate the subsampling pattern
+      uint32_t rate;                            ///< One pixel/ray out of this many writes feedback
+      uint32_t _pad[2];                         ///< Padding
+   };
+
+
+   // Consts:
+   static constexpr uint64_t dfltBudget = 512 * 1024 * 1024;   ///< Default VRAM budget (bytes)
+   static constexpr uint32_t dfltTailSize = 128;               ///< Default size of the finest always-resident level
+   static constexpr uint32_t maxNrOfReads = 4;                 ///< Max number of textures being read at once
+   static constexpr uint32_t maxNrOfSlots = 4096;              ///< Max number of textures with GPU feedback
+   static constexpr uint32_t noSlot = 0xFFFFFFFF;              ///< Special value for "no feedback slot"
+   static constexpr uint32_t nrOfFeedbackBuffers = 3;          ///< Feedback buffers in flight
+   static constexpr uint32_t feedbackBinding = 7;              ///< SSBO binding point of the feedback buffer
+   static constexpr uint32_t dfltFeedbackRate = 16;            ///< Default feedback subsampling rate
+
+   // Const/dest:
+   TextureStreamer(TextureStreamer const &) = delete;
+   ~TextureStreamer();
+
+   // Operators:
+   void operator=(TextureStreamer const &) = delete;
+
+   // Singleton:
+   static TextureStreamer &getInstance();
+
+   // Get/set:
+   void setEnabled(bool enabled);
+   bool isEnabled() const;
+   void setBudget(uint64_t nrOfBytes);
+   uint64_t getBudget() const;
+   void setTailSize(uint32_t size);
+   uint32_t getTailSize() const;
+   uint32_t getTailLevel(const Eng::Bitmap &bitmap) const;
+   uint64_t getNrOfResidentBytes() const;
+   uint32_t getNrOfTextures() const;
+   uint64_t getNrOfChanges() const;
+   uint32_t getSlot(const Eng::Texture &tex) const;
+   void setFeedbackRate(uint32_t rate);
+   uint32_t getFeedbackRate() const;
+   bool isFeedbackActive() const;
+
+   // Management:
+   bool add(Eng::Texture &tex, const Eng::Bitmap &bitmap, const std::string &filename, bool srgb = false);
+   bool remove(const Eng::Texture &tex);
+   bool reset();
+   bool request(const Eng::Texture &tex, uint32_t level = 0, float priority = 1.0f);
+   bool update(double budget);
+
+   // GPU feedback:
+   bool beginFeedback();
+   bool endFeedback();
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   TextureStreamer();
+
+   // Internal:
+   bool evict(uint64_t nrOfBytes);
+   bool readFeedback(bool wait = false);
+};
@@ -0,0 +1,248 @@
+/**
+ * @file		engine_thread_pool.cpp
+ * @brief	Pool of worker threads for CPU-side jobs
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <atomic>
+   #include <condition_variable>
+   #include <deque>
+   #include <mutex>
+   #include <thread>
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief ThreadPool reserved structure.
+ */
+struct Eng::ThreadPool::Reserved
+{
+   std::vector<std::thread> worker;          ///< Worker threads
+   std::deque<Eng::ThreadPool::Job> queue;   ///< Pending jobs
+   std::mutex mutex;                         ///< Protects the queue
+   std::condition_variable available;        ///< Signaled when a job is queued (or on shutdown)
+   std::condition_variable idle;             ///< Signaled when a job completes
+   uint32_t nrOfRunning;                     ///< Jobs currently being executed
+   bool quit;                                ///< Shutdown flag
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : nrOfRunning{ 0 }, quit{ false }
+   {}
+};
+
+
+
+//////////////////////////////
+// BODY OF CLASS ThreadPool //
+//////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor. Spawns one worker per hardware thread, minus the calling (rendering) one.
+ */
+ENG_API Eng::ThreadPool::ThreadPool() : reserved(std::make_unique<Eng::ThreadPool::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+
+   uint32_t nrOfThreads = std::thread::hardware_concurrency();
+   if (nrOfThreads > 1)
+      nrOfThreads--;
+   if (nrOfThreads == 0)
+      nrOfThreads = 1;
+
+   for (uint32_t c = 0; c < nrOfThreads; c++)
+      reserved->worker.emplace_back([this]()
+         {
+            while (true)
+            {
+               Eng::ThreadPool::Job job;
+               {
+                  std::unique_lock<std::mutex> lock(reserved->mutex);
+                  reserved->available.wait(lock, [this]() { return reserved->quit || !reserved->queue.empty(); });
+                  if (reserved->queue.empty()) // Quit
+                     return;
+                  job = std::move(reserved->queue.front());
+                  reserved->queue.pop_front();
+                  reserved->nrOfRunning++;
+               }
+
+               job();
+
+               {
+                  std::lock_guard<std::mutex> lock(reserved->mutex);
+                  reserved->nrOfRunning--;
+               }
+               reserved->idle.notify_all();
+            }
+         });
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::ThreadPool::~ThreadPool()
+{
+   ENG_LOG_DEBUG("[-]");
+
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      reserved->quit = true;
+   }
+   reserved->available.notify_all();
+   for (auto &t : reserved->worker)
+      t.join();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::ThreadPool ENG_API &Eng::ThreadPool::getInstance()
+{
+   static ThreadPool instance;
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the number of worker threads.
+ * @return number of workers
+ */
+uint32_t ENG_API Eng::ThreadPool::getNrOfThreads() const
+{
+   return static_cast<uint32_t>(reserved->worker.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Queues a job for execution on a worker thread.
+ * @param job job to execute
+ * @return TF
+ */
+bool ENG_API Eng::ThreadPool::submit(const Job &job)
+{
+   // Safety net:
+   if (!job)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      reserved->queue.push_back(job);
+   }
+   reserved->available.notify_one();
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Runs one queued job on the calling thread, if any.
+ * @return true if a job was executed
+ */
+bool ENG_API Eng::ThreadPool::runPendingJob()
+{
+   Eng::ThreadPool::Job job;
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      if (reserved->queue.empty())
+         return false;
+      job = std::move(reserved->queue.front());
+      reserved->queue.pop_front();
+      reserved->nrOfRunning++;
+   }
+
+   job();
+
+   {
+      std::lock_guard<std::mutex> lock(reserved->mutex);
+      reserved->nrOfRunning--;
+   }
+   reserved->idle.notify_all();
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Executes job(0) ... job(nrOfItems - 1) on the workers and returns when all of them are done.
+ * The calling thread takes part in the execution, so nested calls from within a job are safe.
+ * @param nrOfItems number of items
+ * @param job job to execute per item
+ * @return TF
+ */
+bool ENG_API Eng::ThreadPool::parallelFor(uint32_t nrOfItems, const IndexedJob &job)
+{
+   // Safety net:
+   if (!job)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (nrOfItems == 0)
+      return true;
+
+   // Items are fetched dynamically, one batch per worker plus the caller:
+   std::atomic<uint32_t> next{ 0 };
+   std::atomic<uint32_t> nrOfDone{ 0 };
+   const uint32_t nrOfBatches = std::min(nrOfItems, getNrOfThreads() + 1);
+   auto batch = [&]()
+   {
+      uint32_t c;
+      while ((c = next.fetch_add(1)) < nrOfItems)
+         job(c);
+      nrOfDone.fetch_add(1);
+   };
+   for (uint32_t c = 1; c < nrOfBatches; c++)
+      submit(batch);
+   batch();
+
+   // Help with other jobs while the remaining batches complete:
+   while (nrOfDone.load() < nrOfBatches)
+      if (!runPendingJob())
+         std::this_thread::yield();
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Blocks until all queued jobs have been executed.
+ */
+void ENG_API Eng::ThreadPool::wait()
+{
+   while (runPendingJob());
+
+   std::unique_lock<std::mutex> lock(reserved->mutex);
+   reserved->idle.wait(lock, [this]() { return reserved->queue.empty() && reserved->nrOfRunning == 0; });
+}
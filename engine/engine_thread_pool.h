@@ -0,0 +1,57 @@
+/**
+ * @file		engine_thread_pool.h
+ * @brief	Pool of worker threads for CPU-side jobs
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Pool of worker threads for CPU-only jobs (no OpenGL calls allowed in jobs). This class is a singleton.
+ */
+class ENG_API ThreadPool
+{
+//////////
+public: //
+//////////
+
+   // Job signatures:
+   typedef std::function<void(void)> Job;
+   typedef std::function<void(uint32_t)> IndexedJob;
+
+
+   // Const/dest:
+   ThreadPool(ThreadPool const &) = delete;
+   ~ThreadPool();
+
+   // Operators:
+   void operator=(ThreadPool const &) = delete;
+
+   // Singleton:
+   static ThreadPool &getInstance();
+
+   // Get/set:
+   uint32_t getNrOfThreads() const;
+
+   // Jobs:
+   bool submit(const Job &job);
+   bool parallelFor(uint32_t nrOfItems, const IndexedJob &job);
+   void wait();
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   ThreadPool();
+
+   // Internal:
+   bool runPendingJob();
+};
@@ -0,0 +1,402 @@
+/**
+ * @file		engine_transform_table.cpp
+ * @brief	Flattened node hierarchy with world matrix update
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief TransformTable reserved structure.
+ */
+struct Eng::TransformTable::Reserved
+{
+   /**
+    * @brief Consecutive sibling subtrees updated by one job.
+    */
+   struct Range
+   {
+      uint32_t first;                           ///< First node
+      uint32_t last;                            ///< One past the last node
+   };
+
+   std::vector<const Eng::Node *> nodes;        ///< Nodes in depth-first order (nullptr when destroyed)
+   std::vector<uint32_t> parent;                ///< Parent index (none for the root)
+   std::vector<uint32_t> subtreeEnd;            ///< One past the last node of the subtree
+   std::vector<glm::mat4> local;                ///< Local matrices
+   std::vector<glm::mat4> world;                ///< World matrices
+   std::vector<uint8_t> dirty;                  ///< Local matrix changed since the last update
+   std::vector<uint8_t> pending;                ///< Node or descendant dirty
+   std::vector<uint8_t> changed;                ///< World matrix changed by the last update
+   std::vector<uint32_t> serial;                ///< Ancestors of the jobs, updated first (depth-first order)
+   std::vector<Range> jobs;                     ///< Ranges updated in parallel
+   bool valid;                                  ///< False when the hierarchy changed since build()
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : valid{ false }
+   {}
+
+
+   /**
+    * Splits the subtree of a large node into jobs of about minJobSize nodes: the node itself is updated serially,
+    * its children are grouped into ranges or split further when too large.
+    * @param id node index
+    */
+   void split(uint32_t id)
+   {
+      serial.push_back(id);
+
+      uint32_t first = id + 1;
+      for (uint32_t c = id + 1; c < subtreeEnd[id]; c = subtreeEnd[c])
+      {
+         const uint32_t size = subtreeEnd[c] - c;
+         if (size > minJobSize)
+         {
+            if (first < c)
+               jobs.push_back({ first, c });
+            split(c);
+            first = subtreeEnd[c];
+         }
+         else
+            if (c - first + size > minJobSize)
+            {
+               jobs.push_back({ first, c });
+               first = c;
+            }
+      }
+      if (first < subtreeEnd[id])
+         jobs.push_back({ first, subtreeEnd[id] });
+   }
+};
+
+
+
+//////////////////////////////////
+// BODY OF CLASS TransformTable //
+//////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::TransformTable::TransformTable() : reserved(std::make_unique<Eng::TransformTable::Reserved>())
+{
+   ENG_LOG_DETAIL("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::TransformTable::~TransformTable()
+{
+   ENG_LOG_DETAIL("[-]");
+   clear();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Flattens the hierarchy starting at the given node. World matrices are relative to the parent of the root (i.e.,
+ * absolute when the root has no parent) and computed by the next update(). A node belongs to one table at most:
+ * the last build wins.
+ * @param root root node
+ * @return TF
+ */
+bool ENG_API Eng::TransformTable::build(const Eng::Node &root)
+{
+   // Safety net:
+   if (root == Eng::Node::empty)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   clear();
+
+   // Depth-first traversal (children pushed in reverse order, to keep their order):
+   std::vector<std::pair<const Eng::Node *, uint32_t>> stack;
+   stack.push_back({ &root, none });
+   while (stack.empty() == false)
+   {
+      const Eng::Node *node = stack.back().first;
+      const uint32_t parent = stack.back().second;
+      stack.pop_back();
+
+      const uint32_t id = static_cast<uint32_t>(reserved->nodes.size());
+      reserved->nodes.push_back(node);
+      reserved->parent.push_back(parent);
+      reserved->local.push_back(node->getMatrix());
+      const_cast<Eng::Node *>(node)->setTransformSlot(this, id);
+
+      const auto &children = node->getListOfChildren();
+      for (auto it = children.rbegin(); it != children.rend(); ++it)
+         if (const Eng::Node &child = Eng::Node::resolve(*it); child != Eng::Node::empty)
+            stack.push_back({ &child, id });
+   }
+
+   // Subtree bounds (children come after their parent):
+   const uint32_t nrOfNodes = static_cast<uint32_t>(reserved->nodes.size());
+   reserved->subtreeEnd.resize(nrOfNodes);
+   for (uint32_t c = 0; c < nrOfNodes; c++)
+      reserved->subtreeEnd[c] = c + 1;
+   for (uint32_t c = nrOfNodes - 1; c > 0; c--)
+      reserved->subtreeEnd[reserved->parent[c]] = std::max(reserved->subtreeEnd[reserved->parent[c]], reserved->subtreeEnd[c]);
+
+   // Everything needs an update:
+   reserved->world.resize(nrOfNodes);
+   reserved->dirty.assign(nrOfNodes, 1);
+   reserved->pending.assign(nrOfNodes, 1);
+   reserved->changed.assign(nrOfNodes, 0);
+
+   // Jobs:
+   if (nrOfNodes <= minJobSize)
+      reserved->jobs.push_back({ 0, nrOfNodes });
+   else
+      reserved->split(0);
+
+   // Done:
+   reserved->valid = true;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Marks the hierarchy as changed: the table is rebuilt from the same root by the next update().
+ */
+void ENG_API Eng::TransformTable::invalidate()
+{
+   reserved->valid = false;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Empties the table and detaches its nodes.
+ */
+void ENG_API Eng::TransformTable::clear()
+{
+   for (const Eng::Node *node : reserved->nodes)
+      if (node && node->getTransformTable() == this)
+         const_cast<Eng::Node *>(node)->setTransformSlot(nullptr, none);
+
+   reserved->nodes.clear();
+   reserved->parent.clear();
+   reserved->subtreeEnd.clear();
+   reserved->local.clear();
+   reserved->world.clear();
+   reserved->dirty.clear();
+   reserved->pending.clear();
+   reserved->changed.clear();
+   reserved->serial.clear();
+   reserved->jobs.clear();
+   reserved->valid = false;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Updates the world matrices of the nodes changed since the last update, and of their subtrees. Untouched subtrees
+ * are skipped. Rebuilds the table first when the hierarchy changed.
+ * @return TF
+ */
+bool ENG_API Eng::TransformTable::update()
+{
+   // Rebuild when needed:
+   if (reserved->valid == false)
+   {
+      const Eng::Node *root = reserved->nodes.empty() ? nullptr : reserved->nodes[0];
+      if (root == nullptr)
+      {
+         clear();
+         ENG_LOG_ERROR("Table not built or root destroyed");
+         return false;
+      }
+      if (build(*root) == false)
+         return false;
+   }
+
+   // Nothing changed?
+   if (reserved->pending[0] == 0)
+      return true;
+
+   // Ancestors of the jobs:
+   for (uint32_t id : reserved->serial)
+   {
+      const uint32_t parent = reserved->parent[id];
+      const bool changed = reserved->dirty[id] || (parent != none && reserved->changed[parent]);
+      if (changed)
+         reserved->world[id] = (parent == none) ? reserved->local[id] : reserved->world[parent] * reserved->local[id];
+      reserved->changed[id] = changed;
+      reserved->dirty[id] = 0;
+      reserved->pending[id] = 0;
+   }
+
+   // Subtrees (disjoint, reading only their ancestors):
+   if (reserved->jobs.size() == 1)
+      updateRange(reserved->jobs[0].first, reserved->jobs[0].last);
+   else
+      Eng::ThreadPool::getInstance().parallelFor(static_cast<uint32_t>(reserved->jobs.size()), [this](uint32_t c)
+         {
+            updateRange(reserved->jobs[c].first, reserved->jobs[c].last);
+         });
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Updates a range of consecutive sibling subtrees, whose ancestors are already up to date.
+ * @param first first node
+ * @param last one past the last node
+ */
+void ENG_API Eng::TransformTable::updateRange(uint32_t first, uint32_t last)
+{
+   uint32_t id = first;
+   while (id < last)
+   {
+      const uint32_t parent = reserved->parent[id];
+      const bool changed = reserved->dirty[id] || (parent != none && reserved->changed[parent]);
+      if (changed)
+         reserved->world[id] = (parent == none) ? reserved->local[id] : reserved->world[parent] * reserved->local[id];
+      reserved->changed[id] = changed;
+
+      // Skip untouched subtrees:
+      if (changed || reserved->pending[id])
+      {
+         reserved->dirty[id] = 0;
+         reserved->pending[id] = 0;
+         id++;
+      }
+      else
+         id = reserved->subtreeEnd[id];
+   }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of nodes in the table.
+ * @return number of nodes
+ */
+uint32_t ENG_API Eng::TransformTable::getNrOfNodes() const
+{
+   return static_cast<uint32_t>(reserved->nodes.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets a node of the table.
+ * @param id node index (depth-first order)
+ * @return node reference, or empty reference if destroyed or error
+ */
+const Eng::Node ENG_API &Eng::TransformTable::getNode(uint32_t id) const
+{
+   // Safety net:
+   if (id >= reserved->nodes.size())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return Eng::Node::empty;
+   }
+
+   return reserved->nodes[id] ? *reserved->nodes[id] : Eng::Node::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the parent of a node.
+ * @param id node index
+ * @return parent index, or none for the root
+ */
+uint32_t ENG_API Eng::TransformTable::getParent(uint32_t id) const
+{
+   return reserved->parent.at(id);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the world matrix of a node, as computed by the last update().
+ * @param id node index
+ * @return world coordinate glm 4x4 matrix
+ */
+const glm::mat4 ENG_API &Eng::TransformTable::getWorldMatrix(uint32_t id) const
+{
+   return reserved->world.at(id);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether the world matrices reflect the current hierarchy and local matrices.
+ * @return TF
+ */
+bool ENG_API Eng::TransformTable::isUpToDate() const
+{
+   return reserved->valid && reserved->pending[0] == 0;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Changes the local matrix of a node (called by Node::setMatrix()).
+ * @param id node index
+ * @param matrix local matrix
+ */
+void ENG_API Eng::TransformTable::setLocalMatrix(uint32_t id, const glm::mat4 &matrix)
+{
+   reserved->local.at(id) = matrix;
+   reserved->dirty[id] = 1;
+   for (uint32_t c = id; c != none && reserved->pending[c] == 0; c = reserved->parent[c])
+      reserved->pending[c] = 1;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Updates the address of a moved node (called by the Node move constructor).
+ * @param id node index
+ * @param node moved node
+ */
+void ENG_API Eng::TransformTable::relink(uint32_t id, const Eng::Node &node)
+{
+   reserved->nodes.at(id) = &node;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Forgets a destroyed node (called by the Node destructor). The table is rebuilt by the next update().
+ * @param id node index
+ */
+void ENG_API Eng::TransformTable::detach(uint32_t id)
+{
+   reserved->nodes.at(id) = nullptr;
+   reserved->valid = false;
+}
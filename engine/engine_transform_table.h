@@ -0,0 +1,71 @@
+/**
+ * @file		engine_transform_table.h
+ * @brief	Flattened node hierarchy with world matrix update
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Flattened copy of a node hierarchy: nodes are stored in depth-first order (parents before children, each
+ *        subtree contiguous), with parent indices and local/world matrices in separate arrays. Nodes write their
+ *        local matrix through to the table when changed, and update() recomputes the world matrices of the changed
+ *        nodes and of their subtrees only, in one linear pass split across the ThreadPool by subtree. Changing the
+ *        hierarchy (adding/removing children, destroying nodes) triggers a rebuild on the next update().
+ *        Not thread-safe: nodes must not be changed during update().
+ */
+class ENG_API TransformTable
+{
+//////////
+public: //
+//////////
+
+   // Special values:
+   static constexpr uint32_t none = 0xFFFFFFFF;
+
+   // Consts:
+   static constexpr uint32_t minJobSize = 1024;             ///< Subtrees smaller than this are not split further
+
+
+   // Const/dest:
+   TransformTable();
+   TransformTable(TransformTable const &) = delete;
+   ~TransformTable();
+
+   // Operators:
+   void operator=(TransformTable const &) = delete;
+
+   // Hierarchy:
+   bool build(const Eng::Node &root);
+   void invalidate();
+   void clear();
+
+   // Update:
+   bool update();
+
+   // Get/set:
+   uint32_t getNrOfNodes() const;
+   const Eng::Node &getNode(uint32_t id) const;
+   uint32_t getParent(uint32_t id) const;
+   const glm::mat4 &getWorldMatrix(uint32_t id) const;
+   bool isUpToDate() const;
+
+   // Node callbacks:
+   void setLocalMatrix(uint32_t id, const glm::mat4 &matrix);
+   void relink(uint32_t id, const Eng::Node &node);
+   void detach(uint32_t id);
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Internal:
+   void updateRange(uint32_t first, uint32_t last);
+};
@@ -0,0 +1,160 @@
+/**
+ * @file		engine_upload_queue.cpp
+ * @brief	Queue of deferred GPU uploads executed on the rendering thread
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <deque>
+   #include <mutex>
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief UploadQueue reserved structure.
+ */
+struct Eng::UploadQueue::Reserved
+{
+   std::deque<Eng::UploadQueue::Job> queue;  ///< Pending jobs
+   mutable std::mutex mutex;                 ///< Protects the queue
+
+
+   /**
+    * Constructor.
+    */
+   Reserved()
+   {}
+};
+
+
+
+///////////////////////////////
+// BODY OF CLASS UploadQueue //
+///////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::UploadQueue::UploadQueue() : reserved(std::make_unique<Eng::UploadQueue::Reserved>())
+{
+   ENG_LOG_DEBUG("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::UploadQueue::~UploadQueue()
+{
+   ENG_LOG_DEBUG("[-]");
+   if (!reserved->queue.empty())
+      ENG_LOG_WARN("%zu upload(s) never executed", reserved->queue.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::UploadQueue ENG_API &Eng::UploadQueue::getInstance()
+{
+   static UploadQueue instance;
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the number of jobs still waiting for execution.
+ * @return number of pending jobs
+ */
+uint32_t ENG_API Eng::UploadQueue::getNrOfPending() const
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   return static_cast<uint32_t>(reserved->queue.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Adds a job to the queue. Can be called from any thread.
+ * @param job job to execute on the rendering thread
+ * @return TF
+ */
+bool ENG_API Eng::UploadQueue::push(const Job &job)
+{
+   // Safety net:
+   if (!job)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   reserved->queue.push_back(job);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Executes queued jobs until the time budget is consumed. Must be called by the thread owning the OpenGL context,
+ * typically once per frame. At least one job is executed per call, so the queue always makes progress.
+ * @param budget time budget in milliseconds
+ * @return true when the queue is empty
+ */
+bool ENG_API Eng::UploadQueue::process(double budget)
+{
+   Eng::Timer &timer = Eng::Timer::getInstance();
+   const uint64_t start = timer.getCounter();
+
+   do
+   {
+      Job job;
+      {
+         std::lock_guard<std::mutex> lock(reserved->mutex);
+         if (reserved->queue.empty())
+            return true;
+         job = std::move(reserved->queue.front());
+         reserved->queue.pop_front();
+      }
+
+      if (job() == false)
+         ENG_LOG_ERROR("Upload job failed");
+   } while (timer.getCounterDiff(start, timer.getCounter()) < budget);
+
+   // Done:
+   return getNrOfPending() == 0;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Executes all the queued jobs, regardless of the time they take.
+ * @return TF
+ */
+bool ENG_API Eng::UploadQueue::flush()
+{
+   while (process(1000.0) == false);
+
+   // Done:
+   return true;
+}
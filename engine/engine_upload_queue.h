@@ -0,0 +1,54 @@
+/**
+ * @file		engine_upload_queue.h
+ * @brief	Queue of deferred GPU uploads executed on the rendering thread
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Queue of jobs that must run on the thread owning the OpenGL context (e.g., buffer and texture uploads).
+ *        Jobs can be pushed from any thread. This class is a singleton.
+ */
+class ENG_API UploadQueue
+{
+//////////
+public: //
+//////////
+
+   // Job signature:
+   typedef std::function<bool(void)> Job;
+
+
+   // Const/dest:
+   UploadQueue(UploadQueue const &) = delete;
+   ~UploadQueue();
+
+   // Operators:
+   void operator=(UploadQueue const &) = delete;
+
+   // Singleton:
+   static UploadQueue &getInstance();
+
+   // Get/set:
+   uint32_t getNrOfPending() const;
+
+   // Jobs:
+   bool push(const Job &job);
+   bool process(double budget);
+   bool flush();
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   UploadQueue();
+};
@@ -36,7 +36,7 @@
 /**
  * @brief VAO reserved structure.
  */
-struct Eng::Vao::Reserved
+struct Eng::Vao::Reserved : public Eng::Pooled<Eng::Vao::Reserved>
 {  
    GLuint oglId;        ///< OpenGL shader ID
 
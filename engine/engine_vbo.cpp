@@ -36,7 +36,7 @@
 /**
  * @brief VBO reserved structure.
  */
-struct Eng::Vbo::Reserved
+struct Eng::Vbo::Reserved : public Eng::Pooled<Eng::Vbo::Reserved>
 {  
    GLuint oglId;           ///< OpenGL shader ID
    uint32_t nrOfVertices;  ///< Nr. of vertices